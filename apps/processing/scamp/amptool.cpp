@@ -28,11 +28,13 @@
 #include <seiscomp/datamodel/utils.h>
 
 #include <seiscomp/io/archive/xmlarchive.h>
+#include <seiscomp/io/recordinput.h>
 
 #include <seiscomp/processing/amplitudeprocessor.h>
 
 #include <functional>
 #include <iomanip>
+#include <thread>
 
 
 using namespace std;
@@ -44,27 +46,16 @@ using namespace Seiscomp::DataModel;
 using namespace Private;
 
 #define _T(name) database()->convertColumnName(name)
-// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
-
 
 
+namespace {
 
-// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-bool AmpTool::CompareWaveformStreamID::operator()(
-	const Seiscomp::DataModel::WaveformStreamID &one,
-	const Seiscomp::DataModel::WaveformStreamID &other
-) const
-{
-	if ( one.networkCode() < other.networkCode() ) return true;
-	if ( one.networkCode() > other.networkCode() ) return false;
 
-	if ( one.stationCode() < other.stationCode() ) return true;
-	if ( one.stationCode() > other.stationCode() ) return false;
+// Notification type sent by the acquisition threads to wake up the main
+// thread if records are queued
+const int AcquisitionNotification = -1;
 
-	if ( one.locationCode() < other.locationCode() ) return true;
-	if ( one.locationCode() > other.locationCode() ) return false;
 
-	return one.channelCode() < other.channelCode();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -86,6 +77,8 @@ AmpTool::AmpTool(int argc, char **argv) : StreamApplication(argc, argv) {
 	addMessagingSubscription("LOCATION");
 
 	setAutoAcquisitionStart(false);
+	// Applies to the records read by the acquisitions as well
+	setRecordInputHint(_recordInputHint);
 
 	_amplitudeTypes.insert("MLv");
 	_amplitudeTypes.insert("mb");
@@ -135,6 +128,12 @@ void AmpTool::createCommandLineDescription() {
 	commandline().addOption("Input", "reprocess",
 	                        "Reprocess and update existing (non manual)"
 	                        "amplitudes in combination with --ep.");
+	commandline().addOption("Input", "threads",
+	                        "Number of origins or picks to process in parallel "
+	                        "in combination with --ep. Each thread reads its "
+	                        "own data. The output does not depend on the "
+	                        "number of threads.",
+	                        &_threads, true);
 
 	commandline().addGroup("Reprocess");
 	commandline().addOption("Reprocess", "force",
@@ -212,6 +211,27 @@ bool AmpTool::initConfiguration() {
 	try { _populateVersionInfo = configGetBool("amptool.populateVersion"); }
 	catch ( ... ) {}
 
+	try {
+		_waveformCache.setBufferSize(TimeSpan(configGetDouble("amptool.cache.bufferSize")));
+	}
+	catch ( ... ) {}
+
+	try { _splitRequests = configGetBool("amptool.request.split"); }
+	catch ( ... ) {}
+
+	try { _maxRequestGap = configGetDouble("amptool.request.maxGap"); }
+	catch ( ... ) {}
+
+	try {
+		int maxStreams = configGetInt("amptool.cache.maxStreams");
+		if ( maxStreams < 0 ) {
+			SEISCOMP_ERROR("amptool.cache.maxStreams: negative values are not allowed");
+			return false;
+		}
+		_waveformCache.setMaxStreams(maxStreams);
+	}
+	catch ( ... ) {}
+
 	_dumpRecords = commandline().hasOption("dump-records");
 	_reprocessAmplitudes = commandline().hasOption("reprocess");
 	_picks = commandline().hasOption("picks");
@@ -236,6 +256,11 @@ bool AmpTool::init() {
 		return false;
 	}
 
+	if ( _threads < 1 ) {
+		SC_FMT_ERROR("--threads: invalid value {}, expected at least 1", _threads);
+		return false;
+	}
+
 	_inputPicks = addInputObjectLog("pick");
 	_inputAmps = addInputObjectLog("amplitude");
 	_inputOrgs = addInputObjectLog("origin");
@@ -285,6 +310,11 @@ bool AmpTool::init() {
 
 	SEISCOMP_INFO("\nAmplitudes to calculate:\n%s", logAmplTypes.c_str());
 
+	if ( _waveformCache.isEnabled() ) {
+		SEISCOMP_INFO("Waveform cache enabled with %.0fs per stream",
+		              (double)_waveformCache.bufferSize());
+	}
+
 	_timer.setTimeout(1);
 	_timer.setCallback(bind(&AmpTool::handleTimeout, this));
 
@@ -476,22 +506,10 @@ bool AmpTool::run() {
 
 			if ( _stationRequests.empty() ) continue;
 
-			for ( RequestMap::iterator it = _stationRequests.begin(); it != _stationRequests.end(); ++it ) {
-				StationRequest &req = it->second;
-				for ( WaveformIDSet::iterator wit = req.streams.begin(); wit != req.streams.end(); ++wit ) {
-					const WaveformStreamID &wsid = *wit;
-					recordStream()->addStream(wsid.networkCode(), wsid.stationCode(),
-					                          wsid.locationCode(), wsid.channelCode(),
-					                          req.timeWindow.startTime(),
-					                          req.timeWindow.endTime());
-				}
-
-				_report << " + TimeWindow (" << it->first << "): " << req.timeWindow.startTime().toString("%F %T")
-				        << ", " << req.timeWindow.endTime().toString("%F %T") << std::endl;
-			}
-
 			_reprocessMap.clear();
-			readRecords(false);
+			if ( startAcquisition(pick->publicID()) ) {
+				waitForAcquisitions();
+			}
 
 			list<AmplitudePtr> updates;
 
@@ -586,11 +604,23 @@ bool AmpTool::run() {
 			}
 		}
 
+		// With more than one thread the data of several origins are read
+		// and processed concurrently. The results are emitted in input
+		// order once all previous origins have finished.
+		_deferResults = _threads > 1;
+		if ( _deferResults && _waveformCache.isEnabled() ) {
+			SEISCOMP_INFO("Waveform cache is not used with --threads");
+			_waveformCache.setBufferSize(TimeSpan(0, 0));
+		}
+
 		if ( _picks) {
 			for ( size_t i = 0; i < _ep->pickCount(); ++i ) {
 				PickPtr pick = _ep->pick(i);
 				SEISCOMP_INFO("Processing pick %s", pick->publicID().c_str());
 				process(nullptr, pick.get());
+				while ( _acquisitions.size() >= static_cast<size_t>(_threads) ) {
+					waitForAcquisition();
+				}
 				if ( isExitRequested() ) {
 					break;
 				}
@@ -601,10 +631,15 @@ bool AmpTool::run() {
 				OriginPtr org = _ep->origin(i);
 				SEISCOMP_INFO("Processing origin %s", org->publicID().c_str());
 				process(org.get(), nullptr);
+				while ( _acquisitions.size() >= static_cast<size_t>(_threads) ) {
+					waitForAcquisition();
+				}
 				if ( isExitRequested() ) break;
 			}
 		}
 
+		waitForAcquisitions();
+
 		ar.create("-");
 		ar.setFormattedOutput(_formatted);
 		ar << _ep;
@@ -615,6 +650,9 @@ bool AmpTool::run() {
 		return true;
 	}
 
+	// Acquisitions of subsequent origins overlap in real-time processing
+	_asynchronous = true;
+
 	return StreamApplication::run();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -624,8 +662,38 @@ bool AmpTool::run() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void AmpTool::done() {
+	// Stop pending acquisitions and wait for their threads to finish
+	_asynchronous = false;
+
+	{
+		boost::mutex::scoped_lock l(_acquisitionMutex);
+		for ( auto &item : _acquisitions ) {
+			if ( !item.second->closed ) {
+				item.second->stream->close();
+				item.second->closed = true;
+			}
+		}
+	}
+
+	for ( auto &item : _readers ) {
+		item.second.join();
+	}
+
+	_readers.clear();
+	_recordQueue.clear();
+	_runningAmplitudes.clear();
+
+	if ( _timer.isActive() ) {
+		_timer.stop();
+	}
+
+	_acquisitions.clear();
+	_completedAcquisitions.clear();
+
 	Seiscomp::Client::StreamApplication::done();
 
+	printStatistics();
+
 	if ( _errorChannel ) delete _errorChannel;
 	if ( _errorOutput ) delete _errorOutput;
 
@@ -780,8 +848,6 @@ void AmpTool::process(Origin *origin, Pick *pickInput) {
 	// a certain stream
 	PickStreamMap pickStreamMap;
 
-	_ampIDReuse.clear();
-
 	if ( origin ) {
 		_report << std::endl;
 		_report << "Processing report for Origin: " << origin->publicID() << std::endl;
@@ -893,6 +959,17 @@ void AmpTool::process(Origin *origin, Pick *pickInput) {
 				}
 			}
 
+			// Deferred results are merged in input order when emitted, see
+			// emitDeferredAmplitude. Skipping them here would depend on
+			// whether the previous acquisition has finished yet.
+			if ( !_deferResults
+			  && _runningAmplitudes.find({pickID, type}) != _runningAmplitudes.end() ) {
+				SEISCOMP_INFO("Skipping %s calculation for pick %s, amplitude is being computed already",
+				              type.c_str(), pickID.c_str());
+				_report << "     - " << type << " [amplitude computation running]" << std::endl;
+				continue;
+			}
+
 			AmplitudePtr existingAmp = hasAmplitude(amps, type);
 
 			if ( existingAmp ) {
@@ -923,10 +1000,6 @@ void AmpTool::process(Origin *origin, Pick *pickInput) {
 				continue;
 			}
 
-			if ( existingAmp ) {
-				_ampIDReuse[proc.get()] = existingAmp;
-			}
-
 			proc->setTrigger(pickTime);
 			proc->setReferencingPickID(pickID);
 
@@ -941,13 +1014,18 @@ void AmpTool::process(Origin *origin, Pick *pickInput) {
 			}
 
 			if ( res < 0 ) {
-				// RecordStream not available
-				if ( res == -2 ) {
-					return;
-				}
 				continue;
 			}
 
+			// Released with the processors of the acquisition
+			_runningAmplitudes.insert({pickID, type});
+
+			// The processor is kept alive until its acquisition has
+			// finished which removes the entry again
+			if ( existingAmp ) {
+				_ampIDReuse[proc.get()] = existingAmp;
+			}
+
 			proc->setPublishFunction(bind(&AmpTool::emitAmplitude, this, placeholders::_1, placeholders::_2));
 		}
 	}
@@ -958,38 +1036,14 @@ void AmpTool::process(Origin *origin, Pick *pickInput) {
 		return;
 	}
 
-	for ( RequestMap::iterator it = _stationRequests.begin(); it != _stationRequests.end(); ++it ) {
-		StationRequest &req = it->second;
-		for ( WaveformIDSet::iterator wit = req.streams.begin(); wit != req.streams.end(); ++wit ) {
-			const WaveformStreamID &wsid = *wit;
-			recordStream()->addStream(wsid.networkCode(), wsid.stationCode(),
-			                          wsid.locationCode(), wsid.channelCode(),
-			                          req.timeWindow.startTime(),
-			                          req.timeWindow.endTime());
-		}
-
-		SC_FMT_DEBUG("{} time window: {} - {}",
-		             it->first, req.timeWindow.startTime().toString("%F %T"),
-		             req.timeWindow.endTime().toString("%F %T"));
-		_report << " + TimeWindow (" << it->first << "): " << req.timeWindow.startTime().toString("%F %T")
-		        << ", " << req.timeWindow.endTime().toString("%F %T") << std::endl;
+	if ( !startAcquisition(origin ? origin->publicID() : pickInput->publicID()) ) {
+		return;
 	}
 
-	SEISCOMP_INFO("Set stream timeout to %f seconds", _initialAcquisitionTimeout);
-	_acquisitionTimeout = _initialAcquisitionTimeout;
-	_firstRecord = true;
-
-	_result << " + Processing" << std::endl;
-
-	_acquisitionTimer.restart();
-	_noDataTimer.restart();
-	_hasRecordsReceived = false;
-
-	SEISCOMP_INFO("Starting timeout monitor");
-	_timer.start();
-	readRecords(false);
-	if ( _timer.isActive() ) {
-		_timer.stop();
+	// Offline processing handles one origin after another unless
+	// results are deferred
+	if ( !_asynchronous && !_deferResults ) {
+		waitForAcquisitions();
 	}
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -1070,6 +1124,7 @@ int AmpTool::addProcessor(Processing::AmplitudeProcessor *proc,
 
 	std::string streamIDs[3];
 	WaveformStreamID cwids[3];
+	double samplingFrequencies[3] = { 0, 0, 0 };
 	WaveformStreamID wid = pick->waveformID();
 
 	// Adjust waveformID with bindings
@@ -1147,6 +1202,12 @@ int AmpTool::addProcessor(Processing::AmplitudeProcessor *proc,
 		if ( !i )
 			receiver = tc.comps[components[i]]->sensorLocation();
 
+		try {
+			samplingFrequencies[i] = (double)tc.comps[components[i]]->sampleRateNumerator() /
+			                         tc.comps[components[i]]->sampleRateDenominator();
+		}
+		catch ( ... ) {}
+
 		if ( proc->streamConfig(components[i]).gain == 0.0 ) {
 			SEISCOMP_LOG(_errorChannel, "%s: no gain found for %s -> ignoring Arrival %s",
 			             proc->type().c_str(), streamIDs[i].c_str(), pick->publicID().c_str());
@@ -1197,15 +1258,6 @@ int AmpTool::addProcessor(Processing::AmplitudeProcessor *proc,
 	}
 
 
-	if ( _processors.empty() )
-		openStream();
-
-	if ( recordStream() == NULL ) {
-		SEISCOMP_ERROR("Opening the acquisition stream failed");
-		printReport();
-		return -2;
-	}
-
 	for ( int i = 0; i < componentCount; ++i ) {
 		pair<ProcessorMap::iterator, bool> handle =
 			_processors.insert(ProcessorMap::value_type(streamIDs[i], ProcessorSlot()));
@@ -1219,10 +1271,13 @@ int AmpTool::addProcessor(Processing::AmplitudeProcessor *proc,
 			req.timeWindow = proc->safetyTimeWindow();
 		}
 
+		StreamRequest &streamReq = req.streams[streamIDs[i]];
+		streamReq.timeWindows.push_back(proc->safetyTimeWindow());
+
 		// The second value of the pair describes whether a new entry has been inserted or not
 		if ( handle.second ) {
-			req.streams.insert(cwids[i]);
-			//addStream(cwids[i].networkCode(), cwids[i].stationCode(), cwids[i].locationCode(), cwids[i].channelCode());
+			streamReq.waveformID = cwids[i];
+			streamReq.samplingFrequency = samplingFrequencies[i];
 			_report << "       + stream request = " << streamIDs[i] << std::endl;
 		}
 
@@ -1238,10 +1293,136 @@ int AmpTool::addProcessor(Processing::AmplitudeProcessor *proc,
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t AmpTool::addStreamRequests(Acquisition *acq,
+                                  Private::WaveformCache::Records &cachedRecords) {
+	// Each stream is requested by default with the union time window of its
+	// station. If splitting is enabled, the time windows of all processors
+	// of a stream are merged if they overlap or their gap does not exceed
+	// the configured maximum and requested separately otherwise.
+	size_t requests = 0;
+	double requestedSeconds = 0;
+	double savedSeconds = 0;
+	double savedBytes = 0;
+
+	for ( RequestMap::iterator it = _stationRequests.begin(); it != _stationRequests.end(); ++it ) {
+		StationRequest &req = it->second;
+
+		SC_FMT_DEBUG("{} time window: {} - {}",
+		             it->first, req.timeWindow.startTime().toString("%F %T"),
+		             req.timeWindow.endTime().toString("%F %T"));
+		_report << " + TimeWindow (" << it->first << "): " << req.timeWindow.startTime().toString("%F %T")
+		        << ", " << req.timeWindow.endTime().toString("%F %T") << std::endl;
+
+		for ( StreamRequestMap::iterator sit = req.streams.begin(); sit != req.streams.end(); ++sit ) {
+			const string &streamID = sit->first;
+			const StreamRequest &streamReq = sit->second;
+			const WaveformStreamID &wsid = streamReq.waveformID;
+
+			vector<Core::TimeWindow> windows;
+			if ( _splitRequests ) {
+				windows = Private::mergeTimeWindows(streamReq.timeWindows, _maxRequestGap);
+			}
+			else {
+				windows.push_back(req.timeWindow);
+			}
+
+			double streamSeconds = 0;
+
+			for ( const auto &tw : windows ) {
+				Time startTime = tw.startTime();
+
+				if ( _waveformCache.isEnabled() ) {
+					startTime = _waveformCache.lookup(streamID, tw, cachedRecords);
+					if ( startTime >= tw.endTime() ) {
+						_report << "   + " << streamID << " [served from cache]" << std::endl;
+						continue;
+					}
+
+					if ( startTime > tw.startTime() ) {
+						// Only request the missing tail and drop records
+						// which have been served already from the cache
+						acq->cachedCoverage[streamID].push_back(Core::TimeWindow(tw.startTime(), startTime));
+						_report << "   + " << streamID << " [served from cache until "
+						        << startTime.toString("%F %T") << "]" << std::endl;
+					}
+				}
+
+				if ( windows.size() > 1 ) {
+					_report << "   + " << streamID << " [request "
+					        << startTime.toString("%F %T") << ", "
+					        << tw.endTime().toString("%F %T") << "]" << std::endl;
+				}
+
+				acq->stream->addStream(wsid.networkCode(), wsid.stationCode(),
+				                       wsid.locationCode(), wsid.channelCode(),
+				                       startTime, tw.endTime());
+				streamSeconds += (double)(tw.endTime() - startTime);
+				++requests;
+			}
+
+			double saved = (double)req.timeWindow.length() - streamSeconds;
+			requestedSeconds += streamSeconds;
+			if ( saved > 0 ) {
+				savedSeconds += saved;
+				// Rough estimate of uncompressed 32 bit samples
+				savedBytes += saved * streamReq.samplingFrequency * 4;
+			}
+		}
+	}
+
+	_report << " + Data request: " << requests << " time windows, "
+	        << requestedSeconds << "s requested, " << savedSeconds << "s (~"
+	        << (size_t)savedBytes << " bytes) saved" << std::endl;
+
+	_requestStatistics.windows += requests;
+	_requestStatistics.requestedSeconds += requestedSeconds;
+	_requestStatistics.savedSeconds += savedSeconds;
+	_requestStatistics.savedBytes += savedBytes;
+
+	return requests;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::printStatistics() {
+	if ( _requestStatistics.windows ) {
+		SEISCOMP_INFO("Data requests: %lu time windows, %.0fs requested, "
+		              "%.0fs (~%.0f bytes) saved",
+		              (unsigned long)_requestStatistics.windows,
+		              _requestStatistics.requestedSeconds,
+		              _requestStatistics.savedSeconds,
+		              _requestStatistics.savedBytes);
+	}
+
+	if ( !_waveformCache.isEnabled() ) {
+		return;
+	}
+
+	const auto &stats = _waveformCache.statistics();
+	double hitRate = stats.requests ?
+		100.0 * (stats.hits + stats.partialHits) / stats.requests : 0.0;
+
+	SEISCOMP_INFO("Waveform cache: %lu stream requests, %lu hits, "
+	              "%lu partial hits, %lu misses (%.1f%% served from cache), "
+	              "%lu records served, %lu streams evicted",
+	              (unsigned long)stats.requests, (unsigned long)stats.hits,
+	              (unsigned long)stats.partialHits, (unsigned long)stats.misses,
+	              hitRate, (unsigned long)stats.recordsServed,
+	              (unsigned long)stats.evictedStreams);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void AmpTool::printReport() {
-	SEISCOMP_LOG(_processingInfoChannel, "%s%s", _report.str().c_str(),
-	             _result.str().c_str());
+	SEISCOMP_LOG(_processingInfoChannel, "%s", _report.str().c_str());
+	_report.str(std::string());
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1508,19 +1689,10 @@ void AmpTool::storeLocalAmplitude(const Seiscomp::Processing::AmplitudeProcessor
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-bool AmpTool::storeRecord(Record *rec) {
-	if ( _firstRecord ) {
-		SEISCOMP_INFO("Data request: got first record, set timeout to %f seconds",
-		              _runningAcquisitionTimeout);
-		_noDataTimer.restart();
-		_acquisitionTimeout = _runningAcquisitionTimeout;
-		_firstRecord = false;
-	}
-
-	// This flag is resetted by handleTimeout each second
-	_hasRecordsReceived = true;
-	handleRecord(rec);
-	return true;
+void AmpTool::deferAmplitude(Acquisition *acq,
+                             const Seiscomp::Processing::AmplitudeProcessor *proc,
+                             const Seiscomp::Processing::AmplitudeProcessor::Result &res) {
+	acq->results.push_back(DeferredResult{proc, res, res.record, false});
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1528,47 +1700,124 @@ bool AmpTool::storeRecord(Record *rec) {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-void AmpTool::handleRecord(Record *rec) {
-	Seiscomp::RecordPtr tmp(rec);
+void AmpTool::emitDeferredAmplitude(const Seiscomp::Processing::AmplitudeProcessor *proc,
+                                    const Seiscomp::Processing::AmplitudeProcessor::Result &res) {
+	// Amplitudes of previous origins for the same pick may not have been
+	// known when the processor was created. Handle them as sequential
+	// processing would have done: skip the amplitude or update the
+	// existing one if reprocessing.
+	if ( _ampIDReuse.find(proc) == _ampIDReuse.end() ) {
+		Amplitude *existingAmp = hasAmplitude(getAmplitudes(proc->referencingPickID()), proc->type());
+		if ( existingAmp ) {
+			if ( !_reprocessAmplitudes ) {
+				SEISCOMP_INFO("Skipping %s amplitude for pick %s, amplitude exists already",
+				              proc->type().c_str(), proc->referencingPickID().c_str());
+				return;
+			}
 
-	std::string streamID = rec->streamID();
+			// Removed with the processors of the acquisition
+			_ampIDReuse[proc] = existingAmp;
+		}
+	}
 
-	ProcessorMap::iterator slot_it = _processors.find(streamID);
-	if ( slot_it == _processors.end() ) return;
+	emitAmplitude(proc, res);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-	for ( ProcessorSlot::iterator it = slot_it->second.begin(); it != slot_it->second.end(); ) {
-		(*it)->feed(rec);
-		if ( (*it)->status() == WaveformProcessor::InProgress ) {
-			// processor still needs some time (progress = (*it)->statusValue())
-			++it;
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool AmpTool::startAcquisition(const std::string &label) {
+	std::unique_ptr<Acquisition> acq(new Acquisition);
+	acq->label = label;
+
+	for ( ProcessorMap::iterator slot_it = _processors.begin();
+	      slot_it != _processors.end(); ++slot_it ) {
+		acq->allProcessors.insert(acq->allProcessors.end(),
+		                          slot_it->second.begin(), slot_it->second.end());
+	}
+
+	acq->processors.swap(_processors);
+
+	acq->stream = IO::RecordStream::Open(recordStreamURL().c_str());
+	if ( !acq->stream ) {
+		SEISCOMP_ERROR("Opening the acquisition stream failed");
+		_report << " + Opening the acquisition stream failed" << std::endl;
+		printReport();
+
+		releaseProcessors(acq.get());
+		return false;
+	}
+
+	// Deferred results are emitted in order of the acquisition IDs
+	acq->id = _nextAcquisitionID++;
+
+	if ( _deferResults ) {
+		acq->deferred = true;
+		for ( const auto &proc : acq->allProcessors ) {
+			proc->setPublishFunction(bind(&AmpTool::deferAmplitude, this, acq.get(),
+			                              placeholders::_1, placeholders::_2));
 		}
-		else if ( (*it)->status() == WaveformProcessor::Finished ) {
-			_result << "   + " << (*it)->type() << ", " << slot_it->first.c_str() << std::endl;
-			if ( (*it)->noiseOffset() )
-				_result << "     + noiseOffset = " << *(*it)->noiseOffset() << std::endl;
-			else
-				_result << "     - noiseOffset" << std::endl;
+	}
 
-			if ( (*it)->noiseAmplitude() )
-				_result << "     + noiseAmplitude = " << *(*it)->noiseAmplitude() << std::endl;
-			else
-				_result << "     - noiseAmplitude" << std::endl;
-			// processor finished successfully
-			it = slot_it->second.erase(it);
+	Private::WaveformCache::Records cachedRecords;
+	size_t requests = addStreamRequests(acq.get(), cachedRecords);
+
+	acq->report = _report.str();
+	_report.str(std::string());
+
+	acq->result << " + Processing" << std::endl;
+	acq->timeout = _initialAcquisitionTimeout;
+
+	for ( const auto &rec : cachedRecords ) {
+		if ( acq->processors.empty() ) {
+			break;
 		}
-		else if ( (*it)->isFinished() ) {
-			_result << "   - " << (*it)->type() << ", " << slot_it->first.c_str() << " ("
-			        << (*it)->status().toString()
-			        << ")" << std::endl;
-			createDummyAmplitude(it->get());
-			it = slot_it->second.erase(it);
+
+		handleRecord(acq.get(), rec.get());
+	}
+
+	if ( !requests || acq->processors.empty() ) {
+		if ( !requests ) {
+			SEISCOMP_INFO("%s: all data served from waveform cache", label.c_str());
 		}
-		else
-			++it;
+
+		closeAcquisition(*acq);
+
+		if ( acq->deferred ) {
+			int id = acq->id;
+			_completedAcquisitions[id] = std::move(acq);
+			emitCompletedAcquisitions();
+		}
+		else {
+			finishAcquisition(acq.get());
+		}
+
+		return true;
 	}
 
-	if ( slot_it->second.empty() )
-		_processors.erase(slot_it);
+	SEISCOMP_INFO("%s: set stream timeout to %f seconds",
+	              label.c_str(), _initialAcquisitionTimeout);
+
+	int id = acq->id;
+	IO::RecordStreamPtr stream = acq->stream;
+	Acquisition *deferred = acq->deferred ? acq.get() : nullptr;
+
+	{
+		boost::mutex::scoped_lock l(_acquisitionMutex);
+		acq->noDataTimer.restart();
+		_acquisitions[id] = std::move(acq);
+	}
+
+	_readers[id] = std::thread(&AmpTool::acquire, this, id, stream, deferred);
+
+	if ( !_timer.isActive() ) {
+		SEISCOMP_INFO("Starting timeout monitor");
+		_timer.start();
+	}
+
+	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1576,22 +1825,191 @@ void AmpTool::handleRecord(Record *rec) {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-void AmpTool::handleTimeout() {
-	//SEISCOMP_INFO("[data acquisition monitor] checking timeouts");
-	// Check for data acquisition timeout
-	if ( !_hasRecordsReceived ) {
-		if ( _noDataTimer.elapsed().seconds() >= _acquisitionTimeout ) {
-			boost::mutex::scoped_lock l(_acquisitionMutex);
-			if ( recordStream() ) {
-				SEISCOMP_INFO("[data acquisition monitor] timeout reached: closing stream");
-				recordStream()->close();
+void AmpTool::closeAcquisition(Acquisition &acq) {
+	boost::mutex::scoped_lock l(_acquisitionMutex);
+	if ( !acq.closed ) {
+		acq.stream->close();
+		acq.closed = true;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::finishAcquisition(Acquisition *acq) {
+	acq->report += " + Data request: finished\n";
+
+	for ( ProcessorMap::iterator slot_it = acq->processors.begin();
+	      slot_it != acq->processors.end(); ++slot_it ) {
+		for ( ProcessorSlot::iterator it = slot_it->second.begin();
+		      it != slot_it->second.end(); ++it ) {
+			acq->result << "   - " << (*it)->type() << ", " << slot_it->first.c_str()
+			            << " (" << (*it)->status().toString()
+			            << ", " << (*it)->statusValue() << "%)" << std::endl;
+
+			acq->result << "     - TimeWindow: " << (*it)->safetyTimeWindow().startTime().toString("%F %T") << ", "
+			            << (*it)->safetyTimeWindow().endTime().toString("%F %T") << std::endl;
+
+			(*it)->close();
+		}
+	}
+
+	acq->processors.clear();
+	releaseProcessors(acq);
+
+	double seconds = (double)acq->acquisitionTimer.elapsed();
+	SEISCOMP_INFO("%s: acquisition took %.2f seconds", acq->label.c_str(), seconds);
+	printStatistics();
+
+	SEISCOMP_LOG(_processingInfoChannel, "%s%s", acq->report.c_str(),
+	             acq->result.str().c_str());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::releaseProcessors(Acquisition *acq) {
+	for ( const auto &proc : acq->allProcessors ) {
+		_ampIDReuse.erase(proc.get());
+		_runningAmplitudes.erase({proc->referencingPickID(), proc->type()});
+	}
+
+	acq->allProcessors.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::joinReader(int id) {
+	auto it = _readers.find(id);
+	if ( it == _readers.end() ) {
+		return;
+	}
+
+	// The reader returns right after it has queued the end of its
+	// acquisition
+	it->second.join();
+	_readers.erase(it);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::waitForAcquisition() {
+	{
+		std::unique_lock<std::mutex> lk(_recordQueueMutex);
+		_recordQueueCondition.wait(lk, [this]() { return !_recordQueue.empty(); });
+	}
+
+	processQueuedRecords();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::waitForAcquisitions() {
+	while ( !_acquisitions.empty() ) {
+		waitForAcquisition();
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::emitCompletedAcquisitions() {
+	while ( !_completedAcquisitions.empty() ) {
+		Acquisitions::iterator it = _completedAcquisitions.begin();
+
+		// Wait for running acquisitions which were started earlier
+		if ( !_acquisitions.empty() && _acquisitions.begin()->first < it->first ) {
+			break;
+		}
+
+		Acquisition *acq = it->second.get();
+		for ( const auto &res : acq->results ) {
+			if ( res.dummy ) {
+				// Sequential processing would not have run the processor
+				// if an amplitude had been computed before
+				if ( !hasAmplitude(getAmplitudes(res.processor->referencingPickID()),
+				                   res.processor->type()) ) {
+					createDummyAmplitude(res.processor);
+				}
+			}
+			else {
+				emitDeferredAmplitude(res.processor, res.result);
 			}
 		}
+
+		acq->results.clear();
+		finishAcquisition(acq);
+		_completedAcquisitions.erase(it);
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::acquire(int id, IO::RecordStreamPtr stream, Acquisition *deferred) {
+	// NOTE: This runs in its own thread. Records are queued and processed
+	//       by the main thread unless results are deferred. Then the
+	//       processors of the acquisition are fed here and are not
+	//       touched by the main thread until the end of the acquisition
+	//       has been signalled.
+	try {
+		IO::RecordInput input(stream.get(), recordDataType(), _recordInputHint);
+		for ( IO::RecordIterator it = input.begin(); it != input.end(); ++it ) {
+			RecordPtr rec = *it;
+			if ( !rec ) {
+				continue;
+			}
+
+			{
+				boost::mutex::scoped_lock l(_acquisitionMutex);
+				Acquisitions::iterator ait = _acquisitions.find(id);
+				if ( ait != _acquisitions.end() ) {
+					Acquisition &acq = *ait->second;
+					if ( acq.firstRecord ) {
+						SEISCOMP_INFO("%s: got first record, set timeout to %f seconds",
+						              acq.label.c_str(), _runningAcquisitionTimeout);
+						acq.noDataTimer.restart();
+						acq.timeout = _runningAcquisitionTimeout;
+						acq.firstRecord = false;
+					}
+
+					// This flag is resetted by handleTimeout each second
+					acq.hasRecordsReceived = true;
+				}
+			}
+
+			if ( deferred ) {
+				handleRecord(deferred, rec.get());
+			}
+			else {
+				pushRecord(id, rec.get());
+			}
+		}
+	}
+	catch ( std::exception &e ) {
+		SEISCOMP_ERROR("Acquisition %d: %s", id, e.what());
 	}
-	else
-		_noDataTimer.restart();
 
-	_hasRecordsReceived = false;
+	// Signal the end of the acquisition. The thread is joined by the main
+	// thread once this has been processed or in done().
+	pushRecord(id, nullptr);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1599,41 +2017,194 @@ void AmpTool::handleTimeout() {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-void AmpTool::acquisitionFinished() {
-	_timer.stop();
-	SEISCOMP_INFO("Stopped timeout monitor");
+void AmpTool::pushRecord(int id, Record *rec) {
+	bool wakeUp;
 
 	{
-		boost::mutex::scoped_lock l(_acquisitionMutex);
-		closeStream();
+		std::lock_guard<std::mutex> lk(_recordQueueMutex);
+		wakeUp = _recordQueue.empty();
+		_recordQueue.push_back(QueuedRecord{id, rec});
 	}
 
-	SEISCOMP_INFO("Closed stream");
+	_recordQueueCondition.notify_all();
 
-	_report << " + Data request: finished" << std::endl;
+	// Only notify the main thread once until the queue has been processed
+	if ( wakeUp && _asynchronous ) {
+		sendNotification(Client::Notification(AcquisitionNotification));
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-	for ( ProcessorMap::iterator slot_it = _processors.begin();
-	      slot_it != _processors.end(); ++slot_it ) {
-		for ( ProcessorSlot::iterator it = slot_it->second.begin();
-		      it != slot_it->second.end(); ++it ) {
-			_result << "   - " << (*it)->type() << ", " << slot_it->first.c_str()
-			        << " (" << (*it)->status().toString()
-			        << ", " << (*it)->statusValue() << "%)" << std::endl;
 
-			_result << "     - TimeWindow: " << (*it)->safetyTimeWindow().startTime().toString("%F %T") << ", "
-			        << (*it)->safetyTimeWindow().endTime().toString("%F %T") << std::endl;
 
-			(*it)->close();
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::processQueuedRecords() {
+	RecordQueue records;
+
+	{
+		std::lock_guard<std::mutex> lk(_recordQueueMutex);
+		records.swap(_recordQueue);
+	}
+
+	for ( auto &item : records ) {
+		Acquisitions::iterator it = _acquisitions.find(item.acquisitionID);
+		if ( it == _acquisitions.end() ) {
+			continue;
+		}
+
+		Acquisition *acq = it->second.get();
+		Record *rec = item.record.get();
+
+		if ( rec ) {
+			CoverageMap::iterator cit = acq->cachedCoverage.find(rec->streamID());
+			if ( cit != acq->cachedCoverage.end() ) {
+				bool cached = false;
+				for ( const auto &tw : cit->second ) {
+					if ( rec->endTime() > tw.startTime() && rec->endTime() <= tw.endTime() ) {
+						cached = true;
+						break;
+					}
+				}
+
+				if ( cached ) {
+					// Already fed from the waveform cache
+					continue;
+				}
+			}
+
+			_waveformCache.feed(rec);
+			handleRecord(acq, rec);
+			continue;
+		}
+
+		// End of acquisition
+		joinReader(item.acquisitionID);
+
+		std::unique_ptr<Acquisition> finished;
+
+		{
+			boost::mutex::scoped_lock l(_acquisitionMutex);
+			finished = std::move(it->second);
+			_acquisitions.erase(it);
+		}
+
+		if ( finished->deferred ) {
+			int id = finished->id;
+			_completedAcquisitions[id] = std::move(finished);
+		}
+		else {
+			finishAcquisition(finished.get());
 		}
 	}
 
-	_processors.clear();
+	emitCompletedAcquisitions();
 
-	double seconds = (double)_acquisitionTimer.elapsed();
-	SEISCOMP_INFO("Acquisition took %.2f seconds", seconds);
+	if ( _acquisitions.empty() && _timer.isActive() ) {
+		_timer.stop();
+		SEISCOMP_INFO("Stopped timeout monitor");
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-	printReport();
 
-	_report.str(std::string());
-	_result.str(std::string());
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool AmpTool::dispatchNotification(int type, Core::BaseObject *obj) {
+	if ( type == AcquisitionNotification ) {
+		processQueuedRecords();
+		return true;
+	}
+
+	return StreamApplication::dispatchNotification(type, obj);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::handleRecord(Acquisition *acq, Record *rec) {
+	std::string streamID = rec->streamID();
+
+	ProcessorMap::iterator slot_it = acq->processors.find(streamID);
+	if ( slot_it == acq->processors.end() ) return;
+
+	for ( ProcessorSlot::iterator it = slot_it->second.begin(); it != slot_it->second.end(); ) {
+		(*it)->feed(rec);
+		if ( (*it)->status() == WaveformProcessor::InProgress ) {
+			// processor still needs some time (progress = (*it)->statusValue())
+			++it;
+		}
+		else if ( (*it)->status() == WaveformProcessor::Finished ) {
+			acq->result << "   + " << (*it)->type() << ", " << slot_it->first.c_str() << std::endl;
+			if ( (*it)->noiseOffset() )
+				acq->result << "     + noiseOffset = " << *(*it)->noiseOffset() << std::endl;
+			else
+				acq->result << "     - noiseOffset" << std::endl;
+
+			if ( (*it)->noiseAmplitude() )
+				acq->result << "     + noiseAmplitude = " << *(*it)->noiseAmplitude() << std::endl;
+			else
+				acq->result << "     - noiseAmplitude" << std::endl;
+			// processor finished successfully
+			it = slot_it->second.erase(it);
+		}
+		else if ( (*it)->isFinished() ) {
+			acq->result << "   - " << (*it)->type() << ", " << slot_it->first.c_str() << " ("
+			            << (*it)->status().toString()
+			            << ")" << std::endl;
+			if ( acq->deferred ) {
+				acq->results.push_back(DeferredResult{it->get(), AmplitudeProcessor::Result(), nullptr, true});
+			}
+			else {
+				createDummyAmplitude(it->get());
+			}
+			it = slot_it->second.erase(it);
+		}
+		else
+			++it;
+	}
+
+	if ( slot_it->second.empty() )
+		acq->processors.erase(slot_it);
+
+	// All processors finished, do not wait for the remaining data or
+	// the acquisition timeout
+	if ( acq->processors.empty() ) {
+		closeAcquisition(*acq);
+	}
 }
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void AmpTool::handleTimeout() {
+	// NOTE: This is called from the timer thread
+	boost::mutex::scoped_lock l(_acquisitionMutex);
+
+	for ( auto &item : _acquisitions ) {
+		Acquisition &acq = *item.second;
+		if ( acq.closed ) {
+			continue;
+		}
+
+		// Check for data acquisition timeout
+		if ( !acq.hasRecordsReceived ) {
+			if ( acq.noDataTimer.elapsed().seconds() >= acq.timeout ) {
+				SEISCOMP_INFO("[data acquisition monitor] %s: timeout reached: closing stream",
+				              acq.label.c_str());
+				acq.stream->close();
+				acq.closed = true;
+			}
+		}
+		else
+			acq.noDataTimer.restart();
+
+		acq.hasRecordsReceived = false;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -18,6 +18,7 @@
 #define SEISCOMP_APPLICATIONS_AMPTOOL_H__
 
 #include <seiscomp/client/streamapplication.h>
+#include <seiscomp/io/recordstream.h>
 #include <seiscomp/processing/amplitudeprocessor.h>
 #include <seiscomp/datamodel/publicobjectcache.h>
 #include <seiscomp/datamodel/eventparameters.h>
@@ -27,9 +28,18 @@
 #define SEISCOMP_COMPONENT AmpTool
 #include <seiscomp/logging/log.h>
 
+#include "waveformcache.h"
+
 #include <boost/thread/mutex.hpp>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <set>
 #include <sstream>
+#include <thread>
 
 
 namespace Seiscomp {
@@ -62,11 +72,9 @@ class AmpTool : public Seiscomp::Client::StreamApplication {
 		void done();
 		void printUsage() const;
 
-		bool storeRecord(Seiscomp::Record *rec);
-		void handleRecord(Seiscomp::Record *rec);
 		void handleTimeout();
 
-		void acquisitionFinished();
+		bool dispatchNotification(int type, Seiscomp::Core::BaseObject *obj);
 
 		void addObject(const std::string&, Seiscomp::DataModel::Object* object);
 		void updateObject(const std::string&, Seiscomp::DataModel::Object* object);
@@ -104,21 +112,30 @@ class AmpTool : public Seiscomp::Client::StreamApplication {
 		void removedFromCache(Seiscomp::DataModel::PublicObject *);
 
 		void printReport();
+		void printStatistics();
 
 		Seiscomp::DataModel::AmplitudePtr createAmplitude(const Seiscomp::Processing::AmplitudeProcessor *,
 		                                                  const Seiscomp::Processing::AmplitudeProcessor::Result &);
 
 
 	private:
-		struct CompareWaveformStreamID {
-			bool operator()(const Seiscomp::DataModel::WaveformStreamID &lhs,
-			                const Seiscomp::DataModel::WaveformStreamID &rhs) const;
+		struct StreamRequest {
+			Seiscomp::DataModel::WaveformStreamID   waveformID;
+			double                                  samplingFrequency{0};
+			std::vector<Seiscomp::Core::TimeWindow> timeWindows;
 		};
 
-		typedef std::set<Seiscomp::DataModel::WaveformStreamID,CompareWaveformStreamID> WaveformIDSet;
+		typedef std::map<std::string, StreamRequest> StreamRequestMap;
 		struct StationRequest {
 			Seiscomp::Core::TimeWindow timeWindow;
-			WaveformIDSet streams;
+			StreamRequestMap streams;
+		};
+
+		struct RequestStatistics {
+			size_t windows{0};
+			double requestedSeconds{0};
+			double savedSeconds{0};
+			double savedBytes{0};
 		};
 
 		typedef std::map<const Seiscomp::Processing::AmplitudeProcessor*, Seiscomp::DataModel::AmplitudePtr> ProcAmpReuseMap;
@@ -129,11 +146,85 @@ class AmpTool : public Seiscomp::Client::StreamApplication {
 		typedef std::map<std::string, ProcessorSlot>                          ProcessorMap;
 		typedef std::map<std::string, Seiscomp::Util::KeyValuesPtr>           ParameterMap;
 		typedef std::map<std::string, StationRequest>                         RequestMap;
+		typedef std::map<std::string, std::vector<Seiscomp::Core::TimeWindow>> CoverageMap;
 
 		typedef std::map<std::string, Seiscomp::Processing::StreamPtr>        StreamMap;
 		typedef Seiscomp::DataModel::PublicObjectTimeSpanBuffer               Cache;
 		typedef Seiscomp::DataModel::EventParametersPtr                       EventParametersPtr;
 
+		/**
+		 * An acquisition holds the processors of one origin (or pick) and
+		 * the RecordStream reading their data. Records are read in a
+		 * separate thread and passed to the main thread through the record
+		 * queue. Several acquisitions can be active at the same time.
+		 */
+		struct DeferredResult {
+			const Seiscomp::Processing::AmplitudeProcessor  *processor;
+			Seiscomp::Processing::AmplitudeProcessor::Result result;
+			// Keeps the record referenced by the result alive
+			Seiscomp::RecordCPtr                             record;
+			bool                                             dummy;
+		};
+
+		struct Acquisition {
+			int                           id;
+			std::string                   label;
+			ProcessorMap                  processors;
+			std::vector<Seiscomp::Processing::AmplitudeProcessorPtr> allProcessors;
+			CoverageMap                   cachedCoverage;
+			Seiscomp::IO::RecordStreamPtr stream;
+			std::string                   report;
+			std::stringstream             result;
+			Seiscomp::Util::StopWatch     acquisitionTimer;
+
+			// If set then records are processed by the acquisition thread
+			// and results are emitted later by the main thread
+			bool                          deferred{false};
+			std::vector<DeferredResult>   results;
+
+			// Guarded by _acquisitionMutex
+			Seiscomp::Util::StopWatch     noDataTimer;
+			double                        timeout;
+			bool                          firstRecord{true};
+			bool                          hasRecordsReceived{false};
+			bool                          closed{false};
+		};
+
+		struct QueuedRecord {
+			int                 acquisitionID;
+			Seiscomp::RecordPtr record;
+		};
+
+		typedef std::map<int, std::unique_ptr<Acquisition>>                  Acquisitions;
+		typedef std::map<int, std::thread>                                    Readers;
+		typedef std::set<std::pair<std::string, std::string>>                 AmplitudeKeys;
+		typedef std::deque<QueuedRecord>                                      RecordQueue;
+
+		bool startAcquisition(const std::string &label);
+		void finishAcquisition(Acquisition *acq);
+		void waitForAcquisition();
+		void waitForAcquisitions();
+		void emitCompletedAcquisitions();
+		void closeAcquisition(Acquisition &acq);
+		void releaseProcessors(Acquisition *acq);
+		void joinReader(int id);
+
+		void acquire(int id, Seiscomp::IO::RecordStreamPtr stream, Acquisition *deferred);
+		void pushRecord(int id, Seiscomp::Record *rec);
+		void processQueuedRecords();
+
+		void handleRecord(Acquisition *acq, Seiscomp::Record *rec);
+
+		void deferAmplitude(Acquisition *acq,
+		                    const Seiscomp::Processing::AmplitudeProcessor *,
+		                    const Seiscomp::Processing::AmplitudeProcessor::Result &);
+		void emitDeferredAmplitude(const Seiscomp::Processing::AmplitudeProcessor *,
+		                           const Seiscomp::Processing::AmplitudeProcessor::Result &);
+
+		size_t addStreamRequests(Acquisition *acq,
+		                         Seiscomp::Private::WaveformCache::Records &cachedRecords);
+
+
 		StreamMap                  _streams;
 		double                     _fExpiry{1.0};
 		bool                       _fetchMissingAmplitudes{true};
@@ -146,6 +237,10 @@ class AmpTool : public Seiscomp::Client::StreamApplication {
 		AmplitudeList              _amplitudeTypes;
 		ProcessorMap               _processors;
 		RequestMap                 _stationRequests;
+		Seiscomp::Private::WaveformCache _waveformCache;
+		bool                       _splitRequests{false};
+		double                     _maxRequestGap{10.0};
+		RequestStatistics          _requestStatistics;
 		ParameterMap               _parameters;
 
 		AmplitudeMap               _pickAmplitudes;
@@ -154,7 +249,6 @@ class AmpTool : public Seiscomp::Client::StreamApplication {
 		Cache                      _cache;
 
 		bool                       _testMode;
-		bool                       _firstRecord;
 		bool                       _dumpRecords;
 		bool                       _reprocessAmplitudes;
 		bool                       _forceReprocessing{false};
@@ -166,15 +260,29 @@ class AmpTool : public Seiscomp::Client::StreamApplication {
 
 		double                     _initialAcquisitionTimeout{30.0};
 		double                     _runningAcquisitionTimeout{2.0};
-		double                     _acquisitionTimeout;
-		bool                       _hasRecordsReceived;
 		bool                       _populateVersionInfo{false};
 
 		Seiscomp::Util::Timer      _timer;
 		boost::mutex               _acquisitionMutex;
 
-		Seiscomp::Util::StopWatch  _acquisitionTimer;
-		Seiscomp::Util::StopWatch  _noDataTimer;
+		Acquisitions               _acquisitions;
+		Acquisitions               _completedAcquisitions;
+		// The reader threads of running acquisitions, only accessed by the
+		// main thread
+		Readers                    _readers;
+		// (pickID, amplitude type) of all processors of running
+		// acquisitions to prevent duplicate amplitudes if an origin is
+		// relocated while its acquisition is still running
+		AmplitudeKeys              _runningAmplitudes;
+		Seiscomp::Record::Hint     _recordInputHint{Seiscomp::Record::DATA_ONLY};
+		int                        _nextAcquisitionID{0};
+		std::atomic<bool>          _asynchronous{false};
+		int                        _threads{1};
+		bool                       _deferResults{false};
+
+		RecordQueue                _recordQueue;
+		std::mutex                 _recordQueueMutex;
+		std::condition_variable    _recordQueueCondition;
 
 		Seiscomp::Logging::Channel *_errorChannel;
 		Seiscomp::Logging::Output  *_errorOutput;
@@ -183,7 +291,6 @@ class AmpTool : public Seiscomp::Client::StreamApplication {
 		Seiscomp::Logging::Output  *_processingInfoOutput;
 
 		std::stringstream           _report;
-		std::stringstream           _result;
 
 		SingleAmplitudeMap          _reprocessMap;
 
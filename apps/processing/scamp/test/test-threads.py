@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+
+###########################################################################
+# Copyright (C) GFZ Potsdam                                               #
+# All rights reserved.                                                    #
+#                                                                         #
+# GNU Affero General Public License Usage                                 #
+# This file may be used under the terms of the GNU Affero                 #
+# Public License version 3.0 as published by the Free Software Foundation #
+# and appearing in the file LICENSE included in the packaging of this     #
+# file. Please review the following information to ensure the GNU Affero  #
+# Public License version 3.0 requirements will be met:                    #
+# https://www.gnu.org/licenses/agpl-3.0.html.                             #
+###########################################################################
+
+import os
+import subprocess
+import sys
+import xml.etree.ElementTree as ET
+
+TIMEOUT = 30.0
+
+
+class TestThreads:
+    """
+    Processes several origins sharing the same picks with one and with
+    several threads. The amplitudes of the threaded run must match the
+    sequential run regardless of the order in which the acquisitions
+    finish.
+    """
+
+    def __init__(self):
+        self.rootdir = os.environ.get("SEISCOMP_ROOT")
+
+    def run(self, name, threads, options):
+        inputFile = os.path.join(self.rootdir, "input/ep.xml")
+        outputFile = f"scamp-{name}-{threads}.stdout"
+        errorFile = f"scamp-{name}-{threads}.stderr"
+
+        cmd = [
+            "scamp",
+            "--ep",
+            inputFile,
+            "-I",
+            f"sdsarchive://{os.path.join(self.rootdir, 'sds')}",
+            "--inventory-db",
+            f"sqlite3://{os.path.join(self.rootdir, 'seiscomp.sqlite3')}",
+            "--threads",
+            str(threads),
+        ] + options
+
+        print(f"running scamp command: {' '.join(cmd)} >{outputFile} 2>{errorFile}")
+        try:
+            with open(outputFile, "w", encoding="utf-8") as fdOut:
+                with open(errorFile, "w", encoding="utf-8") as fdErr:
+                    subprocess.run(
+                        cmd,
+                        stdout=fdOut,
+                        stderr=fdErr,
+                        timeout=TIMEOUT,
+                        check=True,
+                    )
+        except Exception as e:
+            raise ValueError(f"invalid scamp test run: {name}") from e
+
+        return self.amplitudes(outputFile)
+
+    @staticmethod
+    def amplitudes(filename):
+        # Public IDs and creation times differ between runs, compare
+        # everything else
+        amps = []
+        for amp in ET.parse(filename).getroot().iter():
+            if not amp.tag.endswith("}amplitude"):
+                continue
+
+            for child in list(amp):
+                if child.tag.endswith("}creationInfo"):
+                    amp.remove(child)
+            amp.attrib.pop("publicID", None)
+            amps.append(ET.tostring(amp, encoding="unicode"))
+
+        return sorted(amps)
+
+    def test(self, name, options):
+        expected = self.run(name, 1, options)
+        if not expected:
+            raise ValueError(f"no amplitudes computed in scamp test run: {name}")
+
+        for threads in (2, 4):
+            got = self.run(name, threads, options)
+            if got != expected:
+                raise ValueError(
+                    f"amplitudes of scamp test run '{name}' with {threads} "
+                    f"threads differ from the sequential run: expected "
+                    f"{len(expected)}, got {len(got)}"
+                )
+
+    def __call__(self):
+        print("Testing scamp with multiple threads")
+
+        tests = [
+            ("threads", []),
+            ("threads-reprocess", ["--reprocess"]),
+        ]
+
+        for name, options in tests:
+            self.test(name, options)
+
+        return 0
+
+
+# ------------------------------------------------------------------------------
+if __name__ == "__main__":
+    app = TestThreads()
+    sys.exit(app())
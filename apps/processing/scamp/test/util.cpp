@@ -0,0 +1,109 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_TEST_MODULE scamp
+
+#include "../util.h"
+
+#include <seiscomp/unittest/unittests.h>
+
+#include <boost/test/included/unit_test.hpp>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::Private;
+
+
+namespace {
+
+
+Core::Time T(double offset) {
+	return Core::Time(1600000000, 0) + Core::TimeSpan(offset);
+}
+
+
+Core::TimeWindow TW(double start, double end) {
+	return Core::TimeWindow(T(start), T(end));
+}
+
+
+bool equal(const Core::TimeWindow &lhs, const Core::TimeWindow &rhs) {
+	return lhs.startTime() == rhs.startTime() && lhs.endTime() == rhs.endTime();
+}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(seiscomp_main_scamp_util)
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(merge_empty) {
+	BOOST_CHECK(mergeTimeWindows({}, 10).empty());
+
+	auto merged = mergeTimeWindows({TW(0, 10)}, 10);
+	BOOST_REQUIRE_EQUAL(merged.size(), 1);
+	BOOST_CHECK(equal(merged[0], TW(0, 10)));
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(merge_overlap) {
+	// Unsorted, overlapping and contained windows
+	auto merged = mergeTimeWindows({TW(20, 40), TW(0, 25), TW(5, 10)}, 0);
+	BOOST_REQUIRE_EQUAL(merged.size(), 1);
+	BOOST_CHECK(equal(merged[0], TW(0, 40)));
+
+	// Touching windows are merged without a gap allowance
+	merged = mergeTimeWindows({TW(0, 10), TW(10, 20)}, 0);
+	BOOST_REQUIRE_EQUAL(merged.size(), 1);
+	BOOST_CHECK(equal(merged[0], TW(0, 20)));
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(merge_gaps) {
+	// Gaps up to the maximum gap are merged
+	auto merged = mergeTimeWindows({TW(0, 10), TW(15, 20), TW(30, 40)}, 5);
+	BOOST_REQUIRE_EQUAL(merged.size(), 2);
+	BOOST_CHECK(equal(merged[0], TW(0, 20)));
+	BOOST_CHECK(equal(merged[1], TW(30, 40)));
+
+	// A window contained in the merged one does not shrink it and the
+	// gap is measured from the end of the merged window
+	merged = mergeTimeWindows({TW(0, 30), TW(5, 10), TW(34, 40)}, 5);
+	BOOST_REQUIRE_EQUAL(merged.size(), 1);
+	BOOST_CHECK(equal(merged[0], TW(0, 40)));
+
+	// Without gap allowance all separated windows are kept
+	merged = mergeTimeWindows({TW(30, 40), TW(0, 10), TW(15, 20)}, 0);
+	BOOST_REQUIRE_EQUAL(merged.size(), 3);
+	BOOST_CHECK(equal(merged[0], TW(0, 10)));
+	BOOST_CHECK(equal(merged[1], TW(15, 20)));
+	BOOST_CHECK(equal(merged[2], TW(30, 40)));
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,222 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_TEST_MODULE scamp
+
+#include "../waveformcache.h"
+
+#include <seiscomp/core/genericrecord.h>
+#include <seiscomp/core/typedarray.h>
+#include <seiscomp/unittest/unittests.h>
+
+#include <boost/test/included/unit_test.hpp>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::Private;
+
+
+namespace {
+
+
+Core::Time T(double offset) {
+	return Core::Time(1600000000, 0) + Core::TimeSpan(offset);
+}
+
+
+// Creates a record of a 1 Hz stream covering [start, start + samples)
+RecordPtr makeRecord(const string &sta, double start, int samples,
+                     double fs = 1.0) {
+	GenericRecord *rec = new GenericRecord("XX", sta, "", "HHZ", T(start), fs);
+	rec->setData(new DoubleArray(samples));
+	return rec;
+}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(seiscomp_main_scamp_waveformcache)
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(disabled) {
+	WaveformCache cache;
+	BOOST_CHECK(!cache.isEnabled());
+
+	cache.feed(makeRecord("A", 0, 10).get());
+
+	WaveformCache::Records records;
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(0), T(10)), records) == T(0));
+	BOOST_CHECK(records.empty());
+	BOOST_CHECK_EQUAL(cache.statistics().requests, 0);
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(overlap) {
+	WaveformCache cache;
+	cache.setBufferSize(Core::TimeSpan(3600, 0));
+
+	// Touching records fed out of order and a duplicate
+	cache.feed(makeRecord("A", 10, 10).get());
+	cache.feed(makeRecord("A", 0, 10).get());
+	cache.feed(makeRecord("A", 20, 10).get());
+	cache.feed(makeRecord("A", 10, 10).get());
+
+	// Window inside the buffered data
+	WaveformCache::Records records;
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(5), T(25)), records) == T(25));
+	BOOST_REQUIRE_EQUAL(records.size(), 3);
+	BOOST_CHECK(records[0]->startTime() == T(0));
+	BOOST_CHECK(records[1]->startTime() == T(10));
+	BOOST_CHECK(records[2]->startTime() == T(20));
+
+	// Window ending exactly at a record boundary does not include the
+	// next record
+	records.clear();
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(10), T(20)), records) == T(20));
+	BOOST_REQUIRE_EQUAL(records.size(), 1);
+	BOOST_CHECK(records[0]->startTime() == T(10));
+
+	// Window exceeding the buffered data is covered partly
+	records.clear();
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(15), T(40)), records) == T(30));
+	BOOST_CHECK_EQUAL(records.size(), 2);
+
+	// Window starting before the buffered data is not covered at all
+	records.clear();
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(-5), T(15)), records) == T(-5));
+	BOOST_CHECK(records.empty());
+
+	const WaveformCache::Statistics &stats = cache.statistics();
+	BOOST_CHECK_EQUAL(stats.requests, 4);
+	BOOST_CHECK_EQUAL(stats.hits, 2);
+	BOOST_CHECK_EQUAL(stats.partialHits, 1);
+	BOOST_CHECK_EQUAL(stats.misses, 1);
+	BOOST_CHECK_EQUAL(stats.recordsServed, 6);
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(gaps) {
+	WaveformCache cache;
+	cache.setBufferSize(Core::TimeSpan(3600, 0));
+
+	// 100 Hz records with jitter below half a sample are contiguous
+	cache.feed(makeRecord("A", 0, 1000, 100).get());
+	cache.feed(makeRecord("A", 10.004, 1000, 100).get());
+	// Gap of one sample
+	cache.feed(makeRecord("A", 20.014, 1000, 100).get());
+
+	WaveformCache::Records records;
+	Core::Time covered = cache.lookup("XX.A..HHZ", Core::TimeWindow(T(0), T(30)), records);
+	BOOST_CHECK(covered == T(20.004));
+	BOOST_CHECK_EQUAL(records.size(), 2);
+
+	// A record starting within the tolerance of a buffered one is
+	// considered a duplicate
+	cache.feed(makeRecord("A", 0.003, 1000, 100).get());
+	records.clear();
+	cache.lookup("XX.A..HHZ", Core::TimeWindow(T(0), T(30)), records);
+	BOOST_CHECK_EQUAL(records.size(), 2);
+
+	// The window following the gap is served from the third record
+	records.clear();
+	covered = cache.lookup("XX.A..HHZ", Core::TimeWindow(T(21), T(25)), records);
+	BOOST_CHECK(covered == T(25));
+	BOOST_REQUIRE_EQUAL(records.size(), 1);
+	BOOST_CHECK(records[0]->startTime() == T(20.014));
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(trim) {
+	WaveformCache cache;
+	cache.setBufferSize(Core::TimeSpan(20, 0));
+
+	for ( int i = 0; i < 6; ++i ) {
+		cache.feed(makeRecord("A", i * 10, 10).get());
+	}
+
+	// Records ending before 60 - 20 s are dropped
+	WaveformCache::Records records;
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(0), T(60)), records) == T(0));
+	BOOST_CHECK(records.empty());
+
+	records.clear();
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(30), T(60)), records) == T(60));
+	BOOST_CHECK_EQUAL(records.size(), 3);
+
+	// Shrinking the buffer trims all streams
+	cache.setBufferSize(Core::TimeSpan(10, 0));
+	records.clear();
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(40), T(60)), records) == T(60));
+	BOOST_CHECK_EQUAL(records.size(), 2);
+
+	// Disabling clears the cache
+	cache.setBufferSize(Core::TimeSpan(0, 0));
+	cache.setBufferSize(Core::TimeSpan(20, 0));
+	records.clear();
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(50), T(60)), records) == T(50));
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(eviction) {
+	WaveformCache cache;
+	cache.setBufferSize(Core::TimeSpan(3600, 0));
+	cache.setMaxStreams(2);
+
+	cache.feed(makeRecord("A", 0, 10).get());
+	cache.feed(makeRecord("B", 0, 10).get());
+
+	// Using A renders B the least recently used stream
+	WaveformCache::Records records;
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(0), T(10)), records) == T(10));
+
+	cache.feed(makeRecord("C", 0, 10).get());
+	BOOST_CHECK_EQUAL(cache.statistics().evictedStreams, 1);
+
+	records.clear();
+	BOOST_CHECK(cache.lookup("XX.B..HHZ", Core::TimeWindow(T(0), T(10)), records) == T(0));
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(0), T(10)), records) == T(10));
+	BOOST_CHECK(cache.lookup("XX.C..HHZ", Core::TimeWindow(T(0), T(10)), records) == T(10));
+
+	// Lowering the limit evicts the least recently used streams
+	cache.setMaxStreams(1);
+	BOOST_CHECK_EQUAL(cache.statistics().evictedStreams, 2);
+	records.clear();
+	BOOST_CHECK(cache.lookup("XX.A..HHZ", Core::TimeWindow(T(0), T(10)), records) == T(0));
+	BOOST_CHECK(cache.lookup("XX.C..HHZ", Core::TimeWindow(T(0), T(10)), records) == T(10));
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+BOOST_AUTO_TEST_SUITE_END()
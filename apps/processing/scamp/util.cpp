@@ -33,6 +33,7 @@
 */
 #include <seiscomp/core/system.h>
 
+#include <algorithm>
 #include <iomanip>
 
 
@@ -208,6 +209,35 @@ operator<<(std::ostream &os, const DataModel::Amplitude &amp) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::vector<Core::TimeWindow>
+mergeTimeWindows(std::vector<Core::TimeWindow> windows, double maxGap) {
+	std::vector<Core::TimeWindow> merged;
+
+	std::sort(windows.begin(), windows.end(),
+	          [](const Core::TimeWindow &lhs, const Core::TimeWindow &rhs) {
+		return lhs.startTime() < rhs.startTime();
+	});
+
+	for ( const auto &tw : windows ) {
+		if ( !merged.empty()
+		  && (double)(tw.startTime() - merged.back().endTime()) <= maxGap ) {
+			if ( tw.endTime() > merged.back().endTime() ) {
+				merged.back().setEndTime(tw.endTime());
+			}
+		}
+		else {
+			merged.push_back(tw);
+		}
+	}
+
+	return merged;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 }
 }
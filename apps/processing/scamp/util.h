@@ -18,9 +18,12 @@
 #define SEISCOMP_APPLICATIONS_AMPTOOL_UTIL_H__
 
 
+#include <seiscomp/core/timewindow.h>
 #include <seiscomp/datamodel/types.h>
 #include <seiscomp/datamodel/waveformstreamid.h>
 
+#include <vector>
+
 
 namespace Seiscomp {
 
@@ -58,6 +61,14 @@ setStreamComponent(const DataModel::WaveformStreamID &wfid, char comp);
 std::ostream &
 operator<<(std::ostream &os, const DataModel::Amplitude &ampl);
 
+/**
+ * @brief Merges overlapping time windows and windows separated by gaps
+ *        not larger than maxGap seconds.
+ * @return The merged time windows sorted by start time
+ */
+std::vector<Core::TimeWindow>
+mergeTimeWindows(std::vector<Core::TimeWindow> windows, double maxGap);
+
 
 }
 }
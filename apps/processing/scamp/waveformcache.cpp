@@ -0,0 +1,230 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+
+
+#include "waveformcache.h"
+
+#include <algorithm>
+#include <cmath>
+
+
+namespace Seiscomp {
+namespace Private {
+
+
+namespace {
+
+
+// Half a sample is tolerated as jitter between consecutive records
+double tolerance(const Record *rec) {
+	return rec->samplingFrequency() > 0 ? 0.5 / rec->samplingFrequency() : 0.0;
+}
+
+
+}
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformCache::setBufferSize(const Core::TimeSpan &bufferSize) {
+	_bufferSize = bufferSize;
+	if ( !isEnabled() ) {
+		clear();
+		return;
+	}
+
+	for ( auto &item : _buffers ) {
+		trim(item.second);
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformCache::setMaxStreams(size_t maxStreams) {
+	_maxStreams = maxStreams;
+	while ( _maxStreams && _buffers.size() > _maxStreams ) {
+		_buffers.erase(_lru.front());
+		_lru.pop_front();
+		++_stats.evictedStreams;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformCache::feed(Record *rec) {
+	if ( !isEnabled() || !rec ) {
+		return;
+	}
+
+	auto it = _buffers.find(rec->streamID());
+	if ( it == _buffers.end() ) {
+		it = _buffers.insert(Buffers::value_type(rec->streamID(), Buffer())).first;
+		it->second.lru = _lru.insert(_lru.end(), it->first);
+
+		// Evict the least recently used streams but never the new one
+		// which is located at the end of the list
+		while ( _maxStreams && _buffers.size() > _maxStreams ) {
+			_buffers.erase(_lru.front());
+			_lru.pop_front();
+			++_stats.evictedStreams;
+		}
+	}
+	else {
+		touch(it->second);
+	}
+
+	auto &records = it->second.records;
+	double tol = tolerance(rec);
+
+	// Keep the records sorted by start time. Usually records arrive in
+	// order and are appended.
+	auto pos = std::upper_bound(
+		records.begin(), records.end(), rec->startTime(),
+		[](const Core::Time &t, const RecordPtr &r) {
+			return t < r->startTime();
+		}
+	);
+
+	if ( pos != records.begin()
+	  && fabs((double)((*(pos-1))->startTime() - rec->startTime())) <= tol ) {
+		// Already buffered
+		return;
+	}
+
+	if ( pos != records.end()
+	  && fabs((double)((*pos)->startTime() - rec->startTime())) <= tol ) {
+		// Already buffered
+		return;
+	}
+
+	records.insert(pos, rec);
+	trim(it->second);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+Core::Time WaveformCache::lookup(const std::string &streamID,
+                                 const Core::TimeWindow &tw,
+                                 Records &records) {
+	Core::Time covered = tw.startTime();
+
+	if ( !isEnabled() ) {
+		return covered;
+	}
+
+	++_stats.requests;
+
+	auto it = _buffers.find(streamID);
+	if ( it == _buffers.end() ) {
+		++_stats.misses;
+		return covered;
+	}
+
+	touch(it->second);
+
+	size_t served = 0;
+	for ( const auto &rec : it->second.records ) {
+		if ( rec->endTime() <= covered ) {
+			// Before the window or completely overlapped by the previous
+			// record
+			continue;
+		}
+
+		if ( rec->startTime() >= tw.endTime() ) {
+			break;
+		}
+
+		if ( (double)(rec->startTime() - covered) > tolerance(rec.get()) ) {
+			// Gap
+			break;
+		}
+
+		records.push_back(rec);
+		covered = rec->endTime();
+		++served;
+
+		if ( covered >= tw.endTime() ) {
+			break;
+		}
+	}
+
+	_stats.recordsServed += served;
+
+	if ( covered >= tw.endTime() ) {
+		++_stats.hits;
+		return tw.endTime();
+	}
+
+	if ( served ) {
+		++_stats.partialHits;
+	}
+	else {
+		++_stats.misses;
+	}
+
+	return covered;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformCache::clear() {
+	_buffers.clear();
+	_lru.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformCache::touch(Buffer &buffer) {
+	_lru.splice(_lru.end(), _lru, buffer.lru);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void WaveformCache::trim(Buffer &buffer) {
+	if ( buffer.records.empty() ) {
+		return;
+	}
+
+	Core::Time minTime = buffer.records.back()->endTime() - _bufferSize;
+	while ( !buffer.records.empty() && buffer.records.front()->endTime() < minTime ) {
+		buffer.records.pop_front();
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+}
+}
@@ -0,0 +1,122 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+
+
+#ifndef SEISCOMP_APPLICATIONS_AMPTOOL_WAVEFORMCACHE_H__
+#define SEISCOMP_APPLICATIONS_AMPTOOL_WAVEFORMCACHE_H__
+
+
+#include <seiscomp/core/record.h>
+#include <seiscomp/core/timewindow.h>
+
+#include <deque>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+
+namespace Seiscomp {
+namespace Private {
+
+
+/**
+ * @brief The WaveformCache keeps the most recent records of each stream
+ *        in memory to serve subsequent requests for overlapping time
+ *        windows, e.g. of relocations of the same event.
+ *
+ * Each stream buffer holds records sorted by start time and covering
+ * at most bufferSize seconds before the end of the latest record. If the
+ * number of buffered streams exceeds maxStreams the least recently used
+ * stream is evicted.
+ */
+class WaveformCache {
+	public:
+		struct Statistics {
+			size_t requests{0};
+			size_t hits{0};
+			size_t partialHits{0};
+			size_t misses{0};
+			size_t recordsServed{0};
+			size_t evictedStreams{0};
+		};
+
+		typedef std::vector<RecordPtr> Records;
+
+
+	public:
+		WaveformCache() = default;
+
+
+	public:
+		//! Sets the time span to buffer per stream. A non-positive
+		//! value disables the cache.
+		void setBufferSize(const Core::TimeSpan &bufferSize);
+		const Core::TimeSpan &bufferSize() const { return _bufferSize; }
+
+		//! Sets the maximum number of streams to buffer, 0 means unlimited.
+		void setMaxStreams(size_t maxStreams);
+
+		bool isEnabled() const { return _bufferSize > Core::TimeSpan(0, 0); }
+
+		//! Adds a record to the buffer of its stream. Records already
+		//! buffered (same start time) are ignored.
+		void feed(Record *rec);
+
+		/**
+		 * @brief Collects the buffered records of a stream which cover the
+		 *        requested time window contiguously from its start time.
+		 * @param streamID The stream ID (NET.STA.LOC.CHA)
+		 * @param tw The requested time window
+		 * @param records The records overlapping the covered part
+		 * @return The end time of the covered part. If the window start
+		 *         is not covered then tw.startTime() is returned.
+		 */
+		Core::Time lookup(const std::string &streamID,
+		                  const Core::TimeWindow &tw, Records &records);
+
+		void clear();
+
+		const Statistics &statistics() const { return _stats; }
+
+
+	private:
+		typedef std::list<std::string> LRUList;
+
+		struct Buffer {
+			std::deque<RecordPtr> records;
+			LRUList::iterator     lru;
+		};
+
+		typedef std::map<std::string, Buffer> Buffers;
+
+		void touch(Buffer &buffer);
+		void trim(Buffer &buffer);
+
+
+	private:
+		Core::TimeSpan _bufferSize{0, 0};
+		size_t         _maxStreams{0};
+		Buffers        _buffers;
+		LRUList        _lru;
+		Statistics     _stats;
+};
+
+
+}
+}
+
+
+#endif
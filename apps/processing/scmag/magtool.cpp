@@ -32,11 +32,15 @@
 #include <seiscomp/utils/timer.h>
 
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <iostream>
 #include <limits>
 #include <map>
+#include <mutex>
 #include <set>
 #include <string>
+#include <thread>
 #include <vector>
 
 
@@ -163,6 +167,10 @@ bool hasHigherPriority(const DataModel::Amplitude *candidate,
 }
 
 
+// Maximum number of publicIDs per IN-list of a database query
+const size_t MAX_IDS_PER_QUERY = 200;
+
+
 //#define INVALID_MAG std::numeric_limits<double>::quiet_NaN()
 #define INVALID_MAG 0
 #define _T(name) db->convertColumnName(name)
@@ -320,6 +328,24 @@ void MagTool::setUpdateParent(bool update) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MagTool::setMissingObjectsRetryTimeout(const Core::TimeSpan &timeout) {
+	_missingObjectsRetryTimeout = timeout;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void MagTool::setWorkerThreads(int threads) {
+	_workerThreads = threads;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool MagTool::init(const MagnitudeTypes &mags, const Core::TimeSpan &expiry,
                    bool allowReprocessing, bool staticUpdate,
@@ -411,6 +437,20 @@ bool MagTool::init(const MagnitudeTypes &mags, const Core::TimeSpan &expiry,
 		logMagTypes += '\n';
 	}
 
+	// Magnitude processors are configured per station and are not
+	// reentrant. Each additional worker thread gets its own set.
+	_workerProcessors.clear();
+	for ( int i = 1; i < _workerThreads; ++i ) {
+		ProcessorList procs;
+		for ( const auto &type : _magTypes ) {
+			MagnitudeProcessorPtr proc = MagnitudeProcessorFactory::Create(type.c_str());
+			if ( proc ) {
+				procs.insert(ProcessorList::value_type(proc->amplitudeType(), proc));
+			}
+		}
+		_workerProcessors.push_back(procs);
+	}
+
 	SEISCOMP_INFO("Magnitude types to calculate:\n%s", logMagTypes.c_str());
 	SEISCOMP_INFO("Magnitude types - averaging methods:\n%s", logMagAverageTypes.c_str());
 	SEISCOMP_INFO("Summary magnitude enabled:                         %s",
@@ -686,8 +726,35 @@ bool MagTool::computeStationMagnitude(const DataModel::Amplitude *ampl,
                                       const DataModel::SensorLocation *loc,
                                       double distance, double depth,
                                       MagnitudeList &mags) {
+	StationMagnitudeJob job;
+	job.amplitude = ampl;
+	job.loc = loc;
+	job.params = fetchParams(ampl);
+	job.distance = distance;
+	job.depth = depth;
+
+	bool res = computeStationMagnitude(origin, job, _processors);
+	mags.insert(mags.end(), job.mags.begin(), job.mags.end());
+	return res;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MagTool::computeStationMagnitude(const DataModel::Origin *origin,
+                                      StationMagnitudeJob &job,
+                                      const ProcessorList &procs) {
+	const DataModel::Amplitude *ampl = job.amplitude;
+	const DataModel::SensorLocation *loc = job.loc;
+	Util::KeyValues *params = job.params;
+	double distance = job.distance;
+	double depth = job.depth;
+	MagnitudeList &mags = job.mags;
+
 	const string &atype = ampl->type();
-	auto itp = _processors.equal_range(atype);
+	auto itp = procs.equal_range(atype);
 
 	double period = 0;
 	try {
@@ -701,20 +768,27 @@ bool MagTool::computeStationMagnitude(const DataModel::Amplitude *ampl,
 	}
 	catch ( ... ) {}
 
-	Util::KeyValues *params = fetchParams(ampl);
-
 	for ( auto it = itp.first; it != itp.second; ++it ) {
-		Settings settings(
-			SCCoreApp->configModuleName(),
-			ampl->waveformID().networkCode(),
-			ampl->waveformID().stationCode(),
-			ampl->waveformID().locationCode(),
-			ampl->waveformID().channelCode(),
-			&SCCoreApp->configuration(),
-			params);
-
-		if ( !it->second->setup(settings) ) {
-			continue;
+		// Each thread owns its processor instances and computeMagnitude
+		// only works on the state of that instance. The setup reads the
+		// application configuration and may load data shared by all
+		// instances of a type, e.g. regionalization profiles, and is
+		// therefore serialized.
+		{
+			lock_guard<mutex> lock(_setupMutex);
+
+			Settings settings(
+				SCCoreApp->configModuleName(),
+				ampl->waveformID().networkCode(),
+				ampl->waveformID().stationCode(),
+				ampl->waveformID().locationCode(),
+				ampl->waveformID().channelCode(),
+				&SCCoreApp->configuration(),
+				params);
+
+			if ( !it->second->setup(settings) ) {
+				continue;
+			}
 		}
 
 		double mag;
@@ -799,6 +873,9 @@ bool MagTool::computeNetworkMagnitude(DataModel::Origin *origin, const std::stri
 	StaMagArray stationMagnitudesZeroWeight;
 	StaMagArray stationMagnitudes;
 
+	OrderStatistics &stats = _statistics[origin->publicID()][mtype];
+	stats.beginUpdate();
+
 	// retrieve from the origin all station magnitudes of specified type
 	for ( size_t i = 0, nmag = origin->stationMagnitudeCount(); i < nmag; ++i ) {
 		const DataModel::StationMagnitude *mag = origin->stationMagnitude(i);
@@ -817,14 +894,18 @@ bool MagTool::computeNetworkMagnitude(DataModel::Origin *origin, const std::stri
 
 		double m = mag->magnitude().value();
 		mv.push_back(m);
+		stats.set(mag->publicID(), m);
 	}
 
+	// Drop station magnitudes which were removed or did not pass the QC
+	stats.endUpdate();
+
 	int count = mv.size();
 
 	if ( count ) {
 		weights.resize(mv.size(), 1);
 
-		if ( !computeAverage(averageMethod, mv, weights, methodID, value, *stdev) )
+		if ( !computeAverage(averageMethod, stats, mv, weights, methodID, value, *stdev) )
 			return false;
 	}
 	else if ( stationMagnitudesZeroWeight.empty() )
@@ -1140,33 +1221,61 @@ bool MagTool::computeSummaryMagnitude(DataModel::Origin *origin) {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 int MagTool::retrieveMissingPicksAndArrivalsFromDB(const DataModel::Origin *origin) {
+	return retrieveMissingPicksAndArrivalsFromDB(vector<const DataModel::Origin*>{origin});
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+int MagTool::retrieveMissingPicksAndArrivalsFromDB(const vector<const DataModel::Origin*> &origins) {
 	int count = 0;
+	Core::Time now = Core::Time::UTC();
+
+	// Forget about picks which could not be found a while ago
+	for ( auto it = _unresolvedPicks.begin(); it != _unresolvedPicks.end(); ) {
+		if ( now - it->second >= _missingObjectsRetryTimeout ) {
+			it = _unresolvedPicks.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
 
 	// see if any picks are missing; if so, query DB
 	set<string> missingPicks;
-	for (int i = 0, arrivalCount = origin->arrivalCount(); i < arrivalCount; ++i ) {
-		const auto *arr = origin->arrival(i);
-		if ( getShortPhaseName(arr->phase().code()) != 'P' ) {
-			continue;
-		}
+	for ( auto origin : origins ) {
+		for (int i = 0, arrivalCount = origin->arrivalCount(); i < arrivalCount; ++i ) {
+			const auto *arr = origin->arrival(i);
+			if ( getShortPhaseName(arr->phase().code()) != 'P' ) {
+				continue;
+			}
 
-		const string &pickID = arr->pickID();
+			const string &pickID = arr->pickID();
 
-		// Is the pick already cached?
-		if ( DataModel::Pick::Find(pickID) ) {
-			continue;
-		}
+			// Is the pick already cached?
+			if ( DataModel::Pick::Find(pickID) ) {
+				continue;
+			}
 
-		// In the case of an uncached pick a amplitude pickID
-		// association is maybe available
-		auto it = _ampl.find(pickID);
-		if ( it != _ampl.end() ) {
-			SEISCOMP_WARNING("Pick '%s' is not cached but associated to amplitudes",
-			                 pickID.c_str());
-			continue;
-		}
+			// In the case of an uncached pick a amplitude pickID
+			// association is maybe available
+			auto it = _ampl.find(pickID);
+			if ( it != _ampl.end() ) {
+				SEISCOMP_WARNING("Pick '%s' is not cached but associated to amplitudes",
+				                 pickID.c_str());
+				continue;
+			}
 
-		missingPicks.insert(pickID);
+			// Has the pick been requested recently without success, e.g.
+			// because it belongs to an origin imported from another agency?
+			if ( _unresolvedPicks.find(pickID) != _unresolvedPicks.end() ) {
+				continue;
+			}
+
+			missingPicks.insert(pickID);
+		}
 	}
 
 	if ( missingPicks.empty() ) {
@@ -1178,50 +1287,82 @@ int MagTool::retrieveMissingPicksAndArrivalsFromDB(const DataModel::Origin *orig
 		return 0;
 	}
 
-	SEISCOMP_INFO("RETRIEVING %lu MISSING PICKS", (unsigned long)missingPicks.size());
+	SEISCOMP_INFO("RETRIEVING %lu MISSING PICKS OF %lu ORIGIN(S)",
+	              (unsigned long)missingPicks.size(), (unsigned long)origins.size());
 
-	DataModel::DatabaseIterator dbit;
-	DataModel::Object *object;
+	auto query = SCCoreApp->query();
+	auto db = query->driver();
 
-	dbit = SCCoreApp->query()->getPicks(origin->publicID());
-	for ( ; (object = *dbit); ++dbit ) {
-		DataModel::PickPtr pick = DataModel::Pick::Cast(object);
-		if ( ! pick) {
-			continue;
-		}
+	set<string> resolvedPicks;
+	vector<string> pickIDs(missingPicks.begin(), missingPicks.end());
 
-		const string &id = pick->publicID();
-		if ( missingPicks.find(id) == missingPicks.end() ) {
-			continue;
-		}
+	// Request picks and their amplitudes by sets of publicIDs instead of
+	// joining all picks and amplitudes per origin
+	for ( size_t first = 0; first < pickIDs.size(); first += MAX_IDS_PER_QUERY ) {
+		size_t last = std::min(first + MAX_IDS_PER_QUERY, pickIDs.size());
 
-		if ( !feed(pick.get()) ) {
-			continue;
+		string idList;
+		for ( size_t i = first; i < last; ++i ) {
+			if ( i > first ) {
+				idList += ",";
+			}
+			idList += "'" + query->toString(pickIDs[i]) + "'";
 		}
 
-		++count;
-	}
-	dbit.close();
+		string q = "select PPick." + _T("publicID") + ",Pick.* "
+		           "from Pick,PublicObject as PPick "
+		           "where Pick._oid=PPick._oid and PPick." + _T("publicID") +
+		           " in (" + idList + ")";
 
-	dbit = SCCoreApp->query()->getAmplitudesForOrigin(origin->publicID());
-	for ( ; (object = *dbit); ++dbit ) {
-		DataModel::AmplitudePtr ampl = DataModel::Amplitude::Cast(object);
-		if ( !ampl ) {
-			continue;
-		}
+		++_dbAccesses;
+		auto dbit = query->getObjectIterator(q, DataModel::Pick::TypeInfo());
+		for ( ; *dbit; ++dbit ) {
+			DataModel::PickPtr pick = DataModel::Pick::Cast(*dbit);
+			if ( !pick ) {
+				continue;
+			}
 
-		const string &id = ampl->pickID();
-		if ( missingPicks.find(id) == missingPicks.end() ) {
-			continue;
+			resolvedPicks.insert(pick->publicID());
+
+			if ( !feed(pick.get()) ) {
+				continue;
+			}
+
+			++count;
 		}
+		dbit.close();
 
-		if ( !_feed(ampl.get(), false) ) {
-			continue;
+		q = "select PAmplitude." + _T("publicID") + ",Amplitude.* "
+		    "from Amplitude,PublicObject as PAmplitude "
+		    "where Amplitude._oid=PAmplitude._oid and Amplitude." + _T("pickID") +
+		    " in (" + idList + ")";
+
+		++_dbAccesses;
+		dbit = query->getObjectIterator(q, DataModel::Amplitude::TypeInfo());
+		for ( ; *dbit; ++dbit ) {
+			DataModel::AmplitudePtr ampl = DataModel::Amplitude::Cast(*dbit);
+			if ( !ampl ) {
+				continue;
+			}
+
+			if ( missingPicks.find(ampl->pickID()) == missingPicks.end() ) {
+				continue;
+			}
+
+			if ( !_feed(ampl.get(), false) ) {
+				continue;
+			}
+
+			++count;
 		}
+		dbit.close();
+	}
 
-		++count;
+	for ( const auto &pickID : missingPicks ) {
+		if ( resolvedPicks.find(pickID) == resolvedPicks.end() ) {
+			_unresolvedPicks[pickID] = now;
+		}
 	}
-	dbit.close();
 
 	SEISCOMP_INFO("RETRIEVED  %d MISSING OBJECTS", count);
 
@@ -1401,6 +1542,46 @@ bool MagTool::computeAverage(AverageDescription &avg,
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MagTool::computeAverage(AverageDescription &avg,
+                             const OrderStatistics &stats,
+                             const std::vector<double> &values,
+                             std::vector<double> &weights,
+                             std::string &methodID, double &value, double &stdev) {
+	// Trimmed averages assign weights by rank to each single value which
+	// are computed by the common statistics functions to stay consistent
+	// with other modules. Mean and median do not change the weights.
+	switch( avg.type ) {
+		case Default:
+			if ( stats.count() > 3 ) {
+				break;
+			}
+			// fall through
+		case Mean:
+			methodID = "mean";
+			value = stats.mean();
+			stdev = stats.stdev(value);
+			return true;
+
+		case Median:
+			methodID = "median";
+			value = stats.median();
+			if ( stats.count() > 1 ) {
+				stdev = stats.stdev(value);
+			}
+			return true;
+
+		default:
+			break;
+	}
+
+	return computeAverage(avg, values, weights, methodID, value, stdev);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool MagTool::considerUnusedArrivals(const std::string &type) {
 	if ( auto cit = _considerUnusedArrivals.find(type);
@@ -1436,6 +1617,25 @@ bool MagTool::processOrigin(DataModel::Origin *origin) {
 		return processOriginUpdateOnly(origin);
 	}
 
+	StationMagnitudeJobs jobs;
+	if ( !collectStationMagnitudeJobs(origin, jobs) ) {
+		return false;
+	}
+
+	for ( auto &job : jobs ) {
+		computeStationMagnitude(origin, job, _processors);
+	}
+
+	return applyStationMagnitudeJobs(origin, jobs);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MagTool::collectStationMagnitudeJobs(DataModel::Origin *origin,
+                                          StationMagnitudeJobs &jobs) {
 	double depth;
 
 	try { depth = origin->depth().value(); }
@@ -1445,7 +1645,6 @@ bool MagTool::processOrigin(DataModel::Origin *origin) {
 		return false;
 	}
 
-	set<string> magTypes;
 	struct PickStreamEntry {
 		DataModel::PickCPtr        pick;
 		DataModel::SensorLocation *loc;
@@ -1588,25 +1787,41 @@ bool MagTool::processOrigin(DataModel::Origin *origin) {
 			}
 		}
 
-		// Compute magnitudes of used amplitudes
+		// Queue magnitude computation of used amplitudes
 		for ( auto &amp_it : usedAmplitudes ) {
-			const DataModel::Amplitude *ampl  = amp_it.second;
-			const string &aid   = ampl->publicID();
+			StationMagnitudeJob job;
+			job.amplitude = amp_it.second;
+			job.loc = loc;
+			job.params = fetchParams(job.amplitude);
+			job.distance = distance;
+			job.depth = depth;
+			jobs.push_back(job);
+		}
+	}
 
-			MagnitudeList mags;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-			if ( !computeStationMagnitude(ampl, origin, loc, distance, depth, mags) ) {
-				continue;
-			}
 
-			for ( const auto &entry : mags ) {
-				StaMagPtr stationMagnitude = getStationMagnitude(origin, ampl->waveformID(), entry.proc->type(), entry.value, _allowReprocessing);
-				if ( stationMagnitude ) {
-					entry.proc->finalizeMagnitude(stationMagnitude.get());
-					stationMagnitude->setAmplitudeID(aid);
-					stationMagnitude->setPassedQC(entry.passedQC);
-					magTypes.insert(entry.proc->type());
-				}
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MagTool::applyStationMagnitudeJobs(DataModel::Origin *origin,
+                                        const StationMagnitudeJobs &jobs) {
+	set<string> magTypes;
+
+	for ( const auto &job : jobs ) {
+		const DataModel::Amplitude *ampl = job.amplitude;
+		const string &aid = ampl->publicID();
+
+		for ( const auto &entry : job.mags ) {
+			StaMagPtr stationMagnitude = getStationMagnitude(origin, ampl->waveformID(), entry.proc->type(), entry.value, _allowReprocessing);
+			if ( stationMagnitude ) {
+				entry.proc->finalizeMagnitude(stationMagnitude.get());
+				stationMagnitude->setAmplitudeID(aid);
+				stationMagnitude->setPassedQC(entry.passedQC);
+				magTypes.insert(entry.proc->type());
 			}
 		}
 	}
@@ -2300,11 +2515,129 @@ bool MagTool::feed(DataModel::Origin *origin) {
 	// The Origin may be incomplete and if that is the case, we
 	// must fetch the missing attributes from the DB before any
 	// further processing.
+	origin = prepareOrigin(origin);
+	if ( !origin ) {
+		return false;
+	}
+
+	return processOrigin(origin);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool MagTool::feed(const OriginBatch &batch) {
+	vector<DataModel::Origin*> origins;
+	set<DataModel::Origin*> seen;
+
+	// Everything which touches the caches, the bindings or the database
+	// is done serially.
+	for ( const auto &item : batch ) {
+		DataModel::Origin *origin = prepareOrigin(item.get());
+		if ( !origin ) {
+			continue;
+		}
+
+		// Updates of the same origin within one batch refer to the same
+		// registered instance which is processed once in its current state
+		if ( !seen.insert(origin).second ) {
+			SEISCOMP_DEBUG("Origin %s already scheduled in this batch",
+			               origin->publicID().c_str());
+			continue;
+		}
+
+		SEISCOMP_INFO("working on origin %s", origin->publicID().c_str());
+		origins.push_back(origin);
+	}
+
+	// Fetch missing objects of all origins at once
+	retrieveMissingPicksAndArrivalsFromDB(
+		vector<const DataModel::Origin*>(origins.begin(), origins.end())
+	);
+
+	if ( _staticUpdate ) {
+		bool res = false;
+		for ( auto origin : origins ) {
+			if ( processOriginUpdateOnly(origin) ) {
+				res = true;
+			}
+		}
+
+		return res;
+	}
+
+	struct Entry {
+		DataModel::Origin    *origin;
+		StationMagnitudeJobs  jobs;
+	};
+
+	vector<Entry> entries;
+
+	for ( auto origin : origins ) {
+		Entry entry;
+		entry.origin = origin;
+		if ( !collectStationMagnitudeJobs(origin, entry.jobs) ) {
+			continue;
+		}
+
+		entries.push_back(entry);
+	}
+
+	using Task = pair<const DataModel::Origin*, StationMagnitudeJob*>;
+	vector<Task> tasks;
+	for ( auto &entry : entries ) {
+		for ( auto &job : entry.jobs ) {
+			tasks.push_back(Task(entry.origin, &job));
+		}
+	}
+
+	std::atomic<size_t> nextTask{0};
+	auto work = [this, &tasks, &nextTask](const ProcessorList &procs) {
+		for ( size_t i = nextTask++; i < tasks.size(); i = nextTask++ ) {
+			computeStationMagnitude(tasks[i].first, *tasks[i].second, procs);
+		}
+	};
+
+	size_t threadCount = std::min(_workerProcessors.size(), tasks.size());
+	vector<thread> workers;
+	for ( size_t i = 0; i < threadCount; ++i ) {
+		workers.emplace_back(work, std::cref(_workerProcessors[i]));
+	}
+
+	work(_processors);
+
+	for ( auto &worker : workers ) {
+		worker.join();
+	}
+
+	SEISCOMP_DEBUG("Computed %lu station magnitude jobs of %lu origins with %lu threads",
+	               static_cast<unsigned long>(tasks.size()),
+	               static_cast<unsigned long>(entries.size()),
+	               static_cast<unsigned long>(threadCount + 1));
+
+	// Create and update objects in the order of the batch
+	bool res = false;
+	for ( auto &entry : entries ) {
+		if ( applyStationMagnitudeJobs(entry.origin, entry.jobs) ) {
+			res = true;
+		}
+	}
+
+	return res;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+DataModel::Origin *MagTool::prepareOrigin(DataModel::Origin *origin) {
 	if ( SCCoreApp->isAgencyIDBlocked(objectAgencyID(origin)) ) {
 		SEISCOMP_DEBUG("Skipping origin '%s': agencyID '%s' is blocked",
 		               origin->publicID().c_str(), objectAgencyID(origin).c_str());
-		return false;
+		return nullptr;
 	}
 
 	DataModel::Origin *registered = DataModel::Origin::Find(origin->publicID());
@@ -2312,12 +2645,12 @@ bool MagTool::feed(DataModel::Origin *origin) {
 		// We already read the origin from the database while processing
 		// historical origins
 
-		return processOrigin(registered);
+		return registered;
 	}
 
 	if ( status(origin) == DataModel::REJECTED ) {
 		SEISCOMP_INFO("Ignoring rejected origin %s", origin->publicID().c_str());
-		return false;
+		return nullptr;
 	}
 
 	// If this is an incomplete Origin without arrivals,
@@ -2331,7 +2664,7 @@ bool MagTool::feed(DataModel::Origin *origin) {
 	// we have to ignore it
 	if (origin->arrivalCount() == 0) {
 		SEISCOMP_INFO("Ignoring incomplete origin %s", origin->publicID().c_str());
-		return false;
+		return nullptr;
 	}
 
 	// Load missing magnitudes
@@ -2349,7 +2682,7 @@ bool MagTool::feed(DataModel::Origin *origin) {
 	SEISCOMP_DEBUG("Inserted origin %s, cache size = %lu",
 	               origin->publicID().c_str(), (unsigned long)_objectCache.size());
 
-	return processOrigin(origin);
+	return origin;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -2390,6 +2723,7 @@ void MagTool::publicObjectRemoved(DataModel::PublicObject* po) {
 	DataModel::Notifier::Disable();
 
 	_ampl.erase(po->publicID());
+	_statistics.erase(po->publicID());
 
 	// Remove all pick - origin associations when a pick leaves the cache
 	// to avoid incomplete cache
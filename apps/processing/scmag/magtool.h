@@ -19,7 +19,9 @@
 
 #include <string>
 #include <map>
+#include <mutex>
 #include <set>
+#include <vector>
 
 #include <seiscomp/datamodel/publicobjectcache.h>
 #include <seiscomp/datamodel/eventparameters.h>
@@ -33,6 +35,8 @@
 #include <seiscomp/processing/magnitudeprocessor.h>
 #include <seiscomp/client/application.h>
 
+#include "orderstatistics.h"
+
 namespace Seiscomp {
 namespace Magnitudes {
 
@@ -107,6 +111,17 @@ class MagTool {
 		void setMinimumArrivalWeight(double);
 		void setUpdateParent(bool update);
 
+		// Picks which are not found in the database are not requested
+		// again before this timeout expired.
+		void setMissingObjectsRetryTimeout(const Core::TimeSpan &timeout);
+
+		// Sets the number of threads computing station magnitudes in
+		// batch processing of origins, see feed(const OriginBatch&).
+		// The threads are started per batch and are meant for offline
+		// processing of many origins at once.
+		// This must be called before init.
+		void setWorkerThreads(int threads);
+
 		bool init(const MagnitudeTypes &mags, const Core::TimeSpan& expiry,
 		          bool allowReprocessing, bool staticUpdate, bool keepWeights, double warning);
 		void done();
@@ -115,6 +130,14 @@ class MagTool {
 		bool feed(DataModel::Pick *);
 		bool feed(DataModel::Amplitude *, bool update, bool remove);
 
+		// Processes a batch of new or updated origins. Station magnitudes
+		// of all origins are computed concurrently by the configured
+		// worker threads. The resulting objects are created and updated
+		// in the order of the batch afterwards which renders the same
+		// notifier sequence as feeding the origins one by one.
+		typedef std::vector<DataModel::OriginPtr> OriginBatch;
+		bool feed(const OriginBatch &);
+
 		void remove(DataModel::PublicObject *po);
 
 
@@ -131,6 +154,22 @@ class MagTool {
 		};
 
 		typedef std::vector<MagnitudeEntry> MagnitudeList;
+		typedef std::multimap<std::string, Processing::MagnitudeProcessorPtr> ProcessorList;
+
+		// Input and output of a station magnitude computation of one
+		// amplitude. It carries everything which requires access to
+		// caches or the database so that it can be computed in any
+		// thread.
+		struct StationMagnitudeJob {
+			const DataModel::Amplitude      *amplitude{nullptr};
+			const DataModel::SensorLocation *loc{nullptr};
+			Util::KeyValues                 *params{nullptr};
+			double                           distance{0};
+			double                           depth{0};
+			MagnitudeList                    mags;
+		};
+
+		typedef std::vector<StationMagnitudeJob> StationMagnitudeJobs;
 
 		void publicObjectRemoved(DataModel::PublicObject*);
 
@@ -159,6 +198,12 @@ class MagTool {
 		                             const DataModel::SensorLocation *,
 		                              double, double, MagnitudeList&);
 
+		// Computes the station magnitudes of a job with the given
+		// processor set. It does not access any cache or the database.
+		bool computeStationMagnitude(const DataModel::Origin*,
+		                             StationMagnitudeJob &job,
+		                             const ProcessorList &procs);
+
 		bool computeNetworkMagnitude(DataModel::Origin*, const std::string&, DataModel::MagnitudePtr);
 		bool computeSummaryMagnitude(DataModel::Origin*);
 
@@ -168,12 +213,31 @@ class MagTool {
 		// number of retrieved objects.
 		int retrieveMissingPicksAndArrivalsFromDB(const DataModel::Origin*);
 
+		// Same as above for a list of origins. All missing objects are
+		// retrieved with set based queries.
+		int retrieveMissingPicksAndArrivalsFromDB(const std::vector<const DataModel::Origin*> &);
+
 		//! process new or updated Origin
 		// if something changed, returns true, false otherwise
 		bool processOrigin(DataModel::Origin*);
 
 		bool processOriginUpdateOnly(DataModel::Origin*);
 
+		// Checks a new or updated origin, completes it from the database
+		// if required and returns the instance to be processed. Returns
+		// nullptr if the origin must not be processed.
+		DataModel::Origin *prepareOrigin(DataModel::Origin*);
+
+		// Collects the amplitudes to compute station magnitudes for
+		// along with their meta data.
+		bool collectStationMagnitudeJobs(DataModel::Origin*,
+		                                 StationMagnitudeJobs &jobs);
+
+		// Creates or updates the station magnitudes of computed jobs
+		// and updates all network magnitudes and the summary magnitude.
+		bool applyStationMagnitudeJobs(DataModel::Origin*,
+		                               const StationMagnitudeJobs &jobs);
+
 		//! process new or updated Pick
 		// if something changed, returns true, false otherwise
 		bool processPick(DataModel::Pick*) { return false; }
@@ -194,11 +258,18 @@ class MagTool {
 		                    std::vector<double> &weights,
 		                    std::string &method, double &value, double &stdev);
 
+		// Same as above but takes mean and median based values from the
+		// incrementally maintained order statistics of the values.
+		bool computeAverage(AverageDescription &avg,
+		                    const OrderStatistics &stats,
+		                    const std::vector<double> &values,
+		                    std::vector<double> &weights,
+		                    std::string &method, double &value, double &stdev);
+
 		bool considerUnusedArrivals(const std::string &type);
 
 	private:
 		using MagnitudeTypeList = Processing::MagnitudeProcessorFactory::ServiceNames;
-		using ProcessorList = std::multimap<std::string, Processing::MagnitudeProcessorPtr>;
 		using TypeList = std::set<std::string>;
 		using ParameterMap = std::map<std::string, Util::KeyValuesPtr>;
 		using ConsiderUnusedArrivals = std::map<std::string, bool>;
@@ -230,6 +301,21 @@ class MagTool {
 
 		ConsiderUnusedArrivals _considerUnusedArrivals;
 
+		// Order statistics of the station magnitudes contributing to a
+		// network magnitude per origin and magnitude type
+		using TypeStatistics = std::map<std::string, OrderStatistics>;
+		std::map<std::string, TypeStatistics> _statistics;
+
+		// Picks not found in the database and the time of the last request
+		std::map<std::string, Core::Time> _unresolvedPicks;
+		Core::TimeSpan         _missingObjectsRetryTimeout{60.0};
+
+		// Processor sets of additional worker threads. The calling thread
+		// uses _processors.
+		int                        _workerThreads{1};
+		std::vector<ProcessorList> _workerProcessors;
+		std::mutex                 _setupMutex;
+
 	public:
 		Client::Application::ObjectLog *inputPickLog;
 		Client::Application::ObjectLog *inputAmpLog;
@@ -0,0 +1,251 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+#include "orderstatistics.h"
+
+#include <cmath>
+#include <iterator>
+
+
+namespace Seiscomp {
+namespace Magnitudes {
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void OrderStatistics::beginUpdate() {
+	++_generation;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void OrderStatistics::set(const std::string &key, double value) {
+	auto it = _samples.find(key);
+	if ( it == _samples.end() ) {
+		_samples[key] = Sample{value, _generation};
+		insert(value);
+		return;
+	}
+
+	it->second.generation = _generation;
+
+	if ( it->second.value != value ) {
+		erase(it->second.value);
+		it->second.value = value;
+		insert(value);
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void OrderStatistics::endUpdate() {
+	for ( auto it = _samples.begin(); it != _samples.end(); ) {
+		if ( it->second.generation != _generation ) {
+			erase(it->second.value);
+			it = _samples.erase(it);
+		}
+		else {
+			++it;
+		}
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void OrderStatistics::remove(const std::string &key) {
+	auto it = _samples.find(key);
+	if ( it == _samples.end() ) {
+		return;
+	}
+
+	erase(it->second.value);
+	_samples.erase(it);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void OrderStatistics::clear() {
+	_samples.clear();
+	_lower.clear();
+	_upper.clear();
+	_sum = _sumOfSquares = 0;
+	_changes = 0;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+size_t OrderStatistics::count() const {
+	return _samples.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double OrderStatistics::mean() const {
+	if ( _samples.empty() ) {
+		return 0;
+	}
+
+	return _sum / _samples.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double OrderStatistics::median() const {
+	if ( _lower.empty() ) {
+		return 0;
+	}
+
+	if ( _lower.size() > _upper.size() ) {
+		return *_lower.rbegin();
+	}
+
+	return (*_lower.rbegin() + *_upper.begin()) * 0.5;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double OrderStatistics::stdev(double center) const {
+	size_t n = _samples.size();
+	if ( n < 2 ) {
+		return 0;
+	}
+
+	// sum((x-c)^2) = sum(x^2) - 2c*sum(x) + n*c^2
+	double var = (_sumOfSquares - 2 * center * _sum + n * center * center) / (n - 1);
+	// Guard against rounding errors
+	if ( var <= 0 ) {
+		return 0;
+	}
+
+	return sqrt(var);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void OrderStatistics::insert(double value) {
+	if ( _lower.empty() || value <= *_lower.rbegin() ) {
+		_lower.insert(value);
+	}
+	else {
+		_upper.insert(value);
+	}
+
+	_sum += value;
+	_sumOfSquares += value * value;
+
+	rebalance();
+
+	if ( ++_changes > _samples.size() ) {
+		resum();
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void OrderStatistics::erase(double value) {
+	auto it = _lower.find(value);
+	if ( it != _lower.end() ) {
+		_lower.erase(it);
+	}
+	else {
+		it = _upper.find(value);
+		if ( it == _upper.end() ) {
+			return;
+		}
+
+		_upper.erase(it);
+	}
+
+	_sum -= value;
+	_sumOfSquares -= value * value;
+
+	rebalance();
+
+	if ( ++_changes > _samples.size() ) {
+		resum();
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void OrderStatistics::rebalance() {
+	if ( _lower.size() > _upper.size() + 1 ) {
+		auto it = std::prev(_lower.end());
+		_upper.insert(*it);
+		_lower.erase(it);
+	}
+	else if ( _upper.size() > _lower.size() ) {
+		auto it = _upper.begin();
+		_lower.insert(*it);
+		_upper.erase(it);
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void OrderStatistics::resum() {
+	_sum = _sumOfSquares = 0;
+
+	for ( double value : _lower ) {
+		_sum += value;
+		_sumOfSquares += value * value;
+	}
+
+	for ( double value : _upper ) {
+		_sum += value;
+		_sumOfSquares += value * value;
+	}
+
+	_changes = 0;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+}
+}
@@ -0,0 +1,93 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+
+
+#ifndef SEISCOMP_MAGTOOL_ORDERSTATISTICS_H
+#define SEISCOMP_MAGTOOL_ORDERSTATISTICS_H
+
+
+#include <set>
+#include <string>
+#include <unordered_map>
+
+
+namespace Seiscomp {
+namespace Magnitudes {
+
+
+/**
+ * @brief Keeps the values of a set of keyed samples, e.g. station
+ * magnitudes, in order along with their running sums. Adding, updating
+ * or removing a sample costs O(log n), the count, mean, median and
+ * the standard deviation are available in O(1).
+ *
+ * The samples are synchronized with a sequence of set calls enclosed in
+ * beginUpdate and endUpdate. Samples which have not been set during an
+ * update are removed. Samples can also be added, updated and removed
+ * individually with set and remove outside of an update.
+ *
+ * The running sums are recomputed from the ordered values after as many
+ * changes as samples are held to bound accumulated rounding errors.
+ */
+class OrderStatistics {
+	public:
+		void beginUpdate();
+		void set(const std::string &key, double value);
+		void endUpdate();
+
+		void remove(const std::string &key);
+
+		void clear();
+
+		size_t count() const;
+		double mean() const;
+		double median() const;
+
+		/**
+		 * @brief Returns the sample standard deviation of all values
+		 * w.r.t. a center value, e.g. the mean or the median. It returns
+		 * 0 if less than two samples are available.
+		 */
+		double stdev(double center) const;
+
+	private:
+		void insert(double value);
+		void erase(double value);
+		void rebalance();
+		void resum();
+
+	private:
+		struct Sample {
+			double       value;
+			unsigned int generation;
+		};
+
+		std::unordered_map<std::string, Sample> _samples;
+		// The lower half holds as many values as the upper half or
+		// one more
+		std::multiset<double> _lower;
+		std::multiset<double> _upper;
+		double                _sum{0};
+		double                _sumOfSquares{0};
+		unsigned int          _generation{0};
+		size_t                _changes{0};
+};
+
+
+}
+}
+
+
+#endif
@@ -93,6 +93,11 @@ class MagToolApp : public Seiscomp::Client::Application {
 			                        "Output a warning for standard deviations of "
 			                        "network magnitudes exceeding the provided value.",
 			                        &_warningLevel);
+			commandline().addOption("Process", "threads",
+			                        "Number of threads computing station "
+			                        "magnitudes of the origins read from the "
+			                        "file given with --ep.",
+			                        &_threads, true);
 			commandline().addGroup("Reprocess");
 			commandline().addOption("Reprocess", "static",
 			                        "Do not create new station or new network "
@@ -223,6 +228,7 @@ class MagToolApp : public Seiscomp::Client::Application {
 				return false;
 
 			try { _interval = configGetInt("connection.sendInterval"); } catch ( ... ) {}
+			try { _threads = configGetInt("threads"); } catch ( ... ) {}
 			try {
 				std::vector<std::string> magTypes = configGetStrings("magnitudes");
 				_magTypes.clear();
@@ -397,6 +403,11 @@ class MagToolApp : public Seiscomp::Client::Application {
 				_magtool.setSummaryMagnitudeCoefficients(coefficients);
 			}
 
+			try {
+				_magtool.setMissingObjectsRetryTimeout(configGetDouble("missingPickRetryTimeout"));
+			}
+			catch ( ... ) {}
+
 			try {
 				_magtool.setUpdateParent(configGetBool("updateParent"));
 			}
@@ -419,6 +430,20 @@ class MagToolApp : public Seiscomp::Client::Application {
 
 			_expiry = _fExpiry * 3600.;
 
+			if ( _threads < 1 ) {
+				SEISCOMP_ERROR("Invalid number of threads: %d", _threads);
+				return false;
+			}
+
+			// Origins received by messaging are processed in small batches
+			// where starting threads does not pay off
+			if ( _epFile.empty() && _threads > 1 ) {
+				SEISCOMP_WARNING("Ignoring %d threads, multiple threads are "
+				                 "only used with --ep", _threads);
+				_threads = 1;
+			}
+
+			_magtool.setWorkerThreads(_threads);
 			_magtool.init(_magTypes, _expiry,
 			              commandline().hasOption("reprocess"),
 			              commandline().hasOption("static"),
@@ -484,12 +509,15 @@ class MagToolApp : public Seiscomp::Client::Application {
 					_magtool.feed(ep->amplitude(i), false, false);
 				}
 
+				MagTool::OriginBatch origins;
 				for ( size_t i = 0; i < ep->originCount(); ++i ) {
 					OriginPtr org = ep->origin(i);
 					SEISCOMP_INFO("Processing origin %s", org->publicID().c_str());
-					_magtool.feed(org.get());
+					origins.push_back(org);
 				}
 
+				_magtool.feed(origins);
+
 				ar.create("-");
 				ar.setFormattedOutput(_formatted);
 				ar << ep;
@@ -524,6 +552,9 @@ class MagToolApp : public Seiscomp::Client::Application {
 			// will be called
 			Application::handleMessage(msg);
 
+			// Process all origins of this message together
+			flushOrigins();
+
 			// All message handling is done so lets continue
 			if ( !_interval || _sendImmediately ) {
 				NotifierMessagePtr xmsg = Notifier::GetMessage();
@@ -537,7 +568,40 @@ class MagToolApp : public Seiscomp::Client::Application {
 			_sendImmediately = false;
 		}
 
+		void flushOrigins() {
+			if ( _pendingOrigins.empty() ) {
+				return;
+			}
+
+			Notifier::Enable();
+			_magtool.feed(_pendingOrigins);
+			Notifier::Disable();
+			_pendingOrigins.clear();
+		}
+
+		void feedOrigin(Origin *origin) {
+			// When an origins arrives the initial magnitudes
+			// have to be sent out immediately
+			_sendImmediately = true;
+
+			// Defer processing until the end of the message or until
+			// another object requires the origin to be processed. All
+			// origins of a message share the database requests for missing
+			// objects.
+			_pendingOrigins.push_back(origin);
+		}
+
 		void addObject(const std::string &parentID, DataModel::Object *object) {
+			Origin *origin = Origin::Cast(object);
+			if ( origin != NULL ) {
+				logObject(_magtool.inputOrgLog, Time::UTC());
+				feedOrigin(origin);
+				return;
+			}
+
+			// Keep the processing order of the received objects
+			flushOrigins();
+
 			Pick *pick = Pick::Cast(object);
 			if ( pick != NULL ) {
 				logObject(_magtool.inputPickLog, Time::UTC());
@@ -553,21 +617,18 @@ class MagToolApp : public Seiscomp::Client::Application {
 				Notifier::Disable();
 				return;
 			}
+		}
 
+		void updateObject(const std::string &, DataModel::Object *object) {
 			Origin *origin = Origin::Cast(object);
 			if ( origin != NULL ) {
 				logObject(_magtool.inputOrgLog, Time::UTC());
-				// When an origins arrives the initial magnitudes
-				// have to be sent out immediately
-				_sendImmediately = true;
-				Notifier::Enable();
-				_magtool.feed(origin);
-				Notifier::Disable();
+				feedOrigin(origin);
 				return;
 			}
-		}
 
-		void updateObject(const std::string &, DataModel::Object *object) {
+			flushOrigins();
+
 			Amplitude *ampl = Amplitude::Cast(object);
 			if ( ampl != NULL ) {
 				logObject(_magtool.inputAmpLog, Time::UTC());
@@ -576,21 +637,11 @@ class MagToolApp : public Seiscomp::Client::Application {
 				Notifier::Disable();
 				return;
 			}
-
-			Origin *origin = Origin::Cast(object);
-			if ( origin != NULL ) {
-				logObject(_magtool.inputOrgLog, Time::UTC());
-				// When an origins arrives the initial magnitudes
-				// have to be sent out immediately
-				_sendImmediately = true;
-				Notifier::Enable();
-				_magtool.feed(origin);
-				Notifier::Disable();
-				return;
-			}
 		}
 
 		void removeObject(const std::string &, DataModel::Object *object) {
+			flushOrigins();
+
 			Amplitude *ampl = Amplitude::Cast(object);
 			if ( ampl ) {
 				_magtool.feed(ampl, false, true);
@@ -616,6 +667,9 @@ class MagToolApp : public Seiscomp::Client::Application {
 		std::string _epFile;
 		bool        _formatted{false};
 		double      _warningLevel;
+		int         _threads{1};
+
+		MagTool::OriginBatch _pendingOrigins;
 };
 
 
@@ -0,0 +1,179 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_TEST_MODULE scmag
+
+#include "../orderstatistics.h"
+
+#include <seiscomp/core/strings.h>
+#include <seiscomp/math/mean.h>
+#include <seiscomp/unittest/unittests.h>
+
+#include <boost/test/included/unit_test.hpp>
+
+#include <cmath>
+#include <map>
+#include <random>
+#include <vector>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::Magnitudes;
+
+
+namespace {
+
+
+// Checks the order statistics against values computed from scratch as
+// done by MagTool::computeAverage
+void check(const OrderStatistics &stats, const map<string, double> &samples) {
+	vector<double> values;
+	for ( const auto &item : samples ) {
+		values.push_back(item.second);
+	}
+
+	BOOST_REQUIRE_EQUAL(stats.count(), values.size());
+	if ( values.empty() ) {
+		return;
+	}
+
+	double mean = 0;
+	for ( double v : values ) {
+		mean += v;
+	}
+	mean /= values.size();
+
+	double median = Math::Statistics::median(values);
+
+	double meanStdev = 0, medianStdev = 0;
+	if ( values.size() > 1 ) {
+		for ( double v : values ) {
+			meanStdev += (v - mean) * (v - mean);
+			medianStdev += (v - median) * (v - median);
+		}
+		meanStdev = sqrt(meanStdev / (values.size() - 1));
+		medianStdev = sqrt(medianStdev / (values.size() - 1));
+	}
+
+	BOOST_CHECK_SMALL(stats.mean() - mean, 1E-9);
+	BOOST_CHECK_SMALL(stats.median() - median, 1E-12);
+	BOOST_CHECK_SMALL(stats.stdev(mean) - meanStdev, 1E-6);
+	BOOST_CHECK_SMALL(stats.stdev(median) - medianStdev, 1E-6);
+}
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(seiscomp_main_scmag_orderstatistics)
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(empty) {
+	OrderStatistics stats;
+	BOOST_CHECK_EQUAL(stats.count(), 0);
+	BOOST_CHECK_EQUAL(stats.mean(), 0);
+	BOOST_CHECK_EQUAL(stats.median(), 0);
+	BOOST_CHECK_EQUAL(stats.stdev(0), 0);
+
+	stats.set("a", 4.2);
+	BOOST_CHECK_EQUAL(stats.count(), 1);
+	BOOST_CHECK_EQUAL(stats.median(), 4.2);
+	BOOST_CHECK_EQUAL(stats.stdev(4.2), 0);
+
+	stats.remove("a");
+	stats.remove("b");
+	BOOST_CHECK_EQUAL(stats.count(), 0);
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(update) {
+	OrderStatistics stats;
+	map<string, double> samples{{"a", 3.0}, {"b", 1.0}, {"c", 2.0}, {"d", 2.0}};
+
+	stats.beginUpdate();
+	for ( const auto &item : samples ) {
+		stats.set(item.first, item.second);
+	}
+	stats.endUpdate();
+	check(stats, samples);
+	BOOST_CHECK_EQUAL(stats.median(), 2.0);
+
+	// Samples not set within an update are removed, changed ones are
+	// moved
+	samples.erase("b");
+	samples["c"] = 5.0;
+	samples["e"] = 2.5;
+
+	stats.beginUpdate();
+	for ( const auto &item : samples ) {
+		stats.set(item.first, item.second);
+	}
+	stats.endUpdate();
+	check(stats, samples);
+	BOOST_CHECK_EQUAL(stats.median(), 2.75);
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(random) {
+	// Adds, updates and removes samples in random order which also
+	// triggers the recomputation of the running sums several times.
+	// Values are rounded to produce duplicates.
+	mt19937 rng(42);
+	uniform_int_distribution<int> keys(0, 299);
+	uniform_real_distribution<double> magnitudes(-1.0, 8.0);
+	uniform_int_distribution<int> actions(0, 3);
+
+	OrderStatistics stats;
+	map<string, double> samples;
+
+	for ( int i = 0; i < 5000; ++i ) {
+		string key = Core::toString(keys(rng));
+
+		if ( actions(rng) == 0 ) {
+			stats.remove(key);
+			samples.erase(key);
+		}
+		else {
+			double value = round(magnitudes(rng) * 10) / 10;
+			stats.set(key, value);
+			samples[key] = value;
+		}
+
+		if ( i % 50 == 0 ) {
+			check(stats, samples);
+		}
+	}
+
+	check(stats, samples);
+
+	stats.clear();
+	samples.clear();
+	check(stats, samples);
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -17,6 +17,7 @@
 
 #include <seiscomp/datamodel/waveformquality.h>
 #include <seiscomp/plugins/qc/qcbuffer.h>
+#include <seiscomp/plugins/qc/qcwindow.h>
 #include <seiscomp/plugins/qc/qcconfig.h>
 #include <seiscomp/qc/qcprocessor_availability.h>
 #include "qcplugin_availability.h"
@@ -99,7 +100,7 @@ void QcPluginAvailability::timeoutTask() {
 
 	qcp->recordStartTime = _lastRecordEndTime;
 	qcp->parameter = static_cast<double>(qcp->recordEndTime - qcp->recordStartTime);
-	_qcBuffer->push_back(&_streamID, qcp);
+	addParameter(qcp);
 
 	Core::Time t;
 	sendMessages(t);
@@ -200,6 +201,21 @@ std::vector<double> QcPluginAvailability::availability(const QcBuffer *buf) cons
 	}
 
 	int estimatedSamples = Private::round(static_cast<double>(tw.length()) * samplingFrequency);
+
+	// The window has aggregated samples, gaps and overlaps already. All
+	// records are inside its time window if the start times increase.
+	auto window = dynamic_cast<const QcWindow*>(buf);
+	if ( window && window->isRegular() ) {
+		returnVector[0] = 100.0 * window->samples() / estimatedSamples;
+		if ( returnVector[0] > 100.0 ) {
+			returnVector[0] = 100.0;
+		}
+
+		returnVector[1] = window->gapCount();
+		returnVector[2] = window->overlapCount();
+		return returnVector;
+	}
+
 	int gapCount = 0;
 	int overlapCount = 0;
 	Core::Time lastTime = Core::Time();
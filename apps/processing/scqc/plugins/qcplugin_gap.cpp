@@ -17,6 +17,7 @@
 
 #include <seiscomp/datamodel/waveformquality.h>
 #include <seiscomp/plugins/qc/qcbuffer.h>
+#include <seiscomp/plugins/qc/qcwindow.h>
 #include <seiscomp/plugins/qc/qcconfig.h>
 #include <seiscomp/qc/qcprocessor_gap.h>
 #include "qcplugin_gap.h"
@@ -56,6 +57,14 @@ QcPluginGap::QcPluginGap(): QcPlugin() {
 	_parameterNames.push_back("gaps interval");
 	_parameterNames.push_back("gaps length");
 	_parameterNames.push_back("gaps count");
+
+	// Each parameter describes a single gap
+	_eventExtractor = [](const QcParameter *qcp, QcWindow::Events &events) {
+		auto length = boost::any_cast<double>(&qcp->parameter);
+		if ( length ) {
+			events.push_back({qcp->recordStartTime, *length});
+		}
+	};
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -184,6 +193,10 @@ vector<double> QcPluginGap::_mean(const QcBuffer* buf) const {
 		return returnVector;
 	}
 
+	if ( eventMean(buf, returnVector) ) {
+		return returnVector;
+	}
+
 	if ( buf->size() == 1 ) {
 		returnVector[0] = 0.0;
 		returnVector[1] = boost::any_cast<double>(buf->front()->parameter);
@@ -233,6 +246,10 @@ vector<double> QcPluginGap::_stdDev(const QcBuffer* buf, double iMean, double lM
 		return returnVector;
 	}
 
+	if ( eventStdDev(buf, iMean, lMean, returnVector) ) {
+		return returnVector;
+	}
+
 	Core::Time lastGapTime;
 	double iSum = 0.0;
 	double lSum = 0.0;
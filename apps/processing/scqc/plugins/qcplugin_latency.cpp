@@ -77,7 +77,7 @@ void QcPluginLatency::timeoutTask() {
 
 	qcp->recordStartTime = _lastArrivalTime;
 	qcp->parameter = static_cast<double>(qcp->recordEndTime - qcp->recordStartTime);
-	_qcBuffer->push_back(&_streamID, qcp);
+	addParameter(qcp);
 
 	sendMessages(Core::Time());
 }
@@ -17,6 +17,7 @@
 
 #include <seiscomp/datamodel/waveformquality.h>
 #include <seiscomp/plugins/qc/qcbuffer.h>
+#include <seiscomp/plugins/qc/qcwindow.h>
 #include <seiscomp/plugins/qc/qcconfig.h>
 #include <seiscomp/qc/qcprocessor_overlap.h>
 #include "qcplugin_overlap.h"
@@ -52,6 +53,14 @@ QcPluginOverlap::QcPluginOverlap(): QcPlugin() {
 	_parameterNames.push_back("overlaps interval");
 	_parameterNames.push_back("overlaps length");
 	_parameterNames.push_back("overlaps count");
+
+	// Each parameter describes a single overlap
+	_eventExtractor = [](const QcParameter *qcp, QcWindow::Events &events) {
+		auto length = boost::any_cast<double>(&qcp->parameter);
+		if ( length ) {
+			events.push_back({qcp->recordStartTime, *length});
+		}
+	};
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -180,6 +189,10 @@ vector<double> QcPluginOverlap::_mean(const QcBuffer *buf) const {
 		return returnVector;
 	}
 
+	if ( eventMean(buf, returnVector) ) {
+		return returnVector;
+	}
+
 	if ( buf->size() == 1 ) {
 		returnVector[0] = 0.0;
 		returnVector[1] = boost::any_cast<double>(buf->front()->parameter);
@@ -230,6 +243,10 @@ vector<double> QcPluginOverlap::_stdDev(const QcBuffer *buf, double iMean, doubl
 		return returnVector;
 	}
 
+	if ( eventStdDev(buf, iMean, lMean, returnVector) ) {
+		return returnVector;
+	}
+
 	Core::Time lastOverlapTime;
 	double iSum = 0.0;
 	double lSum = 0.0;
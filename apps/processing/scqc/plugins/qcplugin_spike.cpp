@@ -17,6 +17,7 @@
 
 #include <seiscomp/datamodel/waveformquality.h>
 #include <seiscomp/plugins/qc/qcbuffer.h>
+#include <seiscomp/plugins/qc/qcwindow.h>
 #include <seiscomp/plugins/qc/qcconfig.h>
 #include <seiscomp/qc/qcprocessor_spike.h>
 #include "qcplugin_spike.h"
@@ -52,6 +53,15 @@ QcPluginSpike::QcPluginSpike(): QcPlugin() {
 	_parameterNames.push_back("spikes interval");
 	_parameterNames.push_back("spikes amplitude");
 	_parameterNames.push_back("spikes count");
+
+	_eventExtractor = [](const QcParameter *qcp, QcWindow::Events &events) {
+		auto spikes = boost::any_cast<Spikes>(&qcp->parameter);
+		if ( spikes ) {
+			for ( const auto &spike : *spikes ) {
+				events.push_back({spike.first, spike.second});
+			}
+		}
+	};
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -190,6 +200,10 @@ std::vector<double> QcPluginSpike::_mean(const QcBuffer * buf) const {
 		return returnVector;
 	}
 
+	if ( eventMean(buf, returnVector) ) {
+		return returnVector;
+	}
+
 	Core::Time lastSpikeTime;
 	double iSum = 0.0;
 	double aSum = 0.0;
@@ -238,6 +252,10 @@ std::vector<double> QcPluginSpike::_stdDev(const QcBuffer *buf, double iMean, do
 		return returnVector;
 	}
 
+	if ( eventStdDev(buf, iMean, aMean, returnVector) ) {
+		return returnVector;
+	}
+
 	Core::Time lastSpikeTime;
 	double iSum = 0.0;
 	double aSum = 0.0;
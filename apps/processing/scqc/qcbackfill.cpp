@@ -0,0 +1,402 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+
+#define SEISCOMP_COMPONENT SCQC
+#include <seiscomp/logging/log.h>
+#include <seiscomp/io/recordstream.h>
+#include <seiscomp/plugins/qc/qcmessenger.h>
+#include <seiscomp/plugins/qc/qcstream.h>
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+#include "qcbackfill.h"
+
+
+using namespace std;
+
+
+namespace Seiscomp {
+namespace Applications {
+namespace Qc {
+
+
+namespace {
+
+
+// Parent of all WaveformQuality objects
+const char *const QualityControlID = "QualityControl";
+
+
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcBackfill::QcBackfill(QcApp *app, const string &recordStreamURL,
+                       const Plugins &plugins)
+: _app(app)
+, _recordStreamURL(recordStreamURL)
+, _plugins(plugins) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcBackfill::addStream(const string &streamID,
+                           const Core::Time &startTime,
+                           const Core::Time &endTime) {
+	Core::Time time = startTime;
+
+	while ( time < endTime ) {
+		int year, month, day;
+		time.get(&year, &month, &day);
+
+		Core::Time dayStart(year, month, day);
+		Core::Time dayEnd = dayStart + Core::TimeSpan(86400, 0);
+
+		Unit unit;
+		unit.streamID = streamID;
+		unit.startTime = time;
+		unit.endTime = min(dayEnd, endTime);
+		unit.label = streamID + " " + dayStart.toString("%F");
+		_units.push_back(unit);
+
+		time = dayEnd;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcBackfill::setThreads(int threads) {
+	_threads = max(threads, 1);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcBackfill::setProgressFile(const string &filename) {
+	_progressFile = filename;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcBackfill::run(DataModel::DatabaseArchive *archive) {
+	set<string> completed;
+	loadProgress(completed);
+
+	vector<const Unit*> units;
+	for ( const auto &unit : _units ) {
+		if ( completed.find(unit.label) == completed.end() ) {
+			units.push_back(&unit);
+		}
+	}
+
+	SEISCOMP_INFO("backfill: %lu of %lu units to process in %d threads",
+	              static_cast<unsigned long>(units.size()),
+	              static_cast<unsigned long>(_units.size()), _threads);
+
+	if ( units.empty() ) {
+		return true;
+	}
+
+	if ( !_progressFile.empty() ) {
+		_progress.open(_progressFile.c_str(), ios_base::out | ios_base::app);
+		if ( !_progress.is_open() ) {
+			SEISCOMP_ERROR("Failed to open progress file %s", _progressFile);
+			return false;
+		}
+	}
+
+	atomic<size_t> next{0};
+	mutex resultMutex;
+	condition_variable resultCondition;
+	condition_variable spaceCondition;
+	deque<Result> results;
+	int runningWorkers = _threads;
+	// Workers wait while the database is behind by this many units
+	const size_t maxResults = 2 * static_cast<size_t>(_threads);
+
+	// Workers compute the units, the results are written to the
+	// database by this thread only
+	auto worker = [&]() {
+		for ( size_t i = next++; i < units.size(); i = next++ ) {
+			if ( _app->exitRequested() ) {
+				break;
+			}
+
+			Result result;
+			result.unit = units[i];
+			result.success = process(*units[i], result);
+
+			{
+				unique_lock<mutex> lock(resultMutex);
+				spaceCondition.wait(lock, [&] {
+					return results.size() < maxResults;
+				});
+				results.push_back(std::move(result));
+			}
+
+			resultCondition.notify_one();
+		}
+
+		{
+			lock_guard<mutex> lock(resultMutex);
+			--runningWorkers;
+		}
+
+		resultCondition.notify_one();
+	};
+
+	vector<thread> workers;
+	for ( int i = 0; i < _threads; ++i ) {
+		workers.emplace_back(worker);
+	}
+
+	size_t written = 0, failed = 0, objectCount = 0;
+	deque<Result> items;
+
+	unique_lock<mutex> lock(resultMutex);
+
+	while ( runningWorkers > 0 || !results.empty() ) {
+		resultCondition.wait(lock, [&] {
+			return runningWorkers == 0 || !results.empty();
+		});
+
+		items.swap(results);
+		lock.unlock();
+
+		spaceCondition.notify_all();
+
+		for ( const auto &result : items ) {
+			if ( result.success && write(archive, result) ) {
+				storeProgress(*result.unit);
+				objectCount += result.objects.size();
+				++written;
+			}
+			else {
+				SEISCOMP_ERROR("backfill: %s failed", result.unit->label);
+				++failed;
+			}
+		}
+
+		items.clear();
+		lock.lock();
+	}
+
+	lock.unlock();
+
+	for ( auto &t : workers ) {
+		t.join();
+	}
+
+	SEISCOMP_INFO("backfill: %lu units with %lu objects written, %lu failed, %lu left",
+	              static_cast<unsigned long>(written),
+	              static_cast<unsigned long>(objectCount),
+	              static_cast<unsigned long>(failed),
+	              static_cast<unsigned long>(units.size() - written - failed));
+
+	return failed == 0;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcBackfill::process(const Unit &unit, Result &result) const {
+	IO::RecordStreamPtr rs = IO::RecordStream::Open(_recordStreamURL.c_str());
+	if ( !rs ) {
+		SEISCOMP_ERROR("Failed to open recordstream: %s", _recordStreamURL);
+		return false;
+	}
+
+	DataModel::WaveformStreamID waveformID = getWaveformID(unit.streamID);
+	if ( !rs->addStream(waveformID.networkCode(), waveformID.stationCode(),
+	                    waveformID.locationCode(), waveformID.channelCode(),
+	                    unit.startTime, unit.endTime) ) {
+		SEISCOMP_ERROR("%s: failed to add stream", unit.label);
+		return false;
+	}
+
+	// The objects of the plugins are collected instead of being sent
+	QcMessengerPtr collector = new QcMessenger;
+	QcStreamPtr stream = new QcStream(unit.streamID);
+
+	for ( const auto &item : _plugins ) {
+		QcPluginPtr plugin = QcPlugin::Cast(QcPluginFactory::Create(item.first.c_str()));
+		if ( !plugin ) {
+			SEISCOMP_WARNING("QcPlugin %s not found!", item.first);
+			continue;
+		}
+
+		if ( !plugin->init(_app, item.second.get(), unit.streamID) ) {
+			SEISCOMP_WARNING("Initializing QcPlugin %s failed! Skipped.",
+			                 plugin->registeredName());
+			continue;
+		}
+
+		plugin->setQcMessenger(collector.get());
+		stream->add(plugin.get());
+	}
+
+	if ( stream->plugins().empty() ) {
+		return false;
+	}
+
+	size_t recordCount = 0;
+
+	while ( true ) {
+		RecordPtr rec = rs->next();
+		if ( !rec ) {
+			break;
+		}
+
+		// Each record belongs to the unit containing its start time. A
+		// record crossing midnight is processed by the earlier unit only.
+		if ( rec->startTime() < unit.startTime
+		  || rec->startTime() >= unit.endTime ) {
+			continue;
+		}
+
+		stream->dispatch(rec.get());
+		++recordCount;
+	}
+
+	rs->close();
+
+	for ( auto &plugin : stream->plugins() ) {
+		plugin->flushArchive(unit.endTime);
+	}
+
+	result.objects = collector->takeObjects();
+
+	SEISCOMP_DEBUG("%s: %lu records, %lu objects", unit.label,
+	               static_cast<unsigned long>(recordCount),
+	               static_cast<unsigned long>(result.objects.size()));
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcBackfill::write(DataModel::DatabaseArchive *archive,
+                       const Result &result) {
+	if ( result.objects.empty() ) {
+		return true;
+	}
+
+	IO::DatabaseInterface *db = archive->driver();
+	bool transaction = db && db->beginTransaction();
+	bool success = true;
+
+	for ( const auto &obj : result.objects ) {
+		if ( !archive->write(obj.get(), QualityControlID) ) {
+			success = false;
+			break;
+		}
+	}
+
+	if ( transaction ) {
+		if ( success ) {
+			success = db->commit();
+		}
+		else {
+			db->rollback();
+		}
+	}
+
+	if ( success ) {
+		return true;
+	}
+
+	// Objects of a unit may have been stored already by an interrupted
+	// run which did not record its progress: write them one by one and
+	// update existing objects
+	SEISCOMP_WARNING("%s: bulk insert failed, storing objects one by one",
+	                 result.unit->label);
+
+	for ( const auto &obj : result.objects ) {
+		if ( !archive->write(obj.get(), QualityControlID)
+		  && !archive->update(obj.get(), QualityControlID) ) {
+			return false;
+		}
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcBackfill::loadProgress(set<string> &completed) const {
+	if ( _progressFile.empty() ) {
+		return;
+	}
+
+	ifstream ifs(_progressFile.c_str());
+	string line;
+
+	while ( getline(ifs, line) ) {
+		if ( !line.empty() ) {
+			completed.insert(line);
+		}
+	}
+
+	if ( !completed.empty() ) {
+		SEISCOMP_INFO("backfill: %lu units completed already",
+		              static_cast<unsigned long>(completed.size()));
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcBackfill::storeProgress(const Unit &unit) {
+	if ( _progress.is_open() ) {
+		_progress << unit.label << endl;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+}
+}
+}
@@ -0,0 +1,107 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+
+#ifndef SEISCOMP_APPLICATIONS_QCBACKFILL__
+#define SEISCOMP_APPLICATIONS_QCBACKFILL__
+
+#include <seiscomp/core/datetime.h>
+#include <seiscomp/datamodel/databasearchive.h>
+#include <seiscomp/plugins/qc/qcplugin.h>
+#include <seiscomp/plugins/qc/qcconfig.h>
+
+#include <fstream>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+
+namespace Seiscomp {
+namespace Applications {
+namespace Qc {
+
+
+/**
+ * @brief Computes the archive QC parameters of historic data in parallel.
+ *
+ * The time span of each stream is split into days. These (stream, day)
+ * units are processed independently by worker threads, each unit with its
+ * own record stream and plugin instances. The archive WaveformQuality
+ * objects of a unit are written to the database by the calling thread in
+ * one transaction. Completed units are appended to the progress file and
+ * skipped when the backfill is started again.
+ */
+class QcBackfill {
+	public:
+		typedef std::map<std::string, QcConfigPtr> Plugins;
+
+
+	public:
+		QcBackfill(QcApp *app, const std::string &recordStreamURL,
+		           const Plugins &plugins);
+
+
+	public:
+		//! Adds the units of a stream covering the given time span
+		void addStream(const std::string &streamID,
+		               const Core::Time &startTime, const Core::Time &endTime);
+
+		void setThreads(int threads);
+		void setProgressFile(const std::string &filename);
+
+		//! Processes all units which are not completed yet and writes
+		//! the results to the archive
+		bool run(DataModel::DatabaseArchive *archive);
+
+
+	private:
+		struct Unit {
+			std::string streamID;
+			Core::Time  startTime;
+			Core::Time  endTime;
+			//! Identifies the unit in the progress file
+			std::string label;
+		};
+
+		struct Result {
+			const Unit                       *unit;
+			bool                              success;
+			std::vector<DataModel::ObjectPtr> objects;
+		};
+
+		bool process(const Unit &unit, Result &result) const;
+		bool write(DataModel::DatabaseArchive *archive, const Result &result);
+
+		void loadProgress(std::set<std::string> &completed) const;
+		void storeProgress(const Unit &unit);
+
+
+	private:
+		QcApp             *_app;
+		std::string        _recordStreamURL;
+		Plugins            _plugins;
+		std::vector<Unit>  _units;
+		int                _threads{1};
+		std::string        _progressFile;
+		std::ofstream      _progress;
+};
+
+
+}
+}
+}
+
+
+#endif
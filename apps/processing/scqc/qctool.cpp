@@ -27,6 +27,7 @@
 #include <boost/regex.hpp>
 
 #include "qctool.h"
+#include "qcbackfill.h"
 
 
 using boost::any_cast;
@@ -101,12 +102,16 @@ void QcTool::createCommandLineDescription() {
 	StreamApplication::createCommandLineDescription();
 
 	commandline().addOption("Messaging", "test", "Disable sending messages");
+	commandline().addGroup("Processing");
+	commandline().addOption("Processing", "threads", "Number of threads processing the streams. Each thread runs the plugins of its share of streams.", (int*)nullptr);
 	commandline().addGroup("Archive-Processing");
 	commandline().addOption("Archive-Processing", "archive", "Processing of archived data.");
 	commandline().addOption("Archive-Processing", "auto-time", "Automatic determination of start time for each stream from last db entries.\nend-time is set to future.");
 	commandline().addOption("Archive-Processing", "begin-time", "Begin time of record acquisition.\n[e.g.: \"2008-11-11 10:33:50\"]", (string*)nullptr);
 	commandline().addOption("Archive-Processing", "end-time", "End time of record acquisition. If unset, current Time is used.", (string*)nullptr);
 	commandline().addOption("Archive-Processing", "stream-mask", "Use this regexp for stream selection.\n[e.g. \"^GE.*BHZ$\"]", (string*)nullptr);
+	commandline().addOption("Archive-Processing", "backfill", "Process the archived data per stream and day in parallel and write the archive parameters to the database directly. Requires --archive.");
+	commandline().addOption("Archive-Processing", "progress-file", "File recording the completed days of a backfill. Completed days are skipped when the backfill is started again.", (string*)nullptr);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -156,6 +161,30 @@ bool QcTool::validateParameters() {
 		_qcMessenger->setTestMode(true);
 	}
 
+	if ( commandline().hasOption("threads") ) {
+		_threads = commandline().option<int>("threads");
+	}
+
+	if ( _threads < 1 ) {
+		cerr << "The number of threads must be at least 1" << endl;
+		return false;
+	}
+
+	if ( (_backfill = commandline().hasOption("backfill")) ) {
+		if ( !_archiveMode ) {
+			cerr << "--backfill requires --archive" << endl;
+			return false;
+		}
+
+		try {
+			_progressFile = commandline().option<string>("progress-file");
+		}
+		catch ( ... ) {}
+
+		// The backfill opens a record stream per unit
+		setRecordStreamEnabled(false);
+	}
+
 	//setMessagingEnabled(!commandline().hasOption("archive"));
 	//setDatabaseEnabled(!commandline().hasOption("archive"), true);
 
@@ -208,6 +237,35 @@ bool QcTool::initConfiguration() {
 		_dbLookBack = 7;
 	}
 
+	try {
+		_threads = configGetInt("threads");
+	}
+	catch ( ... ) {}
+
+	try {
+		_qcMessenger->setMaxMessageSize(configGetInt("batch.maxObjects"));
+	}
+	catch ( ... ) {}
+
+	double batchInterval = 1.0;
+	try {
+		batchInterval = configGetDouble("batch.interval");
+	}
+	catch ( ... ) {}
+
+	// Messages are scheduled by the timer every second
+	if ( batchInterval < 1.0 ) {
+		SEISCOMP_ERROR("batch.interval must not be less than 1 s");
+		return false;
+	}
+
+	_qcMessenger->setSendInterval(batchInterval);
+
+	try {
+		_qcMessenger->setCoalescing(configGetBool("batch.coalesce"));
+	}
+	catch ( ... ) {}
+
 	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -430,6 +488,18 @@ bool QcTool::init() {
 
 	SEISCOMP_DEBUG("number of streams: %ld", (long int)_streamIDs.size());
 
+	if ( _threads > 1 && !_backfill ) {
+		SEISCOMP_INFO("processing streams in %d threads", _threads);
+
+		// Plugins send their objects from the shard threads
+		_qcMessenger->setDeferred(true);
+
+		for ( int i = 0; i < _threads; ++i ) {
+			_shards.emplace_back(new QcShard(static_cast<size_t>(i)));
+			_shards.back()->start();
+		}
+	}
+
 	// Enable timeout callback every second
 	enableTimer(1);
 
@@ -454,6 +524,12 @@ void QcTool::addStream(string net, string sta, string loc, string cha) {
 
 	SEISCOMP_INFO("adding stream: %s with timewindow: %s -- %s",
 	              streamID, begin.iso(), _endTime ? _endTime->iso() : "[]");
+
+	if ( _backfill ) {
+		_streamBeginTimes[streamID] = begin;
+		return;
+	}
+
 	recordStream()->addStream(net, sta, loc, cha, begin, _endTime);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -496,8 +572,40 @@ Core::Time QcTool::findLast(string net, string sta, string loc, string cha) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcTool::run() {
+	if ( !_backfill ) {
+		return QcApp::run();
+	}
+
+	if ( !query() ) {
+		SEISCOMP_ERROR("backfill: no database connection");
+		return false;
+	}
+
+	QcBackfill backfill(this, recordStreamURL(), _plugins);
+	backfill.setThreads(_threads);
+	backfill.setProgressFile(_progressFile);
+
+	for ( const auto &item : _streamBeginTimes ) {
+		backfill.addStream(item.first, item.second, *_endTime);
+	}
+
+	return backfill.run(query());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void QcTool::done() {
+	//! finish processing of all queued records, the plugins are only
+	//! accessed by this thread afterwards
+	for ( auto &shard : _shards ) {
+		shard->stop();
+	}
+
 	//! trigger QcPlugins to make last calculation before finish
 	doneSignal();
 
@@ -518,6 +626,20 @@ void QcTool::initQc(const string &networkCode, const string &stationCode,
 
 	const string streamID = networkCode + "." + stationCode  + "." + locationCode  + "." + channelCode;
 
+	// All plugins of the stream share one processing stage which decodes
+	// each record only once
+	QcStreamPtr stream = new QcStream(streamID);
+
+	// Assign the stream to the shard with the fewest streams
+	if ( !_shards.empty() ) {
+		_initShard = _shards.front().get();
+		for ( auto &shard : _shards ) {
+			if ( shard->streamCount() < _initShard->streamCount() ) {
+				_initShard = shard.get();
+			}
+		}
+	}
+
 	for ( auto it = _plugins.begin(); it != _plugins.end(); ++it ) {
 		qcPlugin = QcPlugin::Cast(QcPluginFactory::Create(it->first.c_str()));
 		if ( !qcPlugin ) {
@@ -533,7 +655,26 @@ void QcTool::initQc(const string &networkCode, const string &stationCode,
 		}
 
 		_qcPluginMap.insert(pair<string, QcPluginCPtr>(streamID, qcPlugin));
-		addProcessor(networkCode, stationCode, locationCode, channelCode, qcPlugin->qcProcessor());
+		stream->add(qcPlugin);
+	}
+
+	if ( _initShard ) {
+		// The timeouts are connected after the plugins are initialized
+		// since the shard thread may emit them at any time
+		if ( !stream->plugins().empty() ) {
+			_initShard->addStream(stream.get());
+			for ( auto &onTimeout : _initTimeouts ) {
+				_initShard->addTimeout(onTimeout);
+			}
+		}
+
+		_initTimeouts.clear();
+		_initShard = nullptr;
+	}
+
+	if ( !stream->plugins().empty() ) {
+		_qcStreams[streamID] = stream;
+		addProcessor(networkCode, stationCode, locationCode, channelCode, stream.get());
 	}
 
 	if ( _plugins.size() > 0 ) {
@@ -590,6 +731,10 @@ void QcTool::processorFinished(const Record *rec, Processing::WaveformProcessor
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void QcTool::handleTimeout() {
 	_emitTimeout();
+
+	// Sends the objects attached by the plugins, in particular those
+	// queued by the shard threads
+	_qcMessenger->scheduler();
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -598,6 +743,11 @@ void QcTool::handleTimeout() {
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void QcTool::addTimeout(const TimerSignal::slot_type& onTimeout) const {
+	if ( _initShard ) {
+		_initTimeouts.push_back(onTimeout);
+		return;
+	}
+
 	_emitTimeout.connect(onTimeout);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
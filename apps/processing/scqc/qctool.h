@@ -21,6 +21,7 @@
 #include <seiscomp/plugins/qc/qcmessenger.h>
 #include <seiscomp/plugins/qc/qcplugin.h>
 #include <seiscomp/plugins/qc/qcconfig.h>
+#include <seiscomp/plugins/qc/qcstream.h>
 
 #include <boost/version.hpp>
 #include <boost/any.hpp>
@@ -29,6 +30,8 @@
 #include <string>
 #include <set>
 #include <map>
+#include <memory>
+#include <vector>
 
 
 namespace bsig = boost::signals2;
@@ -64,6 +67,7 @@ class QcTool : public QcApp, public bsig::trackable {
 		bool initConfiguration() override;
 
 		bool init() override;
+		bool run() override;
 		void done() override;
 
 		void handleTimeout() override;
@@ -88,6 +92,11 @@ class QcTool : public QcApp, public bsig::trackable {
 		OPT(Core::Time) _endTime;
 		std::string _streamMask;
 
+		bool _backfill{false};
+		std::string _progressFile;
+		//! begin time of each stream in archive mode
+		std::map<std::string, Core::Time> _streamBeginTimes;
+
 		bool _useConfiguredStreams;
 		bool _use3Components;
 		std::set<std::string> _streamIDs;
@@ -107,6 +116,16 @@ class QcTool : public QcApp, public bsig::trackable {
 		using QcPluginMap = std::multimap<const std::string, QcPluginCPtr>;
 		QcPluginMap _qcPluginMap;
 
+		//! the shared processing stage of each stream
+		std::map<std::string, QcStreamPtr> _qcStreams;
+
+		//! worker threads sharing the streams if more than one thread is used
+		int _threads{1};
+		std::vector<std::unique_ptr<QcShard>> _shards;
+		//! timeouts registered while initializing the plugins of a shard
+		QcShard *_initShard{nullptr};
+		mutable std::vector<TimerSignal::slot_type> _initTimeouts;
+
 		mutable TimerSignal _emitTimeout;
 		Util::StopWatch _timer;
 };
@@ -103,9 +103,7 @@ void QcBuffer::push_back(const std::string *streamID, const QcParameter *qcp) {
 			BufferBase::push_front(qcp);
 		}
 		else {
-			auto rit = rbegin();
-			--rit;
-			while ( rit != rend() ) {
+			for ( auto rit = rbegin(); rit != rend(); ++rit ) {
 				if ( qcp->recordEndTime >= (*rit)->recordEndTime ) {
 					BufferBase::insert(rit.base(), qcp);
 					break;
@@ -89,16 +89,22 @@ QcIndex toIndex(const DataModel::Object *obj) {
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 // Synchronize with scmaster every 100 messages
 #define SYNC_COUNT 100
+// The time between two calls of the scheduler
+#define SCHEDULER_PERIOD 1.0
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-QcMessenger::QcMessenger(QcApp *app) : _app(app) {
-	QcApp::TimerSignal::slot_type slot = bind(&QcMessenger::scheduler, this);
-	_app->addTimeout(slot);
-}
+QcMessenger::QcMessenger(QcApp *app) : _app(app) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcMessenger::QcMessenger() : _app(nullptr) {}
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -113,40 +119,161 @@ void QcMessenger::setTestMode(bool enable) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcMessenger::setDeferred(bool enable) {
+	_deferred = enable;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool QcMessenger::attachObject(DataModel::Object *obj, bool notifier, Operation operation) {
+	if ( !_app ) {
+		if ( notifier ) {
+			_collectedObjects.push_back(obj);
+		}
+		return true;
+	}
+
+	if ( _deferred ) {
+		std::lock_guard<std::mutex> lock(_pendingMutex);
+		_pendingObjects.push_back(PendingObject{obj, notifier, operation, Util::StopWatch()});
+		return true;
+	}
+
+	attach(obj, notifier, operation, Util::StopWatch());
+
+	// send the messages which are full or due
+	dispatchMessages();
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcMessenger::setMaxMessageSize(int size) {
+	_maxSize = size > 0 ? static_cast<size_t>(size) : 1;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcMessenger::setSendInterval(double seconds) {
+	_sendInterval = seconds;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcMessenger::setCoalescing(bool enable) {
+	_coalescing = enable;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcMessenger::attach(DataModel::Object *obj, bool notifier, Operation operation,
+                         const Util::StopWatch &age) {
+	QcIndex idx = toIndex(obj);
+
 	// send notifier msg
 	if ( notifier ) {
 		if ( operation == OP_UNDEFINED ) {
-			QcIndex idx = toIndex(obj);
 			if ( _qcIndex.find(idx) ) {
-				//cerr << _qcIndex.size() << "   found QcIndex: " << idx.key << "-" << idx.startTime.iso() << endl; //! DEBUG
 				operation = OP_UPDATE;
 			}
 			else {
-				//cerr << _qcIndex.size() << "   did not find QcIndex: " << idx.key << "-" << idx.startTime.iso() << endl; //! DEBUG
 				operation = OP_ADD;
 				_qcIndex.insert(idx);
 			}
 		}
 
-		if ( !_notifierMsg ) _notifierMsg = new NotifierMessage;
-		NotifierPtr notifier = new Notifier(myPackage, operation, obj);
-		_notifierMsg->attach(notifier);
+		string key;
+		if ( _coalescing && !idx.key.empty() ) {
+			key = idx.key + "@" + idx.startTime.iso();
+
+			auto it = _notifiers.positions.find(key);
+			if ( it != _notifiers.positions.end() ) {
+				// Replace the object but keep the operation of the pending
+				// notifier, e.g. an update of an object not yet sent
+				// remains an add
+				auto pending = static_cast<Notifier*>(_notifiers.objects[it->second].get());
+				_notifiers.objects[it->second] = new Notifier(myPackage, pending->operation(), obj);
+				return;
+			}
+		}
 
+		add(_notifiers, key, new Notifier(myPackage, operation, obj), age);
 	}
 	// send data msg
 	else {
-		if ( !_dataMsg ) {
-			_dataMsg = new DataMessage;
+		string key;
+		if ( _coalescing && !idx.key.empty() ) {
+			key = idx.key;
+
+			auto it = _data.positions.find(key);
+			if ( it != _data.positions.end() ) {
+				_data.objects[it->second] = obj;
+				return;
+			}
 		}
-		_dataMsg->attach(obj);
+
+		add(_data, key, obj, age);
 	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-	// let scheduler decide, when to send the message
-	scheduler();
 
-	return true;
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcMessenger::add(Batch &batch, const string &key, Core::BaseObject *obj,
+                      const Util::StopWatch &age) {
+	// The batch is as old as its first object
+	if ( batch.empty() ) {
+		batch.age = age;
+	}
+
+	if ( !key.empty() ) {
+		batch.positions[key] = batch.objects.size();
+	}
+
+	batch.objects.push_back(obj);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcMessenger::attachPendingObjects() {
+	std::deque<PendingObject> objects;
+
+	{
+		std::lock_guard<std::mutex> lock(_pendingMutex);
+		objects.swap(_pendingObjects);
+	}
+
+	for ( auto &pending : objects ) {
+		attach(pending.object.get(), pending.notifier, pending.operation, pending.age);
+
+		// Send full messages right away as attachObject does
+		if ( _notifiers.objects.size() >= _maxSize
+		  || _data.objects.size() >= _maxSize ) {
+			dispatchMessages();
+		}
+	}
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -155,43 +282,78 @@ bool QcMessenger::attachObject(DataModel::Object *obj, bool notifier, Operation
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void QcMessenger::scheduler() {
-	bool msgSent = false;
-
-	if ( _notifierMsg ) {
-		try {
-			if ( ((_timer.elapsed() > _sendInterval) && (_notifierMsg->size() > 0))
-			  || (_notifierMsg->size() >=_maxSize) ) {
-// 				SEISCOMP_DEBUG("sending Qc NOTIFIER message with %d attachments", _notifierMsg->size());
-				sendMessage(_notifierMsg.get());
-				msgSent = true;
-			}
+	if ( _deferred ) {
+		attachPendingObjects();
+	}
+
+	// Objects must not wait for the next call if they would exceed the
+	// send interval until then
+	dispatchMessages(Core::TimeSpan(SCHEDULER_PERIOD));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcMessenger::isDue(const Batch &batch, const Core::TimeSpan &ahead) const {
+	if ( batch.empty() ) {
+		return false;
+	}
+
+	// Messages are sent if they are full or their first object would
+	// wait longer than the send interval
+	return batch.objects.size() >= _maxSize || batch.age.elapsed() + ahead >= _sendInterval;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcMessenger::send(Batch &batch, bool notifier) {
+	MessagePtr msg;
+
+	if ( notifier ) {
+		NotifierMessagePtr notifierMsg = new NotifierMessage;
+		for ( auto &obj : batch.objects ) {
+			notifierMsg->attach(static_cast<Notifier*>(obj.get()));
 		}
-		catch ( ... ) { //FIXME error handling
-			if ( _notifierMsg->size() > 2000 ) {
-				_notifierMsg->clear();
-				SEISCOMP_ERROR("Notifier message buffer overflow! Buffer cleared!");
-			}
+		msg = notifierMsg;
+	}
+	else {
+		DataMessagePtr dataMsg = new DataMessage;
+		for ( auto &obj : batch.objects ) {
+			dataMsg->attach(obj.get());
 		}
+		msg = dataMsg;
 	}
 
-	if ( _dataMsg ) {
-		try {
-			if ( ((_timer.elapsed() > _sendInterval) && (_dataMsg->size() > 0)) || (_dataMsg->size() >=_maxSize) ) {
-// 				SEISCOMP_DEBUG("sending Qc DATA message with %d attachments", _dataMsg->size());
-				sendMessage(_dataMsg.get());
-				msgSent = true;
-			}
-		}
-		catch (...){ //FIXME error handling
-			if ( _dataMsg->size() > 2000 ) {
-				_dataMsg->clear();
-				SEISCOMP_ERROR("Data message buffer overflow! Buffer cleared!");
-			}
+	try {
+		sendMessage(msg.get());
+		batch.clear();
+	}
+	catch ( ... ) { //FIXME error handling
+		if ( batch.objects.size() > 2000 ) {
+			batch.clear();
+			SEISCOMP_ERROR("%s message buffer overflow! Buffer cleared!",
+			               notifier ? "Notifier" : "Data");
 		}
 	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcMessenger::dispatchMessages(const Core::TimeSpan &ahead) {
+	if ( isDue(_notifiers, ahead) ) {
+		send(_notifiers, true);
+	}
 
-	if ( msgSent ) {
-		_timer.restart();
+	if ( isDue(_data, ahead) ) {
+		send(_data, false);
 	}
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -211,6 +373,17 @@ void QcMessenger::flushMessages(){
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::vector<DataModel::ObjectPtr> QcMessenger::takeObjects() {
+	std::vector<DataModel::ObjectPtr> objects;
+	objects.swap(_collectedObjects);
+	return objects;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool QcMessenger::sendMessage(Message *msg) {
 	Client::Connection *con = _app->connection();
@@ -17,6 +17,10 @@
 
 #include <string>
 #include <list>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <vector>
 
 #include <seiscomp/core/exceptions.h>
 #include <seiscomp/core/message.h>
@@ -99,6 +103,11 @@ class SC_QCPLUGIN_API QcMessenger : public Core::BaseObject {
 		//! Initializing Constructor
 		QcMessenger(QcApp *app);
 
+		//! Creates a messenger which does not send messages. It collects
+		//! the objects attached as notifiers which are retrieved with
+		//! takeObjects(). Objects attached as data messages are discarded.
+		QcMessenger();
+
 	public:
 		/**
 		 * @brief Sets the test mode with respect to sending messages.
@@ -106,11 +115,39 @@ class SC_QCPLUGIN_API QcMessenger : public Core::BaseObject {
 		 */
 		void setTestMode(bool enable);
 
+		/**
+		 * @brief Enables deferred attachment of objects.
+		 * If enabled, attachObject may be called from any thread. The
+		 * objects are only queued and merged into the messages by the
+		 * next call of scheduler() which is called from the messaging
+		 * thread.
+		 * @param enable Whether to defer the attachment
+		 */
+		void setDeferred(bool enable);
+
+		//! Sets the maximum number of objects per message
+		void setMaxMessageSize(int size);
+
+		//! Sets the maximum time in seconds an object is held back before
+		//! its message is sent
+		void setSendInterval(double seconds);
+
+		/**
+		 * @brief Enables coalescing of pending objects.
+		 * If enabled, a WaveformQuality object replaces a pending object of
+		 * the same stream, type and parameter. Notifiers additionally need
+		 * to refer to the same start time.
+		 * @param enable Whether to coalesce objects
+		 */
+		void setCoalescing(bool enable);
+
 		//! Attach object to message and schedule sending
 		//! (if notifier is true send as notifier message; as data message otherwise)
 		bool attachObject(DataModel::Object *obj, bool notifier, Operation operation=OP_UNDEFINED);
 
-		//! Scheduler for sending messages (called periodically by application)
+		//! Scheduler for sending messages. It must be called every second
+		//! by the messaging thread of the application. Messages which
+		//! would exceed the send interval before the next call are sent.
 		void scheduler();
 
 		//! Send Qc Message
@@ -118,15 +155,54 @@ class SC_QCPLUGIN_API QcMessenger : public Core::BaseObject {
 
 		void flushMessages();
 
+	private:
+		struct PendingObject {
+			DataModel::ObjectPtr object;
+			bool                 notifier;
+			Operation            operation;
+			//! Started when the object was queued
+			Util::StopWatch      age;
+		};
+
+		//! Objects or notifiers waiting to be sent in one message
+		struct Batch {
+			std::vector<Core::BaseObjectPtr> objects;
+			//! Positions of the objects by coalescing key
+			std::map<std::string, size_t>    positions;
+			//! Started with the first object
+			Util::StopWatch                  age;
+
+			bool empty() const { return objects.empty(); }
+			void clear() { objects.clear(); positions.clear(); }
+		};
+
+		void attach(DataModel::Object *obj, bool notifier, Operation operation,
+		            const Util::StopWatch &age);
+		void attachPendingObjects();
+		void add(Batch &batch, const std::string &key, Core::BaseObject *obj,
+		         const Util::StopWatch &age);
+		//! Whether the batch is full or its send interval passes within
+		//! the given time
+		bool isDue(const Batch &batch, const Core::TimeSpan &ahead) const;
+		void send(Batch &batch, bool notifier);
+		//! Sends the messages which are due within the given time
+		void dispatchMessages(const Core::TimeSpan &ahead = Core::TimeSpan(0.0));
+
 	private:
 		QcIndexMap          _qcIndex;
-		NotifierMessagePtr  _notifierMsg;
-		DataMessagePtr      _dataMsg;
+		Batch               _notifiers;
+		Batch               _data;
 		QcApp              *_app;
 		Core::TimeSpan      _sendInterval{1.0};
-		int                 _maxSize{500};
+		size_t              _maxSize{500};
+		bool                _coalescing{false};
 		bool                _testMode{false};
-		Util::StopWatch     _timer;
+
+		bool                       _deferred{false};
+		std::deque<PendingObject>  _pendingObjects;
+		std::mutex                 _pendingMutex;
+
+		std::vector<DataModel::ObjectPtr> _collectedObjects;
 
 };
 
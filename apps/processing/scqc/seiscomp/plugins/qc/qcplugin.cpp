@@ -29,6 +29,7 @@
 #include <seiscomp/qc/qcprocessor.h>
 #include "qcmessenger.h"
 #include "qcbuffer.h"
+#include "qcwindow.h"
 #include "qcconfig.h"
 #include "qcplugin.h"
 
@@ -109,7 +110,23 @@ bool QcPlugin::init(QcApp* app, QcConfig *cfg, std::string streamID) {
 	_streamID = streamID;
 	_qcMessenger = _app->qcMessenger();
 	_firstRecord = true;
-	_qcBuffer = new QcBuffer(_app->archiveMode() ? _qcConfig->archiveBuffer() : _qcConfig->buffer());
+
+	double bufferSize = _app->archiveMode() ? _qcConfig->archiveBuffer() : _qcConfig->buffer();
+	_qcBuffer = new QcBuffer(bufferSize);
+	_archiveWindow = new QcWindow(_qcConfig->archiveBuffer(), bufferSize);
+	_reportWindow = new QcWindow(_qcConfig->reportBuffer(), bufferSize);
+	if ( !_app->archiveMode() ) {
+		_alertWindow = new QcWindow(_qcConfig->alertBuffer(), bufferSize);
+	}
+
+	if ( _eventExtractor ) {
+		for ( auto window : { _archiveWindow.get(), _reportWindow.get(),
+		                      _alertWindow.get() } ) {
+			if ( window ) {
+				window->setEventExtractor(_eventExtractor);
+			}
+		}
+	}
 
 	if (! _app->archiveMode() && _qcConfig->reportTimeout() != 0) {
 		_timer.restart();
@@ -117,7 +134,8 @@ bool QcPlugin::init(QcApp* app, QcConfig *cfg, std::string streamID) {
 		_app->addTimeout(std::bind(&QcPlugin::onTimeout, this));
 	}
 
-	_app->doneSignal.connect(std::bind(&QcPlugin::done, this));
+	// Disconnected when the plugin is destroyed before the application
+	_doneConnection = _app->doneSignal.connect(std::bind(&QcPlugin::done, this));
 
 	return true;
 }
@@ -229,6 +247,79 @@ void QcPlugin::generateAlert(const QcBuffer *shortBuffer,
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcPlugin::addParameter(const QcParameter *qcp) {
+	_qcBuffer->push_back(&_streamID, qcp);
+	_archiveWindow->push_back(&_streamID, qcp);
+	_reportWindow->push_back(&_streamID, qcp);
+	if ( _alertWindow ) {
+		_alertWindow->push_back(&_streamID, qcp);
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcPlugin::eventMean(const QcBuffer *buf, std::vector<double> &result) const {
+	auto window = dynamic_cast<const QcWindow*>(buf);
+	if ( !window || !window->hasEventExtractor() ) {
+		return false;
+	}
+
+	size_t count = window->eventValues().count();
+	if ( count > 0 ) {
+		if ( count > 1 ) {
+			result[0] = window->eventIntervals().mean();
+		}
+		result[1] = window->eventValues().mean();
+		result[2] = static_cast<double>(count);
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcPlugin::eventStdDev(const QcBuffer *buf, double iMean, double vMean,
+                           std::vector<double> &result) const {
+	auto window = dynamic_cast<const QcWindow*>(buf);
+	if ( !window || !window->hasEventExtractor() ) {
+		return false;
+	}
+
+	size_t count = window->eventValues().count();
+	if ( count > 1 ) {
+		if ( count > 2 ) {
+			result[0] = sqrt(window->eventIntervals().squaredDeviations(iMean) / (count - 2));
+		}
+		result[1] = sqrt(window->eventValues().squaredDeviations(vMean) / (count - 1));
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcBufferCPtr QcPlugin::windowBuffer(const QcWindow *window, int span) const {
+	if ( window && window->isRegular() ) {
+		return window;
+	}
+
+	return _qcBuffer->qcParameter(Core::TimeSpan(span, 0));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void QcPlugin::pushObject(DataModel::Object *obj) const {
 	_objects.push(obj);
@@ -265,6 +356,11 @@ double QcPlugin::mean(const QcBuffer *qcb) const {
 		return 0.0;
 	}
 
+	auto window = dynamic_cast<const QcWindow*>(qcb);
+	if ( window && window->values().count() == window->size() ) {
+		return window->values().mean();
+	}
+
 	double sum = 0.0;
 
 	for ( auto &p : *qcb ) {
@@ -284,6 +380,11 @@ double QcPlugin::stdDev(const QcBuffer* qcb, double mean) const {
 		return 0.0;
 	}
 
+	auto window = dynamic_cast<const QcWindow*>(qcb);
+	if ( window && window->values().count() == window->size() ) {
+		return sqrt(window->values().squaredDeviations(mean) / (qcb->size() - 1));
+	}
+
 	double sum = 0.0;
 
 	for ( auto &p : *qcb ) {
@@ -302,7 +403,7 @@ void QcPlugin::update() {
 	QcParameter *qcp = _qcProcessor->getState();
 
 	if ( _qcProcessor->isValid() ) {
-		_qcBuffer->push_back(&_streamID, qcp);
+		addParameter(qcp);
 	}
 
 	sendMessages(qcp->recordEndTime);
@@ -341,7 +442,7 @@ void QcPlugin::sendMessages(const Core::Time &rectime) {
 	if ( _qcConfig->archiveInterval() >= 0 && rectime != Core::Time() ) {
 		diff = rectime - _lastArchiveTime;
 		if ( diff > Core::TimeSpan(_qcConfig->archiveInterval(), 0) || _app->exitRequested() ) {
-			QcBufferCPtr archiveBuffer = _qcBuffer->qcParameter(Core::TimeSpan(_qcConfig->archiveBuffer(), 0));
+			QcBufferCPtr archiveBuffer = windowBuffer(_archiveWindow.get(), _qcConfig->archiveBuffer());
 			if ( !archiveBuffer->empty() ) {
 				generateReport(archiveBuffer.get());
 				sendObjects(true); // as notifier msg
@@ -356,7 +457,7 @@ void QcPlugin::sendMessages(const Core::Time &rectime) {
 	if ( _qcConfig->reportInterval() >= 0 ) {
 		diff = rectime - _lastReportTime;
 		if ( diff > Core::TimeSpan(_qcConfig->reportInterval(), 0) || rectime == Core::Time()) {
-			QcBufferCPtr reportBuffer = _qcBuffer->qcParameter(Core::TimeSpan(_qcConfig->reportBuffer(), 0));
+			QcBufferCPtr reportBuffer = windowBuffer(_reportWindow.get(), _qcConfig->reportBuffer());
 			generateReport(reportBuffer.get());
 			sendObjects(false);
 			_lastReportTime = rectime;
@@ -372,7 +473,7 @@ void QcPlugin::sendMessages(const Core::Time &rectime) {
 		if ( ( diff > Core::TimeSpan(_qcConfig->alertInterval(), 0)
 		    && static_cast<int>(_qcBuffer->length().seconds()) >= _qcConfig->alertBuffer() )
 		  || rectime == Core::Time()) {
-			QcBufferCPtr alertBuffer = _qcBuffer->qcParameter(Core::TimeSpan(_qcConfig->alertBuffer(), 0));
+			QcBufferCPtr alertBuffer = windowBuffer(_alertWindow.get(), _qcConfig->alertBuffer());
 			if ( alertBuffer->empty() ) {
 				return;
 			}
@@ -428,6 +529,15 @@ void QcPlugin::onTimeout() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcPlugin::setQcMessenger(QcMessenger *messenger) {
+	_qcMessenger = messenger;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void QcPlugin::done() {
 	sendMessages(Core::Time());
@@ -437,6 +547,33 @@ void QcPlugin::done() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcPlugin::flushArchive(const Core::Time &endTime) {
+	if ( _qcConfig->archiveInterval() < 0 || _qcBuffer->empty() ) {
+		return;
+	}
+
+	QcBufferCPtr archiveBuffer = windowBuffer(_archiveWindow.get(), _qcConfig->archiveBuffer());
+	if ( archiveBuffer->empty() ) {
+		return;
+	}
+
+	// Nothing received since the last archive report
+	if ( archiveBuffer->endTime() <= _lastArchiveTime ) {
+		return;
+	}
+
+	generateReport(archiveBuffer.get());
+	sendObjects(true); // as notifier msg
+	_lastArchiveTime = endTime;
+	SEISCOMP_DEBUG("ARCHIVE(%s): %s, %d values",
+	               registeredName(), _streamID, _qcBuffer->size());
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 }
 }
@@ -21,6 +21,7 @@
 #include <seiscomp/core/plugin.h>
 #include <seiscomp/utils/timer.h>
 #include <seiscomp/plugins/qc/api.h>
+#include <seiscomp/plugins/qc/qcwindow.h>
 #include <seiscomp/datamodel/waveformquality.h>
 
 #include <queue>
@@ -88,9 +89,17 @@ class QcPlugin : public Processing::QcProcessorObserver {
 		//! Returns the corresponding QcProcessor object
 		Processing::QcProcessor* qcProcessor();
 
+		//! Sets the messenger the objects are passed to instead of the
+		//! messenger of the application
+		void setQcMessenger(QcMessenger *messenger);
+
 		//! Finish the work
 		void done();
 
+		//! Generates the archive report of the parameters received since
+		//! the last archive report, e.g. at the end of a time span processed
+		void flushArchive(const Core::Time &endTime);
+
 	protected:
 		void onTimeout();
 		virtual void timeoutTask();
@@ -102,6 +111,25 @@ class QcPlugin : public Processing::QcProcessorObserver {
 		virtual void generateReport(const QcBuffer* reportBuffer) const;
 		virtual void generateAlert(const QcBuffer* staBuffer, const QcBuffer* ltaBuffer) const;
 
+		//! Adds a parameter to the buffer and all report windows
+		void addParameter(const Processing::QcParameter *qcp);
+
+		//! Returns the interval mean, value mean and count of the events
+		//! in result if buf is a window aggregating events, otherwise
+		//! false is returned and the caller must compute them from the
+		//! parameters.
+		bool eventMean(const QcBuffer *buf, std::vector<double> &result) const;
+
+		//! Same as eventMean for the standard deviations of the event
+		//! intervals and values.
+		bool eventStdDev(const QcBuffer *buf, double iMean, double vMean,
+		                 std::vector<double> &result) const;
+
+		//! Returns the parameters of the most recent time span. If the
+		//! window is regular it is returned, otherwise the parameters are
+		//! collected from the buffer.
+		QcBufferCPtr windowBuffer(const QcWindow *window, int span) const;
+
 		//! collect objects to be send to qcMessenger
 		void pushObject(DataModel::Object* obj) const;
 
@@ -120,6 +148,12 @@ class QcPlugin : public Processing::QcProcessorObserver {
 		QcMessenger                              *_qcMessenger;
 		const QcConfig                           *_qcConfig;
 		mutable QcBufferPtr                       _qcBuffer;
+		QcWindowPtr                               _archiveWindow;
+		QcWindowPtr                               _reportWindow;
+		QcWindowPtr                               _alertWindow;
+		//! Extracts the events (e.g. gaps or spikes) of a parameter for
+		//! aggregation, must be set in the constructor
+		QcWindow::EventExtractor                  _eventExtractor;
 		Processing::QcProcessorPtr                _qcProcessor;
 
 	private:
@@ -128,6 +162,7 @@ class QcPlugin : public Processing::QcProcessorObserver {
 		mutable Core::Time                        _lastAlertTime;
 		mutable bool                              _firstRecord;
 		mutable Util::StopWatch                   _timer;
+		bsig::scoped_connection                   _doneConnection;
 };
 
 
@@ -0,0 +1,282 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+
+#define SEISCOMP_COMPONENT SCQC
+#include <seiscomp/logging/log.h>
+#include <seiscomp/core/genericrecord.h>
+
+#include <chrono>
+
+#include "qcstream.h"
+
+
+namespace Seiscomp {
+namespace Applications {
+namespace Qc {
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcStream::QcStream(const std::string &streamID)
+: _streamID(streamID) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcStream::add(QcPlugin *plugin) {
+	_plugins.push_back(plugin);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcStream::feed(const Record *rec) {
+	if ( _plugins.empty() ) {
+		return false;
+	}
+
+	if ( _shard ) {
+		_shard->push(this, rec);
+		return true;
+	}
+
+	return dispatch(rec);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool QcStream::dispatch(const Record *rec) {
+	if ( _plugins.empty() ) {
+		return false;
+	}
+
+	RecordCPtr shared = rec;
+
+	// A single processor decodes the record itself anyway
+	if ( _plugins.size() > 1 ) {
+		const Array *data;
+
+		try {
+			data = rec->data();
+		}
+		catch ( std::exception &e ) {
+			SEISCOMP_WARNING("%s: failed to decode record: %s",
+			                 _streamID, e.what());
+			return false;
+		}
+
+		if ( !data ) {
+			return false;
+		}
+
+		if ( data->dataType() != Array::DOUBLE ) {
+			GenericRecordPtr converted = new GenericRecord(
+				rec->networkCode(), rec->stationCode(),
+				rec->locationCode(), rec->channelCode(),
+				rec->startTime(), rec->samplingFrequency(),
+				rec->timingQuality(), Array::DOUBLE, Record::DATA_ONLY
+			);
+			converted->setData(data->copy(Array::DOUBLE));
+			shared = converted;
+		}
+	}
+
+	bool fed = false;
+	for ( auto &plugin : _plugins ) {
+		if ( plugin->qcProcessor()->feed(shared.get()) ) {
+			fed = true;
+		}
+	}
+
+	return fed;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcStream::reset() {
+	Processing::WaveformProcessor::reset();
+
+	for ( auto &plugin : _plugins ) {
+		plugin->qcProcessor()->reset();
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcStream::process(const Record *, const DoubleArray &) {
+	// Records are dispatched by feed
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcShard::QcShard(size_t id) : _id(id) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcShard::~QcShard() {
+	stop();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcShard::addStream(QcStream *stream) {
+	stream->setShard(this);
+	++_streamCount;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcShard::addTimeout(const QcApp::TimerSignal::slot_type &onTimeout) {
+	_emitTimeout.connect(onTimeout);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcShard::start() {
+	if ( _thread.joinable() ) {
+		return;
+	}
+
+	_exit = false;
+	_thread = std::thread(&QcShard::run, this);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcShard::stop() {
+	if ( !_thread.joinable() ) {
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_exit = true;
+	}
+
+	_condition.notify_one();
+	_thread.join();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcShard::push(QcStream *stream, const Record *rec) {
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		if ( _queue.size() >= MaxQueueSize && _thread.joinable() ) {
+			SEISCOMP_DEBUG("QC shard %lu: queue full, waiting",
+			               static_cast<unsigned long>(_id));
+			_notFull.wait(lock, [this] {
+				return _queue.size() < MaxQueueSize;
+			});
+		}
+
+		_queue.push_back(Item{stream, rec});
+	}
+
+	_condition.notify_one();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcShard::run() {
+	typedef std::chrono::steady_clock Clock;
+
+	SEISCOMP_DEBUG("QC shard %lu started", static_cast<unsigned long>(_id));
+
+	auto nextTimeout = Clock::now() + std::chrono::seconds(1);
+	Queue items;
+
+	std::unique_lock<std::mutex> lock(_mutex);
+
+	while ( true ) {
+		_condition.wait_until(lock, nextTimeout, [this] {
+			return _exit || !_queue.empty();
+		});
+
+		items.swap(_queue);
+		bool exit = _exit;
+		lock.unlock();
+
+		_notFull.notify_all();
+
+		for ( auto &item : items ) {
+			item.stream->dispatch(item.record.get());
+		}
+
+		items.clear();
+
+		auto now = Clock::now();
+		if ( now >= nextTimeout ) {
+			_emitTimeout();
+			nextTimeout = now + std::chrono::seconds(1);
+		}
+
+		lock.lock();
+
+		if ( exit && _queue.empty() ) {
+			break;
+		}
+	}
+
+	SEISCOMP_DEBUG("QC shard %lu finished", static_cast<unsigned long>(_id));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+}
+}
+}
@@ -0,0 +1,158 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+
+#ifndef SEISCOMP_QC_QCSTREAM_H__
+#define SEISCOMP_QC_QCSTREAM_H__
+
+
+#include <seiscomp/processing/waveformprocessor.h>
+#include <seiscomp/plugins/qc/api.h>
+#include <seiscomp/plugins/qc/qcplugin.h>
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+namespace Seiscomp {
+namespace Applications {
+namespace Qc {
+
+
+class QcShard;
+
+DEFINE_SMARTPOINTER(QcStream);
+
+/**
+ * @brief The shared processing stage of one stream.
+ *
+ * Only the stream is registered with the application. It decodes each
+ * record once, converts the samples to double and passes the converted
+ * record to the processors of all plugins attached to the stream. The
+ * processors then copy the samples without decoding them again.
+ *
+ * If the stream is assigned to a shard, records are passed to the shard
+ * thread which runs the plugins instead.
+ */
+class SC_QCPLUGIN_API QcStream : public Processing::WaveformProcessor {
+	public:
+		typedef std::vector<QcPluginPtr> Plugins;
+
+
+	public:
+		QcStream(const std::string &streamID);
+
+
+	public:
+		const std::string &streamID() const { return _streamID; }
+
+		void add(QcPlugin *plugin);
+		const Plugins &plugins() const { return _plugins; }
+
+		//! Passes all records to the given shard instead of processing
+		//! them in the calling thread
+		void setShard(QcShard *shard) { _shard = shard; }
+		QcShard *shard() const { return _shard; }
+
+		bool feed(const Record *rec) override;
+		void reset() override;
+
+		//! Feeds the record to the processors of all plugins
+		bool dispatch(const Record *rec);
+
+
+	protected:
+		void process(const Record *rec, const DoubleArray &data) override;
+
+
+	private:
+		std::string _streamID;
+		Plugins     _plugins;
+		QcShard    *_shard{nullptr};
+};
+
+
+/**
+ * @brief A worker thread processing a subset of all streams.
+ *
+ * The plugins of the streams assigned to a shard are only accessed by its
+ * thread: records are queued by the application and the timeouts
+ * registered with the shard are emitted every second by the shard thread.
+ * Objects of the plugins must therefore be passed to a deferred
+ * QcMessenger.
+ */
+class SC_QCPLUGIN_API QcShard {
+	public:
+		QcShard(size_t id);
+		~QcShard();
+
+
+	public:
+		size_t id() const { return _id; }
+		size_t streamCount() const { return _streamCount; }
+
+		//! Assigns the stream to this shard
+		void addStream(QcStream *stream);
+
+		//! Registers a timeout callback called every second by the shard
+		//! thread
+		void addTimeout(const QcApp::TimerSignal::slot_type &onTimeout);
+
+		void start();
+
+		//! Processes all queued records and joins the thread
+		void stop();
+
+		//! Queues the record of an assigned stream. If the queue is full
+		//! the call blocks until the shard thread took the queued records.
+		void push(QcStream *stream, const Record *rec);
+
+
+	private:
+		void run();
+
+
+	private:
+		struct Item {
+			QcStream   *stream;
+			RecordCPtr  record;
+		};
+
+		typedef std::deque<Item> Queue;
+
+		//! Maximum number of records waiting for the shard thread
+		static const size_t MaxQueueSize = 10000;
+
+		size_t                  _id;
+		size_t                  _streamCount{0};
+		std::thread             _thread;
+		std::mutex              _mutex;
+		std::condition_variable _condition;
+		std::condition_variable _notFull;
+		Queue                   _queue;
+		bool                    _exit{false};
+		QcApp::TimerSignal      _emitTimeout;
+};
+
+
+}
+}
+}
+
+
+#endif
@@ -0,0 +1,334 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT SCQC
+#include <seiscomp/logging/log.h>
+
+#include <boost/any.hpp>
+
+#include <algorithm>
+#include <iterator>
+
+#include "qcwindow.h"
+
+
+namespace Seiscomp {
+namespace Applications {
+namespace Qc {
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::Moments::add(double value) {
+	if ( !_count ) {
+		_shift = value;
+		_sum = _sumSq = 0.0;
+	}
+
+	double d = value - _shift;
+	_sum += d;
+	_sumSq += d * d;
+	++_count;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::Moments::remove(double value) {
+	if ( !_count ) {
+		return;
+	}
+
+	if ( --_count == 0 ) {
+		reset();
+		return;
+	}
+
+	double d = value - _shift;
+	_sum -= d;
+	_sumSq -= d * d;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::Moments::reset() {
+	_count = 0;
+	_shift = _sum = _sumSq = 0.0;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double QcWindow::Moments::squaredDeviations(double m) const {
+	// sum((x-m)^2) with x = d + shift
+	double k = _shift - m;
+	double result = _sumSq + 2.0 * k * _sum + _count * k * k;
+	return result > 0.0 ? result : 0.0;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+QcWindow::QcWindow(double span, double maxBufferSize)
+: QcBuffer(maxBufferSize)
+, _span(span)
+, _maxBufferSize(maxBufferSize) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::setEventExtractor(const EventExtractor &extractor) {
+	_eventExtractor = extractor;
+	recompute();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::push_back(const QcParameter *qcp) {
+	push_back(nullptr, qcp);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::push_back(const std::string *streamID, const QcParameter *qcp) {
+	if ( !empty() && qcp->recordEndTime < back()->recordEndTime ) {
+		// Out-of-order: sorted insert and fold everything again
+		QcBuffer::push_back(streamID, qcp);
+		trim();
+		recompute();
+		return;
+	}
+
+	BufferBase::push_back(qcp);
+	fold(qcp);
+	trim();
+
+	// Refresh the sums regularly to prevent the accumulation of
+	// rounding errors caused by removals
+	if ( _removals > _summaries.size() + 64 ) {
+		recompute();
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::fold(const QcParameter *qcp) {
+	Summary summary;
+
+	if ( qcp->parameter.type() == typeid(double) ) {
+		summary.value = boost::any_cast<double>(qcp->parameter);
+		summary.hasValue = true;
+		_values.add(summary.value);
+	}
+
+	// Sampling frequency -1 marks timeout entries
+	if ( qcp->recordSamplingFrequency != -1.0 ) {
+		double fs = qcp->recordSamplingFrequency;
+		summary.real = true;
+		summary.samples = static_cast<int>(static_cast<double>(qcp->recordEndTime - qcp->recordStartTime) * fs + 0.5);
+		_samples += summary.samples;
+
+		if ( _lastRecordEndTime != Core::Time() ) {
+			double diff = static_cast<double>(qcp->recordStartTime - _lastRecordEndTime);
+			if ( diff > (0.5 / fs) ) {
+				summary.link = 1;
+				++_gaps;
+			}
+			else if ( diff < (-0.5 / fs) ) {
+				summary.link = -1;
+				++_overlaps;
+			}
+		}
+
+		_lastRecordEndTime = qcp->recordEndTime;
+	}
+
+	if ( !_summaries.empty() && qcp->recordStartTime < _lastStartTime ) {
+		summary.irregular = true;
+		++_irregularEntries;
+	}
+
+	_lastStartTime = qcp->recordStartTime;
+
+	if ( _eventExtractor ) {
+		Events events;
+		_eventExtractor(qcp, events);
+
+		for ( const auto &event : events ) {
+			EventEntry entry{event.value, 0.0, false};
+
+			if ( _hasLastEvent ) {
+				entry.interval = static_cast<double>(event.time - _lastEventTime);
+				entry.hasInterval = true;
+				_eventIntervals.add(entry.interval);
+			}
+
+			_eventValues.add(entry.value);
+			_lastEventTime = event.time;
+			_hasLastEvent = true;
+			_events.push_back(entry);
+		}
+
+		summary.events = events.size();
+	}
+
+	_summaries.push_back(summary);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::popFront() {
+	Summary summary = _summaries.front();
+	_summaries.pop_front();
+	BufferBase::pop_front();
+	++_removals;
+
+	if ( summary.hasValue ) {
+		_values.remove(summary.value);
+	}
+
+	if ( summary.irregular ) {
+		--_irregularEntries;
+	}
+
+	if ( summary.real ) {
+		_samples -= summary.samples;
+
+		// The next record has no predecessor anymore
+		auto it = std::find_if(_summaries.begin(), _summaries.end(),
+		                       [](const Summary &s) { return s.real; });
+		if ( it != _summaries.end() ) {
+			if ( it->link > 0 ) {
+				--_gaps;
+			}
+			else if ( it->link < 0 ) {
+				--_overlaps;
+			}
+			it->link = 0;
+		}
+		else {
+			_lastRecordEndTime = Core::Time();
+		}
+	}
+
+	for ( size_t i = 0; i < summary.events; ++i ) {
+		_eventValues.remove(_events.front().value);
+		if ( _events.front().hasInterval ) {
+			_eventIntervals.remove(_events.front().interval);
+		}
+		_events.pop_front();
+	}
+
+	if ( !_events.empty() ) {
+		if ( _events.front().hasInterval ) {
+			_eventIntervals.remove(_events.front().interval);
+			_events.front().hasInterval = false;
+		}
+	}
+	else {
+		_hasLastEvent = false;
+	}
+
+	// The ordering of the new front with respect to the removed entry
+	// does not matter anymore
+	if ( !_summaries.empty() && _summaries.front().irregular ) {
+		_summaries.front().irregular = false;
+		--_irregularEntries;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::trim() {
+	// Same limit as applied by QcBuffer::push_back
+	if ( _maxBufferSize != -1 ) {
+		Core::TimeSpan maxSpan = _maxBufferSize * 1.1;
+		while ( !empty() && (back()->recordEndTime - front()->recordEndTime > maxSpan) ) {
+			popFront();
+		}
+	}
+
+	// Same selection as QcBuffer::qcParameter: the oldest parameter
+	// kept is the first one exceeding the span
+	if ( _span >= 0 ) {
+		Core::TimeSpan span(_span);
+		while ( size() > 1 && (back()->recordEndTime - (*std::next(begin()))->recordStartTime > span) ) {
+			popFront();
+		}
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void QcWindow::recompute() {
+	_summaries.clear();
+	_events.clear();
+	_lastStartTime = Core::Time();
+	_lastRecordEndTime = Core::Time();
+	_lastEventTime = Core::Time();
+	_hasLastEvent = false;
+	_removals = 0;
+
+	_values.reset();
+	_samples = 0;
+	_gaps = 0;
+	_overlaps = 0;
+	_irregularEntries = 0;
+	_eventValues.reset();
+	_eventIntervals.reset();
+
+	for ( const auto &qcp : *this ) {
+		fold(qcp.get());
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+}
+}
+}
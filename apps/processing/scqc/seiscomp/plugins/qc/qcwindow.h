@@ -0,0 +1,166 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+#ifndef SEISCOMP_QC_QCWINDOW_H__
+#define SEISCOMP_QC_QCWINDOW_H__
+
+
+#include <seiscomp/plugins/qc/qcbuffer.h>
+
+#include <deque>
+#include <functional>
+#include <vector>
+
+
+namespace Seiscomp {
+namespace Applications {
+namespace Qc {
+
+
+DEFINE_SMARTPOINTER(QcWindow);
+
+/**
+ * @brief A QcBuffer covering a sliding time span which folds its
+ *        parameters into running aggregates while they are added.
+ *
+ * The window holds the same parameters as QcBuffer::qcParameter(span)
+ * of a buffer receiving the same parameters but is updated incrementally
+ * which makes report and alert generation independent of the number of
+ * buffered parameters.
+ *
+ * The window content is only equivalent to QcBuffer::qcParameter if the
+ * start times of the parameters do not decrease. Otherwise isRegular()
+ * returns false and consumers should fall back to QcBuffer.
+ */
+class SC_QCPLUGIN_API QcWindow : public QcBuffer {
+	public:
+		//! A single value extracted from a parameter, e.g. a spike
+		struct Event {
+			Core::Time time;
+			double     value;
+		};
+
+		typedef std::vector<Event> Events;
+		typedef std::function<void (const QcParameter *, Events &)> EventExtractor;
+
+		//! Running sums of a value series. The values are shifted by
+		//! the first value added to reduce cancellation errors.
+		class Moments {
+			public:
+				void add(double value);
+				void remove(double value);
+				void reset();
+
+				size_t count() const { return _count; }
+				double sum() const { return _sum + _count * _shift; }
+				double mean() const { return _count ? sum() / _count : 0.0; }
+
+				//! Returns the sum of squared deviations from m
+				double squaredDeviations(double m) const;
+
+			private:
+				size_t _count{0};
+				double _shift{0};
+				double _sum{0};
+				double _sumSq{0};
+		};
+
+
+	public:
+		//! Creates a window covering span seconds, a negative span covers
+		//! the whole buffer. maxBufferSize limits the buffer as
+		//! in QcBuffer.
+		QcWindow(double span, double maxBufferSize);
+
+
+	public:
+		//! Sets the function extracting events from parameters. Must be
+		//! set before the first parameter is added.
+		void setEventExtractor(const EventExtractor &extractor);
+		bool hasEventExtractor() const { return static_cast<bool>(_eventExtractor); }
+
+		//! Adds a parameter and removes all parameters leaving the window
+		void push_back(const QcParameter *qcp);
+		void push_back(const std::string *streamID, const QcParameter *qcp);
+
+		bool isRegular() const { return _irregularEntries == 0; }
+
+		//! Parameters of type double
+		const Moments &values() const { return _values; }
+
+		//! Number of samples of all records, excludes timeout entries
+		int samples() const { return _samples; }
+		int gapCount() const { return _gaps; }
+		int overlapCount() const { return _overlaps; }
+
+		//! Values of all events in the window
+		const Moments &eventValues() const { return _eventValues; }
+		//! Time spans between consecutive events in the window
+		const Moments &eventIntervals() const { return _eventIntervals; }
+
+
+	private:
+		struct Summary {
+			double value{0};
+			bool   hasValue{false};
+			bool   real{false};
+			int    samples{0};
+			// -1 for an overlap, 1 for a gap to the previous record
+			int    link{0};
+			// Start time before the previous parameter
+			bool   irregular{false};
+			size_t events{0};
+		};
+
+		struct EventEntry {
+			double value;
+			double interval;
+			bool   hasInterval;
+		};
+
+		void fold(const QcParameter *qcp);
+		void popFront();
+		void trim();
+		void recompute();
+
+
+	private:
+		double                  _span;
+		double                  _maxBufferSize;
+		EventExtractor          _eventExtractor;
+
+		std::deque<Summary>     _summaries;
+		std::deque<EventEntry>  _events;
+		Core::Time              _lastStartTime;
+		Core::Time              _lastRecordEndTime;
+		Core::Time              _lastEventTime;
+		bool                    _hasLastEvent{false};
+		size_t                  _removals{0};
+
+		Moments                 _values;
+		int                     _samples{0};
+		int                     _gaps{0};
+		int                     _overlaps{0};
+		size_t                  _irregularEntries{0};
+		Moments                 _eventValues;
+		Moments                 _eventIntervals;
+};
+
+
+}
+}
+}
+
+
+#endif
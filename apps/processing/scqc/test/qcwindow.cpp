@@ -0,0 +1,362 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_TEST_MODULE scqc
+
+#include <seiscomp/plugins/qc/qcwindow.h>
+#include <seiscomp/unittest/unittests.h>
+
+#include <boost/any.hpp>
+#include <boost/test/included/unit_test.hpp>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+
+using namespace std;
+using namespace Seiscomp;
+using namespace Seiscomp::Applications::Qc;
+
+
+namespace {
+
+
+const double FS = 20.0;
+const double SPIKE_THRESHOLD = 0.8;
+
+
+Core::Time T(double offset) {
+	return Core::Time(1600000000, 0) + Core::TimeSpan(offset);
+}
+
+
+QcParameterPtr makeParameter(double start, double end, double value,
+                             double fs = FS) {
+	QcParameterPtr qcp = new QcParameter;
+	qcp->parameter = value;
+	qcp->recordStartTime = T(start);
+	qcp->recordEndTime = T(end);
+	qcp->recordSamplingFrequency = fs;
+	return qcp;
+}
+
+
+// Reports a spike at the record start time for large values
+void extractSpikes(const QcParameter *qcp, QcWindow::Events &events) {
+	double value = boost::any_cast<double>(qcp->parameter);
+	if ( value > SPIKE_THRESHOLD ) {
+		events.push_back(QcWindow::Event{qcp->recordStartTime, value});
+	}
+}
+
+
+struct Statistics {
+	size_t count{0};
+	double mean{0};
+	double squaredDeviations{0};
+};
+
+
+Statistics statistics(const vector<double> &values) {
+	Statistics stats;
+	stats.count = values.size();
+	if ( values.empty() ) {
+		return stats;
+	}
+
+	for ( double v : values ) {
+		stats.mean += v;
+	}
+	stats.mean /= values.size();
+
+	for ( double v : values ) {
+		stats.squaredDeviations += (v - stats.mean) * (v - stats.mean);
+	}
+
+	return stats;
+}
+
+
+void checkMoments(const QcWindow::Moments &moments, const vector<double> &values) {
+	Statistics expected = statistics(values);
+	BOOST_REQUIRE_EQUAL(moments.count(), expected.count);
+	if ( !expected.count ) {
+		return;
+	}
+
+	BOOST_CHECK_SMALL(moments.mean() - expected.mean, 1E-9);
+	BOOST_CHECK_SMALL(moments.squaredDeviations(expected.mean) - expected.squaredDeviations, 1E-6);
+}
+
+
+// Compares the aggregates of the window with the content of the buffer
+// for the same span evaluated from scratch. A negative span covers the
+// whole buffer.
+void check(const QcWindow &window, const QcBuffer &buffer, double span) {
+	QcBufferPtr ref;
+	if ( span >= 0 ) {
+		ref = buffer.qcParameter(Core::TimeSpan(span));
+	}
+	else {
+		ref = new QcBuffer;
+		ref->insert(ref->end(), buffer.begin(), buffer.end());
+	}
+	BOOST_REQUIRE_EQUAL(window.size(), ref->size());
+
+	vector<double> values, eventValues, eventIntervals;
+	int samples = 0, gaps = 0, overlaps = 0;
+	Core::Time lastEnd, lastEvent;
+	bool hasLastEnd = false, hasLastEvent = false;
+
+	for ( const auto &qcp : *ref ) {
+		double value = boost::any_cast<double>(qcp->parameter);
+		values.push_back(value);
+
+		double fs = qcp->recordSamplingFrequency;
+		if ( fs != -1.0 ) {
+			samples += static_cast<int>(static_cast<double>(qcp->recordEndTime - qcp->recordStartTime) * fs + 0.5);
+
+			if ( hasLastEnd ) {
+				double diff = static_cast<double>(qcp->recordStartTime - lastEnd);
+				if ( diff > 0.5 / fs ) {
+					++gaps;
+				}
+				else if ( diff < -0.5 / fs ) {
+					++overlaps;
+				}
+			}
+
+			lastEnd = qcp->recordEndTime;
+			hasLastEnd = true;
+		}
+
+		QcWindow::Events events;
+		extractSpikes(qcp.get(), events);
+		for ( const auto &event : events ) {
+			if ( hasLastEvent ) {
+				eventIntervals.push_back(static_cast<double>(event.time - lastEvent));
+			}
+			eventValues.push_back(event.value);
+			lastEvent = event.time;
+			hasLastEvent = true;
+		}
+	}
+
+	checkMoments(window.values(), values);
+	BOOST_CHECK_EQUAL(window.samples(), samples);
+	BOOST_CHECK_EQUAL(window.gapCount(), gaps);
+	BOOST_CHECK_EQUAL(window.overlapCount(), overlaps);
+	checkMoments(window.eventValues(), eventValues);
+	checkMoments(window.eventIntervals(), eventIntervals);
+}
+
+
+struct Fixture {
+	Fixture(double span, double maxBufferSize = -1)
+	: span(span), buffer(maxBufferSize), window(new QcWindow(span, maxBufferSize)) {
+		window->setEventExtractor(extractSpikes);
+	}
+
+	void push(const QcParameterPtr &qcp) {
+		buffer.push_back(qcp.get());
+		window->push_back(qcp.get());
+		check(*window, buffer, span);
+	}
+
+	double      span;
+	QcBuffer    buffer;
+	QcWindowPtr window;
+};
+
+
+}
+
+
+BOOST_AUTO_TEST_SUITE(seiscomp_main_scqc_qcwindow)
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(moments) {
+	QcWindow::Moments moments;
+	BOOST_CHECK_EQUAL(moments.count(), 0);
+	BOOST_CHECK_EQUAL(moments.mean(), 0);
+
+	// Large offsets must not cancel out the deviations
+	moments.add(1E9 + 1);
+	moments.add(1E9 + 2);
+	moments.add(1E9 + 3);
+	BOOST_CHECK_SMALL(moments.mean() - (1E9 + 2), 1E-6);
+	BOOST_CHECK_SMALL(moments.squaredDeviations(1E9 + 2) - 2.0, 1E-6);
+
+	moments.remove(1E9 + 1);
+	BOOST_CHECK_EQUAL(moments.count(), 2);
+	BOOST_CHECK_SMALL(moments.mean() - (1E9 + 2.5), 1E-6);
+
+	moments.remove(1E9 + 2);
+	moments.remove(1E9 + 3);
+	BOOST_CHECK_EQUAL(moments.count(), 0);
+	BOOST_CHECK_EQUAL(moments.sum(), 0);
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(links) {
+	Fixture f(25);
+
+	// Touching records
+	f.push(makeParameter(0, 10, 0.1));
+	f.push(makeParameter(10, 20, 0.2));
+	BOOST_CHECK_EQUAL(f.window->gapCount(), 0);
+	BOOST_CHECK_EQUAL(f.window->overlapCount(), 0);
+
+	// Jitter of exactly half a sample is tolerated
+	f.push(makeParameter(20 + 0.5 / FS, 30, 0.3));
+	f.push(makeParameter(30 - 0.5 / FS, 40, 0.4));
+	BOOST_CHECK_EQUAL(f.window->gapCount(), 0);
+	BOOST_CHECK_EQUAL(f.window->overlapCount(), 0);
+
+	// One sample gap and overlap
+	f.push(makeParameter(40 + 1 / FS, 50, 0.5));
+	f.push(makeParameter(50 - 1 / FS, 60, 0.6));
+	BOOST_CHECK_EQUAL(f.window->gapCount(), 1);
+	BOOST_CHECK_EQUAL(f.window->overlapCount(), 1);
+
+	// The gap and then the overlap leave the window with the record
+	// preceding them
+	f.push(makeParameter(60, 70, 0.7));
+	BOOST_CHECK_EQUAL(f.window->gapCount(), 0);
+	BOOST_CHECK_EQUAL(f.window->overlapCount(), 1);
+
+	f.push(makeParameter(70, 80, 0.1));
+	BOOST_CHECK_EQUAL(f.window->gapCount(), 0);
+	BOOST_CHECK_EQUAL(f.window->overlapCount(), 0);
+
+	// A timeout entry does not interrupt the record sequence
+	f.push(makeParameter(80, 80, 0.0, -1));
+	f.push(makeParameter(80 + 1 / FS, 90, 0.2));
+	BOOST_CHECK_EQUAL(f.window->gapCount(), 1);
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(span) {
+	// The window keeps the first parameter exceeding the span
+	Fixture f(30);
+	for ( int i = 0; i < 10; ++i ) {
+		f.push(makeParameter(i * 10, (i + 1) * 10, i % 3 ? 0.1 * i : 0.9 + 0.01 * i));
+	}
+
+	BOOST_CHECK_EQUAL(f.window->size(), 4);
+	BOOST_CHECK(f.window->front()->recordStartTime == T(60));
+	BOOST_CHECK(f.window->isRegular());
+
+	// A span of zero keeps the last parameter only
+	Fixture g(0);
+	g.push(makeParameter(0, 10, 0.5));
+	g.push(makeParameter(10, 20, 0.9));
+	BOOST_CHECK_EQUAL(g.window->size(), 1);
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(buffer_size) {
+	// The buffer size limits the window if it is shorter than the span
+	Fixture f(100, 20);
+	for ( int i = 0; i < 10; ++i ) {
+		f.push(makeParameter(i * 10, (i + 1) * 10, 0.1 * i));
+	}
+
+	BOOST_CHECK_EQUAL(f.window->size(), 3);
+
+	// A negative span covers the whole buffer
+	Fixture g(-1, 20);
+	for ( int i = 0; i < 10; ++i ) {
+		g.push(makeParameter(i * 10, (i + 1) * 10, 0.1 * i));
+	}
+
+	BOOST_CHECK_EQUAL(g.window->size(), 3);
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(out_of_order) {
+	Fixture f(50);
+	f.push(makeParameter(0, 10, 0.1));
+	f.push(makeParameter(20, 30, 0.9));
+	f.push(makeParameter(10, 20, 0.95));
+	f.push(makeParameter(30, 40, 0.3));
+
+	// Overlapping record starting before its predecessor
+	f.push(makeParameter(25, 45, 0.4));
+	BOOST_CHECK(!f.window->isRegular());
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+BOOST_AUTO_TEST_CASE(random) {
+	// Long sequences refresh the running sums several times
+	mt19937 rng(7);
+	uniform_real_distribution<double> values(0.0, 1.0);
+	uniform_int_distribution<int> links(0, 5);
+
+	Fixture f(120, 300);
+	double start = 0;
+
+	for ( int i = 0; i < 2000; ++i ) {
+		switch ( links(rng) ) {
+			case 0:
+				start += 0.5 / FS;
+				break;
+			case 1:
+				start += 1 / FS;
+				break;
+			case 2:
+				start -= 1 / FS;
+				break;
+			case 3:
+				start += 15;
+				break;
+			default:
+				break;
+		}
+
+		double end = start + 10;
+		f.push(makeParameter(start, end, values(rng)));
+		start = end;
+	}
+
+	BOOST_CHECK(f.window->isRegular());
+}
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+BOOST_AUTO_TEST_SUITE_END()
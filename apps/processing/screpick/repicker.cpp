@@ -25,7 +25,11 @@
 #include <seiscomp/utils/keyvalues.h>
 #include <seiscomp/utils/misc.h>
 
+#include <algorithm>
+#include <atomic>
 #include <iostream>
+#include <map>
+#include <thread>
 
 #include "repicker.h"
 
@@ -42,6 +46,31 @@ namespace Applications {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+namespace {
+
+
+// Record stream services reading local files. Each request reads the
+// day file of a channel again.
+bool isLocalRecordStream(const string &url) {
+	size_t pos = url.find("://");
+	if ( pos == string::npos ) {
+		// A plain path is read as file
+		return true;
+	}
+
+	string service = url.substr(0, pos);
+	return service == "file" || service == "sdsarchive"
+	    || service == "odcarchive";
+}
+
+
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void Repicker::Settings::accept(SettingsLinker &linker) {
 
@@ -71,6 +100,25 @@ void Repicker::Settings::accept(SettingsLinker &linker) {
 	linker & cliSwitch(repickedOnly, "Output", "repicked-only",
 	                   "Output repicked picks only"
 	);
+
+	linker & cfg(threads, "threads");
+	linker & cli(
+		threads, "Picker", "threads",
+		"Number of threads processing the picks of different "
+		"stations and days in parallel.",
+		true
+	);
+
+	linker & cfg(maxRequestGap, "maxRequestGap");
+	linker & cli(
+		maxRequestGap, "Picker", "max-request-gap",
+		"Maximum gap in seconds between the data time windows of two "
+		"picks of the same channel and day to request them at once. "
+		"Negative values select the gap by the record stream: one "
+		"request per channel and day for local archives and files, "
+		"60 s otherwise.",
+		true
+	);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -124,6 +172,11 @@ bool Repicker::validateParameters() {
 		return false;
 	}
 
+	if ( _settings.threads < 1 ) {
+		SEISCOMP_ERROR("Invalid number of threads: %d", _settings.threads);
+		return false;
+	}
+
 	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -137,13 +190,338 @@ bool Repicker::init() {
 		return false;
 	}
 
-	_picker = Processing::PickerFactory::Create(_settings.pickerInterface);
-	if ( !_picker ) {
+	// Each pick gets its own picker instance. Check here if the interface
+	// is available at all.
+	Processing::PickerPtr picker = Processing::PickerFactory::Create(_settings.pickerInterface);
+	if ( !picker ) {
 		SEISCOMP_ERROR("Picker interface '%s' is not available.",
 		               _settings.pickerInterface.c_str());
 		return false;
 	}
 
+	if ( _settings.maxRequestGap < 0 ) {
+		// Picks are batched per channel and day, a day covers all of them
+		_settings.maxRequestGap = isLocalRecordStream(recordStreamURL()) ? 86400 : 60;
+		SEISCOMP_DEBUG("Maximum request gap: %.0f s", _settings.maxRequestGap);
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Repicker::buildBindings() {
+	_bindings.clear();
+
+	auto module = configModule();
+	if ( !module ) {
+		return;
+	}
+
+	for ( size_t i = 0; i < module->configStationCount(); ++i ) {
+		auto configStation = module->configStation(i);
+		auto &binding = _bindings[configStation->networkCode() + "." + configStation->stationCode()];
+
+		if ( binding.config ) {
+			// The first enabled binding wins
+			continue;
+		}
+
+		if ( !configStation->enabled() ) {
+			binding.disabled = true;
+			continue;
+		}
+
+		binding.config = configStation;
+		binding.keys = new Util::KeyValues;
+
+		auto setup = findSetup(configStation, name(), true);
+		if ( setup ) {
+			binding.keys->init(ParameterSet::Find(setup->parameterSetID()));
+		}
+	}
+
+	SEISCOMP_DEBUG("Resolved bindings of %lu stations",
+	               static_cast<unsigned long>(_bindings.size()));
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Repicker::prepareJob(Job &job) {
+	Pick *pick = job.pick;
+	const auto &wid = pick->waveformID();
+
+	Util::KeyValuesPtr keys;
+
+	auto it = _bindings.find(wid.networkCode() + "." + wid.stationCode());
+	if ( it != _bindings.end() ) {
+		if ( !it->second.config ) {
+			SEISCOMP_WARNING("%s.%s: station setup is disabled, ignoring pick %s",
+			                 wid.networkCode(), wid.stationCode(),
+			                 pick->publicID());
+			return false;
+		}
+
+		keys = it->second.keys;
+	}
+
+	if ( !keys ) {
+		keys = new Util::KeyValues;
+	}
+
+	Processing::Settings procSettings(
+		configModuleName(),
+		wid.networkCode(), wid.stationCode(),
+		wid.locationCode(), wid.channelCode(),
+		&configuration(), keys.get()
+	);
+
+	auto loc = Client::Inventory::Instance()->getSensorLocation(pick);
+	if ( !loc ) {
+		SEISCOMP_WARNING("%s: no sensor location found in inventory: %s.%s.%s",
+		                 pick->publicID(), wid.networkCode(),
+		                 wid.stationCode(), wid.locationCode());
+		return false;
+	}
+
+	ThreeComponents tc;
+	getThreeComponents(tc, loc,
+	                   wid.channelCode().substr(0, 2).c_str(),
+	                   pick->time().value());
+
+	job.picker = Processing::PickerFactory::Create(_settings.pickerInterface);
+	if ( !job.picker ) {
+		SEISCOMP_WARNING("%s: failed to create picker '%s'",
+		                 pick->publicID(), _settings.pickerInterface);
+		return false;
+	}
+
+	job.picker->setTrigger(pick->time().value());
+
+	for ( size_t i = 0; i < 3; ++i ) {
+		if ( tc.comps[i] ) {
+			job.picker->streamConfig(static_cast<Processing::WaveformProcessor::Component>(i)).init(
+				wid.networkCode(), wid.stationCode(),
+				wid.locationCode(), tc.comps[i]->code(),
+				pick->time().value()
+			);
+		}
+	}
+
+	if ( !job.picker->setup(procSettings) ) {
+		SEISCOMP_WARNING("%s: picker failed to initialize: %s (%f)",
+		                 pick->publicID(),
+		                 job.picker->status().toString(),
+		                 job.picker->statusValue());
+		return false;
+	}
+
+	Job *target = &job;
+	job.picker->setPublishFunction([target](const Processing::Picker *, const Processing::Picker::Result &r) {
+		target->result = r;
+		target->gotPick = true;
+	});
+
+	job.picker->computeTimeWindow();
+
+	if ( job.picker->isFinished() ) {
+		SEISCOMP_WARNING("%s: picker finished already: %s (%f)",
+		                 pick->publicID(),
+		                 job.picker->status().toString(),
+		                 job.picker->statusValue());
+		return false;
+	}
+
+	job.timeWindow = job.picker->timeWindow();
+
+	switch ( job.picker->dataComponents() ) {
+		case Processing::WaveformProcessor::Vertical:
+		case Processing::WaveformProcessor::FirstHorizontal:
+		case Processing::WaveformProcessor::SecondHorizontal:
+			// Add stream as indicated in the pick stream
+			job.channels.push_back(wid.channelCode());
+			break;
+		case Processing::WaveformProcessor::Horizontal:
+			// Use both horizontals
+			if ( !tc.comps[Processing::WaveformProcessor::FirstHorizontalComponent] ||
+			     !tc.comps[Processing::WaveformProcessor::SecondHorizontalComponent] ) {
+				SEISCOMP_WARNING("%s: picker failed to initialize: meta data not found for two horizontals: %s.%s.%s.%s",
+				                 pick->publicID(),
+				                 wid.networkCode(), wid.stationCode(),
+				                 wid.locationCode(), wid.channelCode().substr(0, 2));
+				return false;
+			}
+			job.channels.push_back(tc.comps[Processing::WaveformProcessor::FirstHorizontalComponent]->code());
+			job.channels.push_back(tc.comps[Processing::WaveformProcessor::SecondHorizontalComponent]->code());
+			break;
+		case Processing::WaveformProcessor::Any:
+			// Use all three components
+			if ( !tc.comps[Processing::WaveformProcessor::FirstHorizontalComponent] ||
+			     !tc.comps[Processing::WaveformProcessor::SecondHorizontalComponent] ||
+			     !tc.comps[Processing::WaveformProcessor::VerticalComponent] ) {
+				SEISCOMP_WARNING("%s: picker failed to initialize: meta data not found for three components: %s.%s.%s.%s",
+				                 pick->publicID(),
+				                 wid.networkCode(), wid.stationCode(),
+				                 wid.locationCode(), wid.channelCode().substr(0, 2));
+				return false;
+			}
+			job.channels.push_back(tc.comps[Processing::WaveformProcessor::FirstHorizontalComponent]->code());
+			job.channels.push_back(tc.comps[Processing::WaveformProcessor::SecondHorizontalComponent]->code());
+			job.channels.push_back(tc.comps[Processing::WaveformProcessor::VerticalComponent]->code());
+			break;
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Repicker::processBatch(Batch &batch) {
+	// Create the pickers of this batch only, they are released again
+	// below once their data has been fed
+	vector<Job*> jobs;
+	for ( auto job : batch.jobs ) {
+		if ( prepareJob(*job) ) {
+			job->prepared = true;
+			jobs.push_back(job);
+		}
+		else {
+			job->picker = nullptr;
+		}
+	}
+
+	if ( jobs.empty() ) {
+		return true;
+	}
+
+	auto rs = IO::RecordStream::Open(recordStreamURL().c_str());
+	if ( !rs ) {
+		SEISCOMP_ERROR("Failed to open recordstream: %s",
+		               recordStreamURL());
+		for ( auto job : jobs ) {
+			job->picker = nullptr;
+		}
+		return false;
+	}
+
+	// Request the data windows of all picks of the day per channel.
+	// Windows are only merged if they overlap or are less than the
+	// configured gap apart. A single span per channel would make remote
+	// sources deliver the whole day whereas local archives read the day
+	// file per request, see init.
+	map<string, vector<Core::TimeWindow>> windows;
+	for ( auto job : jobs ) {
+		for ( const auto &cha : job->channels ) {
+			windows[cha].push_back(job->timeWindow);
+		}
+	}
+
+	Core::TimeSpan maxGap(_settings.maxRequestGap);
+	size_t requests = 0;
+
+	for ( auto &item : windows ) {
+		auto &tws = item.second;
+		sort(tws.begin(), tws.end(),
+		     [](const Core::TimeWindow &a, const Core::TimeWindow &b) {
+			return a.startTime() < b.startTime();
+		});
+
+		Core::TimeWindow current = tws.front();
+		for ( size_t i = 1; i <= tws.size(); ++i ) {
+			if ( i < tws.size() && tws[i].startTime() <= current.endTime() + maxGap ) {
+				if ( tws[i].endTime() > current.endTime() ) {
+					current.setEndTime(tws[i].endTime());
+				}
+				continue;
+			}
+
+			rs->addStream(batch.networkCode, batch.stationCode,
+			              batch.locationCode, item.first,
+			              current.startTime(), current.endTime());
+			++requests;
+
+			if ( i < tws.size() ) {
+				current = tws[i];
+			}
+		}
+	}
+
+	Traces traces;
+	size_t recordCount = 0;
+
+	while ( true ) {
+		RecordPtr rec = rs->next();
+		if ( !rec ) {
+			break;
+		}
+
+		auto &trace = traces[rec->channelCode()];
+		Core::TimeSpan length = rec->endTime() - rec->startTime();
+		if ( length > trace.maxLength ) {
+			trace.maxLength = length;
+		}
+
+		trace.records.push_back(rec);
+		++recordCount;
+	}
+
+	rs->close();
+
+	for ( auto &item : traces ) {
+		auto &records = item.second.records;
+		stable_sort(records.begin(), records.end(),
+		            [](const RecordPtr &a, const RecordPtr &b) {
+			return a->startTime() < b->startTime();
+		});
+
+		// A record crossing the boundary of two requests is delivered
+		// twice
+		records.erase(
+			unique(records.begin(), records.end(),
+			       [](const RecordPtr &a, const RecordPtr &b) {
+				return a->startTime() == b->startTime()
+				    && a->endTime() == b->endTime();
+			}),
+			records.end()
+		);
+	}
+
+	SEISCOMP_DEBUG("%s.%s.%s: read %lu records with %lu requests for %lu picks",
+	               batch.networkCode, batch.stationCode, batch.locationCode,
+	               static_cast<unsigned long>(recordCount),
+	               static_cast<unsigned long>(requests),
+	               static_cast<unsigned long>(jobs.size()));
+
+	// Run all pickers of the batch from the in-memory traces
+	vector<Record*> records;
+	for ( auto job : jobs ) {
+		records.clear();
+		collectRecords(records, traces, job->channels, job->timeWindow);
+
+		for ( auto rec : records ) {
+			job->picker->feed(rec);
+			if ( job->picker->isFinished() ) {
+				break;
+			}
+		}
+
+		// Keep the outcome and release the picker along with its data
+		job->status = job->picker->status();
+		job->statusValue = job->picker->statusValue();
+		job->methodID = job->picker->methodID();
+		job->filterID = job->picker->filterID();
+		job->picker = nullptr;
+	}
+
 	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -151,6 +529,48 @@ bool Repicker::init() {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void Repicker::collectRecords(vector<Record*> &records, const Traces &traces,
+                              const vector<string> &channels,
+                              const Core::TimeWindow &tw) {
+	for ( const auto &cha : channels ) {
+		auto it = traces.find(cha);
+		if ( it == traces.end() ) {
+			continue;
+		}
+
+		const auto &trace = it->second.records;
+
+		// The records are sorted by start time only. A record overlapping
+		// the window cannot start earlier than the longest record length
+		// before the window start.
+		auto rit = lower_bound(
+			trace.begin(), trace.end(), tw.startTime() - it->second.maxLength,
+			[](const RecordPtr &rec, const Core::Time &t) {
+				return rec->startTime() < t;
+			}
+		);
+
+		for ( ; rit != trace.end() && (*rit)->startTime() < tw.endTime(); ++rit ) {
+			if ( (*rit)->endTime() > tw.startTime() ) {
+				records.push_back(rit->get());
+			}
+		}
+	}
+
+	if ( channels.size() > 1 ) {
+		// Interleave the components in time as a record stream would
+		stable_sort(records.begin(), records.end(),
+		            [](const Record *a, const Record *b) {
+			return a->startTime() < b->startTime();
+		});
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool Repicker::run() {
 	EventParametersPtr ep;
@@ -172,14 +592,20 @@ bool Repicker::run() {
 		return false;
 	}
 
+	buildBindings();
+
 	size_t processedPicks = 0;
 	size_t failedPicks = 0;
 
 	std::list<PickPtr> repickedPicks;
 
+	// The jobs are kept in input order to apply the results in that
+	// order. Reserve all slots upfront, batches hold pointers to them.
+	vector<Job> jobs;
+	jobs.reserve(ep->pickCount());
+
 	for ( size_t i = 0; i < ep->pickCount() && !isExitRequested(); ++i ) {
 		auto pick = ep->pick(i);
-		const auto &wid = pick->waveformID();
 
 		if ( !_settings.anyPhase ) {
 			try {
@@ -195,198 +621,94 @@ bool Repicker::run() {
 			}
 		}
 
-		_picker->reset();
-		_picker->setTrigger(pick->time().value());
-
-		bool setupDisabled = false;
-		ConfigStation *config = nullptr;
+		// The picker is created when the batch of the pick is processed
+		jobs.emplace_back();
+		jobs.back().pick = pick;
+	}
 
-		for ( size_t cs = 0; cs < configModule()->configStationCount(); ++cs ) {
-			auto configStation = configModule()->configStation(cs);
-			if ( configStation->networkCode() != wid.networkCode() ) {
-				continue;
-			}
+	// Picks of the same sensor location and day are processed together
+	map<string, Batch> batchMap;
+	for ( auto &job : jobs ) {
+		const auto &wid = job.pick->waveformID();
+		auto day = job.pick->time().value().seconds() / 86400;
+		auto &batch = batchMap[wid.networkCode() + "." + wid.stationCode() + "." +
+		                       wid.locationCode() + "." + to_string(day)];
+		if ( batch.jobs.empty() ) {
+			batch.networkCode = wid.networkCode();
+			batch.stationCode = wid.stationCode();
+			batch.locationCode = wid.locationCode();
+		}
+		batch.jobs.push_back(&job);
+	}
 
-			if ( configStation->stationCode() != wid.stationCode() ) {
-				continue;
-			}
+	vector<Batch*> batches;
+	batches.reserve(batchMap.size());
+	for ( auto &item : batchMap ) {
+		batches.push_back(&item.second);
+	}
 
-			if ( !configStation->enabled() ) {
-				setupDisabled = true;
-			}
-			else {
-				config = configStation;
+	std::atomic<size_t> nextBatch{0};
+	std::atomic<bool> failed{false};
+	auto work = [this, &batches, &nextBatch, &failed]() {
+		for ( size_t i = nextBatch++; i < batches.size(); i = nextBatch++ ) {
+			if ( failed || isExitRequested() ) {
 				break;
 			}
-		}
-
-		Util::KeyValues keys;
 
-		if ( !config ) {
-			if ( setupDisabled ) {
-				SEISCOMP_WARNING("%s.%s: station setup is disabled, ignoring pick %s",
-				                 wid.networkCode(), wid.stationCode(),
-				                 pick->publicID());
-				++failedPicks;
-				continue;
+			if ( !processBatch(*batches[i]) ) {
+				failed = true;
 			}
 		}
-		else {
-			auto setup = findSetup(config, name(), true);
-			if ( setup ) {
-				keys.init(ParameterSet::Find(setup->parameterSetID()));
-			}
-		}
-
-		Processing::Settings procSettings(
-			configModuleName(),
-			wid.networkCode(), wid.stationCode(),
-			wid.locationCode(), wid.channelCode(),
-			&configuration(), &keys
-		);
-
-		auto loc = Client::Inventory::Instance()->getSensorLocation(pick);
-		if ( !loc ) {
-			SEISCOMP_WARNING("%s: no sensor location found in inventory: %s.%s.%s",
-			                 pick->publicID(), wid.networkCode(),
-			                 wid.stationCode(), wid.locationCode());
-			++failedPicks;
-			continue;
-		}
+	};
 
-		ThreeComponents tc;
-		getThreeComponents(tc, loc,
-		                   wid.channelCode().substr(0, 2).c_str(),
-		                   pick->time().value());
-
-		for ( size_t i = 0; i < 3; ++i ) {
-			if ( tc.comps[i] ) {
-				_picker->streamConfig(static_cast<Processing::WaveformProcessor::Component>(i)).init(
-					wid.networkCode(), wid.stationCode(),
-					wid.locationCode(), tc.comps[i]->code(),
-					pick->time().value()
-				);
-			}
-		}
+	size_t threadCount = std::min(static_cast<size_t>(_settings.threads),
+	                              batches.size());
+	vector<thread> workers;
+	for ( size_t i = 1; i < threadCount; ++i ) {
+		workers.emplace_back(work);
+	}
 
-		if ( !_picker->setup(procSettings) ) {
-			SEISCOMP_WARNING("%s: picker failed to initialize: %s (%f)",
-			                 pick->publicID(),
-			                 _picker->status().toString(),
-			                 _picker->statusValue());
-			++failedPicks;
-			continue;
-		}
+	work();
 
-		Processing::Picker::Result pickResult;
-		bool gotPick = false;
+	for ( auto &worker : workers ) {
+		worker.join();
+	}
 
-		_picker->setPublishFunction([&pickResult, &gotPick](const Processing::Picker *, const Processing::Picker::Result &r) {
-			pickResult = r;
-			gotPick = true;
-		});
+	SEISCOMP_DEBUG("Processed %lu picks in %lu batches with %lu threads",
+	               static_cast<unsigned long>(jobs.size()),
+	               static_cast<unsigned long>(batches.size()),
+	               static_cast<unsigned long>(std::max(threadCount, size_t(1))));
 
-		_picker->computeTimeWindow();
+	if ( failed ) {
+		return false;
+	}
 
-		if ( _picker->isFinished() ) {
-			SEISCOMP_WARNING("%s: picker finished already: %s (%f)",
-			                 pick->publicID(),
-			                 _picker->status().toString(),
-			                 _picker->statusValue());
-			++failedPicks;
-			continue;
-		}
+	if ( isExitRequested() ) {
+		cerr << "Aborted processing" << endl;
+		return false;
+	}
 
-		auto rs = IO::RecordStream::Open(recordStreamURL().c_str());
-		if ( !rs ) {
-			SEISCOMP_ERROR("Failed to open recordstream: %s",
-			               recordStreamURL());
-			return false;
-		}
+	for ( auto &job : jobs ) {
+		auto pick = job.pick;
 
-		if ( !rs->setTimeWindow(_picker->timeWindow()) ) {
-			SEISCOMP_WARNING("%s: picker failed to set data time window",
-			                 pick->publicID());
+		if ( !job.prepared ) {
+			// Reported by prepareJob already
 			++failedPicks;
 			continue;
 		}
 
-		switch ( _picker->dataComponents() ) {
-			case Processing::WaveformProcessor::Vertical:
-			case Processing::WaveformProcessor::FirstHorizontal:
-			case Processing::WaveformProcessor::SecondHorizontal:
-				// Add stream as indicated in the pick stream
-				rs->addStream(wid.networkCode(), wid.stationCode(),
-				              wid.locationCode(), wid.channelCode());
-				break;
-			case Processing::WaveformProcessor::Horizontal:
-				// Use both horizontals
-				if ( !tc.comps[Processing::WaveformProcessor::FirstHorizontalComponent] ||
-				     !tc.comps[Processing::WaveformProcessor::SecondHorizontalComponent] ) {
-					SEISCOMP_WARNING("%s: picker failed to initialize: meta data not found for two horizontals: %s.%s.%s.%s",
-					                 pick->publicID(),
-					                 _picker->status().toString(),
-					                 _picker->statusValue(),
-					                 wid.networkCode(), wid.stationCode(),
-					                 wid.locationCode(), wid.channelCode().substr(0, 2));
-					++failedPicks;
-					continue;
-				}
-				rs->addStream(wid.networkCode(),
-				              wid.stationCode(),
-				              wid.locationCode(),
-				              tc.comps[Processing::WaveformProcessor::FirstHorizontalComponent]->code());
-				rs->addStream(wid.networkCode(),
-				              wid.stationCode(),
-				              wid.locationCode(),
-				              tc.comps[Processing::WaveformProcessor::SecondHorizontalComponent]->code());
-				break;
-			case Processing::WaveformProcessor::Any:
-				// Use all three components
-				if ( !tc.comps[Processing::WaveformProcessor::FirstHorizontalComponent] ||
-				     !tc.comps[Processing::WaveformProcessor::SecondHorizontalComponent] ||
-				     !tc.comps[Processing::WaveformProcessor::VerticalComponent] ) {
-					SEISCOMP_WARNING("%s: picker failed to initialize: meta data not found for three components",
-					                 pick->publicID(),
-					                 _picker->status().toString(),
-					                 _picker->statusValue(),
-					                 wid.networkCode(), wid.stationCode(),
-					                 wid.locationCode(), wid.channelCode().substr(0, 2));
-					++failedPicks;
-					continue;
-				}
-				rs->addStream(wid.networkCode(),
-				              wid.stationCode(),
-				              wid.locationCode(),
-				              tc.comps[Processing::WaveformProcessor::FirstHorizontalComponent]->code());
-				rs->addStream(wid.networkCode(),
-				              wid.stationCode(),
-				              wid.locationCode(),
-				              tc.comps[Processing::WaveformProcessor::SecondHorizontalComponent]->code());
-				rs->addStream(wid.networkCode(),
-				              wid.stationCode(),
-				              wid.locationCode(),
-				              tc.comps[Processing::WaveformProcessor::VerticalComponent]->code());
-				break;
-		}
-
-		while ( auto rec = rs->next() ) {
-			_picker->feed(rec);
-			if ( _picker->isFinished() ) {
-				break;
-			}
-		}
-
-		if ( _picker->status() != Processing::WaveformProcessor::Finished ) {
+		if ( job.status != Processing::WaveformProcessor::Finished ) {
 			SEISCOMP_WARNING("%s: picker did not finish: %s (%f)",
 			                 pick->publicID(),
-			                 _picker->status().toString(),
-			                 _picker->statusValue());
+			                 job.status.toString(),
+			                 job.statusValue);
 			++failedPicks;
 			continue;
 		}
 
-		if ( gotPick ) {
+		if ( job.gotPick ) {
+			const auto &pickResult = job.result;
+
 			TimeQuantity time;
 			time.setValue(pickResult.time);
 
@@ -398,8 +720,8 @@ bool Repicker::run() {
 			}
 
 			pick->setTime(time);
-			pick->setMethodID(_picker->methodID());
-			pick->setFilterID(_picker->filterID());
+			pick->setMethodID(job.methodID);
+			pick->setFilterID(job.filterID);
 
 			if ( pickResult.slowness ) {
 				pick->setHorizontalSlowness(RealQuantity(*pickResult.slowness));
@@ -429,11 +751,6 @@ bool Repicker::run() {
 		++processedPicks;
 	}
 
-	if ( isExitRequested() ) {
-		cerr << "Aborted processing" << endl;
-		return false;
-	}
-
 	cerr << "Processed picks: " << processedPicks << endl;
 	cerr << "Failed picks: " << failedPicks << endl;
 	cerr << "Repicked picks: " << repickedPicks.size() << endl;
@@ -13,7 +13,16 @@
 
 
 #include <seiscomp/client/application.h>
+#include <seiscomp/core/record.h>
+#include <seiscomp/datamodel/configstation.h>
+#include <seiscomp/datamodel/pick.h>
 #include <seiscomp/processing/picker.h>
+#include <seiscomp/utils/keyvalues.h>
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 
 namespace Seiscomp {
@@ -48,12 +57,71 @@ class Repicker : public Client::Application {
 			std::string epFile;
 			bool        formatted{false};
 			bool        repickedOnly{false};
+			int         threads{1};
+			double      maxRequestGap{-1};
 
 			void accept(SettingsLinker &linker) override;
 		};
 
+		//! The enabled binding of a station along with its parsed
+		//! parameters.
+		struct Binding {
+			DataModel::ConfigStation *config{nullptr};
+			Util::KeyValuesPtr        keys;
+			bool                      disabled{false};
+		};
+
+		//! A pick to be repicked with its own picker instance. The picker
+		//! only exists while the batch of the job is processed.
+		struct Job {
+			DataModel::Pick            *pick{nullptr};
+			Processing::PickerPtr       picker;
+			std::vector<std::string>    channels;
+			Core::TimeWindow            timeWindow;
+			bool                        prepared{false};
+
+			// Outcome, the picker is released after processing
+			Processing::WaveformProcessor::Status status;
+			double                      statusValue{0};
+			std::string                 methodID;
+			std::string                 filterID;
+			Processing::Picker::Result  result;
+			bool                        gotPick{false};
+		};
+
+		//! All jobs of a sensor location and day. Their data is requested
+		//! with one record stream and kept in memory while the jobs are
+		//! processed.
+		struct Batch {
+			std::string       networkCode;
+			std::string       stationCode;
+			std::string       locationCode;
+			std::vector<Job*> jobs;
+		};
+
+		typedef std::unordered_map<std::string, Binding> Bindings;
+
+		//! The records of a channel sorted by start time
+		struct Trace {
+			std::vector<RecordPtr> records;
+			//! The longest record duration, bounds the search for the
+			//! records overlapping a time window
+			Core::TimeSpan         maxLength;
+		};
+
+		typedef std::map<std::string, Trace> Traces;
+
+		void buildBindings();
+		bool prepareJob(Job &job);
+		bool processBatch(Batch &batch);
+		void collectRecords(std::vector<Record*> &records, const Traces &traces,
+		                    const std::vector<std::string> &channels,
+		                    const Core::TimeWindow &tw);
+
+
+	private:
 		Settings              _settings;
-		Processing::PickerPtr _picker;
+		Bindings              _bindings;
 };
 
 
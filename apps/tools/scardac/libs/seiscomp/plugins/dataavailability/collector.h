@@ -39,8 +39,14 @@
  2
    - Add setStartTime() and setEndTime() methods
 
+ 3
+   - Add setIndexEnabled() method
+
+ 4
+   - Add chunkWaveformID() method
+
  */
-#define SCARDAC_API_VERSION 2
+#define SCARDAC_API_VERSION 4
 
 
 namespace Seiscomp {
@@ -137,6 +143,16 @@ class SC_DAPLUGIN_API Collector : public Core::InterruptibleObject {
 		 */
 		virtual void setEndTime(Core::Time endTime);
 
+		/**
+		 * @brief Enable persistent per-chunk indexes of record meta data.
+		 *        If supported by the implementation, an index is written
+		 *        once a chunk has been read entirely and is used instead of
+		 *        the chunk as long as the chunk is unmodified.
+		 * @param enable Whether or not to use chunk indexes.
+		 * @since SCARDAC API 3
+		 */
+		virtual void setIndexEnabled(bool enable);
+
 		/**
 		 * @brief Reset all internal buffers and states except for the source.
 		 */
@@ -180,6 +196,20 @@ class SC_DAPLUGIN_API Collector : public Core::InterruptibleObject {
 		 */
 		virtual Core::Time chunkMTime(const std::string &chunk);
 
+		/**
+		 * @brief Return the waveform ID a data chunk contains data for. This
+		 *        is used to map externally detected chunk modifications,
+		 *        e.g., file system notifications, to extents.
+		 * @param wid The waveform ID of the chunk.
+		 * @param chunk The chunk ID as returned by collectChunks().
+		 * @return False if the chunk ID is invalid, outside the configured
+		 *         time window or if the implementation does not support
+		 *         the mapping.
+		 * @since SCARDAC API 4
+		 */
+		virtual bool chunkWaveformID(DataModel::WaveformStreamID &wid,
+		                             const std::string &chunk);
+
 
 		/**
 		 * @brief Open a data chunk for record-based iteration.
@@ -245,6 +275,7 @@ class SC_DAPLUGIN_API Collector : public Core::InterruptibleObject {
 
 		OPT(Core::Time) _startTime;
 		OPT(Core::Time) _endTime;
+		bool            _indexEnabled{false};
 };
 
 
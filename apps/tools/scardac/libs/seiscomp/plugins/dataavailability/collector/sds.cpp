@@ -24,6 +24,8 @@
 #include <seiscomp/logging/log.h>
 #include <seiscomp/system/environment.h>
 
+#include <fstream>
+#include <iomanip>
 #include <utility>
 #include <vector>
 
@@ -34,6 +36,47 @@ namespace fs = boost::filesystem;
 namespace Seiscomp::DataAvailability {
 
 REGISTER_DATAAVAILABILITY_COLLECTOR(SDSCollector, "sds");
+
+namespace {
+
+const char *IndexMagic = "#scardac-index";
+const int IndexVersion = 1;
+
+bool fileState(size_t &size, Core::Time &mtime, const string &file) {
+	boost::system::error_code ec;
+	auto fileSize = fs::file_size(SC_FS_PATH(file), ec);
+	if ( ec ) {
+		return false;
+	}
+
+	std::time_t fileMTime = fs::last_write_time(SC_FS_PATH(file), ec);
+	if ( ec || fileMTime < 0 ) {
+		return false;
+	}
+
+	size = static_cast<size_t>(fileSize);
+	mtime = fileMTime;
+	return true;
+}
+
+void writeTime(ostream &os, const Core::Time &time) {
+	os << time.epochSeconds() << '.'
+	   << setfill('0') << setw(6) << time.microseconds();
+}
+
+bool readTime(istream &is, Core::Time &time) {
+	int64_t secs;
+	int usecs;
+	char sep;
+	if ( !(is >> secs >> sep >> usecs) || sep != '.' ) {
+		return false;
+	}
+
+	time = Core::Time(secs, usecs);
+	return true;
+}
+
+} // ns anonymous
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
 
@@ -41,9 +84,16 @@ REGISTER_DATAAVAILABILITY_COLLECTOR(SDSCollector, "sds");
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 SDSCollector::RecordIterator::RecordIterator(string file,
-                                             const DataModel::WaveformStreamID &wid)
+                                             const DataModel::WaveformStreamID &wid,
+                                             bool writeIndex)
 : _file(std::move(file)), _sid(streamID(wid)),
-  _input(&_stream, Array::DOUBLE, Record::DATA_ONLY) {
+  _input(&_stream, Array::DOUBLE, Record::META_ONLY), _writeIndex(writeIndex) {
+	// The index is tagged with the file state before reading so that
+	// concurrent modifications invalidate it
+	if ( _writeIndex && !fileState(_fileSize, _fileMTime, _file) ) {
+		_writeIndex = false;
+	}
+
 	if ( !_stream.setSource(_file) ) {
 		throw CollectorException("could not open record file");
 	}
@@ -71,6 +121,15 @@ bool SDSCollector::RecordIterator::next() {
 		_rec = _input.next();
 
 		if ( !valid() ) {
+			if ( _writeIndex ) {
+				size_t size;
+				Core::Time mtime;
+				if ( fileState(size, mtime, _file) && size == _fileSize &&
+				     mtime == _fileMTime ) {
+					WriteIndex(_index, _file, _sid, _fileSize, _fileMTime);
+				}
+				_writeIndex = false;
+			}
 			return false;
 		}
 
@@ -96,10 +155,17 @@ bool SDSCollector::RecordIterator::next() {
 			_quality = "";
 		}
 
+		if ( _writeIndex ) {
+			_index.push_back({_offset, _rec->startTime(), _endTime,
+			                  _rec->samplingFrequency(), _quality});
+			_offset = _stream.tell();
+		}
+
 		return true;
 	}
 
-	// only reached if abort was requested
+	// only reached if abort was requested, the index remains incomplete
+	_writeIndex = false;
 	return false;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -143,6 +209,74 @@ const std::string& SDSCollector::RecordIterator::quality() const {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+SDSCollector::IndexIterator::IndexIterator(Index index)
+: _index(std::move(index)) {}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SDSCollector::IndexIterator::valid() const {
+	return _next > 0 && _next <= _index.size();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SDSCollector::IndexIterator::next() {
+	if ( _abortRequested || _next >= _index.size() ) {
+		_next = _index.size() + 1;
+		return false;
+	}
+
+	++_next;
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const Core::Time& SDSCollector::IndexIterator::startTime() const {
+	return _index[_next-1].startTime;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const Core::Time& SDSCollector::IndexIterator::endTime() const {
+	return _index[_next-1].endTime;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+double SDSCollector::IndexIterator::sampleRate() const {
+	return _index[_next-1].sampleRate;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+const std::string& SDSCollector::IndexIterator::quality() const {
+	return _index[_next-1].quality;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 bool SDSCollector::setSource(const char *source) {
 	if ( !Collector::setSource(source) ) {
@@ -364,11 +498,35 @@ Core::Time SDSCollector::chunkMTime(const std::string &chunk) {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SDSCollector::chunkWaveformID(DataModel::WaveformStreamID &wid,
+                                   const std::string &chunk) {
+	auto idDate = fileStreamID(SC_FS_FILE_NAME(SC_FS_PATH(chunk)));
+	if ( idDate.streamID.empty() ||
+	     !checkTimeWindow(idDate.year, idDate.doy) ) {
+		return false;
+	}
+
+	return wfID(wid, idDate.streamID);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 Collector::RecordIterator*
 SDSCollector::begin(const std::string &chunk,
                     const DataModel::WaveformStreamID &wid) {
-	return new RecordIterator((_basePath / SC_FS_PATH(chunk)).string(), wid);
+	auto file = (_basePath / SC_FS_PATH(chunk)).string();
+	if ( _indexEnabled ) {
+		Index index;
+		if ( ReadIndex(index, file, streamID(wid)) ) {
+			return new IndexIterator(std::move(index));
+		}
+	}
+
+	return new RecordIterator(file, wid, _indexEnabled);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -384,6 +542,156 @@ bool SDSCollector::threadSafe() const {
 
 
 
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+std::string SDSCollector::IndexFile(const std::string &file) {
+	// The suffix prevents the index from matching the SDS file name pattern
+	return file + ".idx";
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SDSCollector::ReadIndex(Index &index, const std::string &file,
+                             const std::string &sid) {
+	index.clear();
+
+	auto indexFile = IndexFile(file);
+	ifstream ifs(indexFile);
+	if ( !ifs.is_open() ) {
+		return false;
+	}
+
+	size_t size;
+	Core::Time mtime;
+	if ( !fileState(size, mtime, file) ) {
+		return false;
+	}
+
+	string magic;
+	int version;
+	string indexSID;
+	size_t indexSize;
+	int64_t indexMTime;
+	if ( !(ifs >> magic >> version >> indexSID >> indexSize >> indexMTime) ||
+	     magic != IndexMagic || version != IndexVersion ) {
+		SEISCOMP_WARNING("Invalid index file: %s", indexFile);
+		return false;
+	}
+
+	if ( indexSID != sid || indexSize != size ||
+	     Core::Time(indexMTime, 0) != mtime ) {
+		SEISCOMP_DEBUG("Outdated index file: %s", indexFile);
+		return false;
+	}
+
+	IndexEntry entry;
+	while ( ifs >> entry.offset ) {
+		if ( !readTime(ifs, entry.startTime) ||
+		     !readTime(ifs, entry.endTime) ||
+		     !(ifs >> entry.sampleRate >> entry.quality) ) {
+			SEISCOMP_WARNING("Invalid entry #%zu in index file: %s",
+			                 index.size() + 1, indexFile);
+			index.clear();
+			return false;
+		}
+
+		if ( entry.quality == "-" ) {
+			entry.quality.clear();
+		}
+
+		index.push_back(entry);
+	}
+
+	if ( !ifs.eof() ) {
+		SEISCOMP_WARNING("Invalid entry #%zu in index file: %s",
+		                 index.size() + 1, indexFile);
+		index.clear();
+		return false;
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SDSCollector::WriteIndex(const Index &index, const std::string &file,
+                              const std::string &sid, size_t size,
+                              const Core::Time &mtime) {
+	auto indexFile = IndexFile(file);
+	auto tmpFile = indexFile + ".tmp";
+
+	// Write to a temporary file first and rename it afterwards so that
+	// concurrent readers never see a partial index
+	{
+		ofstream ofs(tmpFile, ios::out | ios::trunc);
+		if ( !ofs.is_open() ) {
+			SEISCOMP_DEBUG("Could not create index file: %s", tmpFile);
+			return false;
+		}
+
+		ofs << IndexMagic << ' ' << IndexVersion << ' ' << sid << ' '
+		    << size << ' ' << mtime.epochSeconds() << '\n'
+		    << setprecision(17);
+
+		for ( const auto &entry : index ) {
+			ofs << entry.offset << ' ';
+			writeTime(ofs, entry.startTime);
+			ofs << ' ';
+			writeTime(ofs, entry.endTime);
+			ofs << ' ' << entry.sampleRate << ' '
+			    << (entry.quality.empty() ? string("-") : entry.quality)
+			    << '\n';
+		}
+
+		ofs.close();
+		if ( !ofs ) {
+			SEISCOMP_WARNING("Could not write index file: %s", tmpFile);
+			boost::system::error_code ec;
+			fs::remove(SC_FS_PATH(tmpFile), ec);
+			return false;
+		}
+	}
+
+	boost::system::error_code ec;
+	fs::rename(SC_FS_PATH(tmpFile), SC_FS_PATH(indexFile), ec);
+	if ( ec ) {
+		SEISCOMP_WARNING("Could not rename index file %s: %s", tmpFile,
+		                 ec.message());
+		fs::remove(SC_FS_PATH(tmpFile), ec);
+		return false;
+	}
+
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SDSCollector::SeekOffset(size_t &offset, const Index &index,
+                              const Core::Time &time) {
+	// File positions increase with the entries, the first record ending
+	// after time therefore yields the smallest position
+	for ( const auto &entry : index ) {
+		if ( entry.endTime > time ) {
+			offset = entry.offset;
+			return true;
+		}
+	}
+
+	return false;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
 void SDSCollector::scanDirectory(WaveformIDs &wids, const fs::path &dir,
                                  uint16_t depth) {
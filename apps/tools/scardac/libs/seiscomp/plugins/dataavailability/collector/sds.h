@@ -42,15 +42,34 @@ DEFINE_SMARTPOINTER(SDSCollector);
 class SDSCollector : public Collector {
 
 	public:
+		/**
+		 * @brief Record meta data stored in the index sidecar file of a
+		 * record file.
+		 */
+		struct IndexEntry {
+			//! File position from which the record is the next one read for
+			//! the indexed stream
+			size_t      offset{0};
+			Core::Time  startTime;
+			Core::Time  endTime;
+			double      sampleRate{0};
+			std::string quality;
+		};
+
+		using Index = std::vector<IndexEntry>;
+
 		class RecordIterator : public Collector::RecordIterator {
 			public:
 				/**
 				 * @brief RecordIterator
 				 * @param file The absolute file path
 				 * @param wid StreamID the file is expected to contain data for
+				 * @param writeIndex If enabled the index sidecar file is
+				 * written once all records have been read
 				 */
 				RecordIterator(std::string file,
-				               const DataModel::WaveformStreamID &wid);
+				               const DataModel::WaveformStreamID &wid,
+				               bool writeIndex = false);
 
 			public:
 				~RecordIterator() override = default;
@@ -71,6 +90,35 @@ class SDSCollector : public Collector {
 				RecordPtr           _rec;
 				Core::Time          _endTime;
 				std::string         _quality;
+
+				bool                _writeIndex;
+				Index               _index;
+				size_t              _offset{0};
+				size_t              _fileSize{0};
+				Core::Time          _fileMTime;
+		};
+
+		/**
+		 * @brief Iterates over the records of an index sidecar file without
+		 * opening the record file.
+		 */
+		class IndexIterator : public Collector::RecordIterator {
+			public:
+				explicit IndexIterator(Index index);
+
+			public:
+				~IndexIterator() override = default;
+
+				bool valid() const override;
+				bool next() override;
+				const Core::Time& startTime() const override;
+				const Core::Time& endTime() const override;
+				double sampleRate() const override;
+				const std::string& quality() const override;
+
+			protected:
+				Index               _index;
+				size_t              _next{0};
 		};
 
 
@@ -89,11 +137,56 @@ class SDSCollector : public Collector {
 		bool chunkTimeWindow(Core::TimeWindow &window,
 		                     const std::string &chunk) override;
 		Core::Time chunkMTime(const std::string &chunk) override;
+		bool chunkWaveformID(DataModel::WaveformStreamID &wid,
+		                     const std::string &chunk) override;
 		Collector::RecordIterator* begin(
 		        const std::string &chunk,
 		        const DataModel::WaveformStreamID &wid) override;
 		bool threadSafe() const override;
 
+	public:
+		/**
+		 * @brief Return the path of the index sidecar file of a record file.
+		 * @param file The record file path.
+		 */
+		static std::string IndexFile(const std::string &file);
+
+		/**
+		 * @brief Read the index sidecar file of a record file.
+		 * @param index The index entries in file order.
+		 * @param file The record file path.
+		 * @param sid The stream ID the index is expected to be written for.
+		 * @return True if the index exists and its size and modification
+		 * time match the current state of the record file.
+		 */
+		static bool ReadIndex(Index &index, const std::string &file,
+		                      const std::string &sid);
+
+		/**
+		 * @brief Atomically write the index sidecar file of a record file.
+		 * @param index The index entries in file order.
+		 * @param file The record file path.
+		 * @param sid The stream ID of the indexed records.
+		 * @param size The record file size the index was created from.
+		 * @param mtime The record file modification time the index was
+		 * created from.
+		 * @return Status flag.
+		 */
+		static bool WriteIndex(const Index &index, const std::string &file,
+		                       const std::string &sid, size_t size,
+		                       const Core::Time &mtime);
+
+		/**
+		 * @brief Find the file position from which all records ending after
+		 * a specific time are read.
+		 * @param offset The file position.
+		 * @param index The index entries in file order.
+		 * @param time The time to seek to.
+		 * @return False if no indexed record ends after time.
+		 */
+		static bool SeekOffset(size_t &offset, const Index &index,
+		                       const Core::Time &time);
+
 	protected:
 		struct IDDate {
 			std::string streamID;
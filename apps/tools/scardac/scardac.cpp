@@ -15,6 +15,7 @@
 #define SEISCOMP_COMPONENT SCARDAC
 
 #include "scardac.h"
+#include "watcher.h"
 
 #include <ctime>
 #include <vector>
@@ -27,6 +28,7 @@
 #include <seiscomp/io/database.h>
 #include <seiscomp/logging/log.h>
 #include <seiscomp/plugins/dataavailability/utils.hpp>
+#include <seiscomp/system/environment.h>
 
 #define _T(name) _db->driver()->convertColumnName(name)
 
@@ -207,7 +209,8 @@ inline DataModel::DataSegmentPtr cloneSegment(const DataModel::DataSegment *src)
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-void Worker::processExtent(DataExtent *extent, bool foundInDB) {
+void Worker::processExtent(DataExtent *extent, bool foundInDB,
+                           const ChunkSet &changedChunks) {
 	if ( !extent ) {
 		return;
 	}
@@ -356,6 +359,10 @@ void Worker::processExtent(DataExtent *extent, bool foundInDB) {
 			p.read = true;
 			p.reason = "new extent";
 		}
+		else if ( changedChunks.find(chunkPath) != changedChunks.end() ) {
+			p.read = true;
+			p.reason = "change notification";
+		}
 		else if ( _app->_deepScan ) {
 			p.read = true;
 			p.reason = "deep scan";
@@ -563,8 +570,58 @@ void Worker::processExtent(DataExtent *extent, bool foundInDB) {
 		}
 	};
 
+	// READ chunks are read in blocks of consecutive chunks. With chunk
+	// threads configured the chunks of a block are read concurrently, each
+	// producing its own segment list. The lists are merged in chunk order
+	// below, joining segments across chunk boundaries within the jitter.
+	struct ChunkRead {
+		Segments segments;
+		bool     ok{false};
+	};
+
+	size_t chunkThreads = _collector->threadSafe()
+	                    ? static_cast<size_t>(_app->_chunkThreads) : 1;
+	size_t blockSize = chunkThreads > 1 ? chunkThreads * 16 : 1;
+	std::vector<ChunkRead> reads;
+	size_t readsStart = 0;
+
+	auto readBlock = [&](size_t from) {
+		size_t to = std::min(plan.size(), from + blockSize);
+		reads.clear();
+		reads.resize(to - from);
+		readsStart = from;
+
+		size_t readChunks = 0;
+		for ( size_t i = from; i < to; ++i ) {
+			if ( plan[i].read ) {
+				++readChunks;
+			}
+		}
+
+		std::atomic<size_t> next{from};
+		auto reader = [&]() {
+			for ( size_t i = next++; i < to && !_app->_exitRequested; i = next++ ) {
+				if ( plan[i].read ) {
+					auto &r = reads[i - from];
+					r.ok = readChunkSegments(r.segments, plan[i].path,
+					                         plan[i].mtime, plan[i].window);
+				}
+			}
+		};
+
+		std::vector<std::thread> helpers;
+		for ( size_t i = 1; i < std::min(chunkThreads, readChunks); ++i ) {
+			helpers.emplace_back(reader);
+		}
+		reader();
+		for ( auto &helper : helpers ) {
+			helper.join();
+		}
+	};
+
 	std::vector<size_t> dbHits;
-	for ( const auto &p : plan ) {
+	for ( size_t iPlan = 0; iPlan < plan.size(); ++iPlan ) {
+		const auto &p = plan[iPlan];
 		if ( _app->_exitRequested ) {
 			return;
 		}
@@ -583,8 +640,12 @@ void Worker::processExtent(DataExtent *extent, bool foundInDB) {
 			SEISCOMP_DEBUG("[%i] %s: %s %s (%s, mtime %s)",
 			               _id, _sid, "READ", p.path, p.reason, p.mtime.iso());
 
-			Segments chunkSegs;
-			if ( !readChunkSegments(chunkSegs, p.path, p.mtime, p.window) ) {
+			if ( iPlan < readsStart || iPlan >= readsStart + reads.size() ) {
+				readBlock(iPlan);
+			}
+
+			auto &chunkRead = reads[iPlan - readsStart];
+			if ( !chunkRead.ok ) {
 				// read failed - fall back to existing DB segments to avoid
 				// silent data loss
 				SEISCOMP_WARNING("[%i] %s: Falling back to DB segments for "
@@ -597,7 +658,7 @@ void Worker::processExtent(DataExtent *extent, bool foundInDB) {
 				continue;
 			}
 
-			for ( auto &s : chunkSegs ) {
+			for ( auto &s : chunkRead.segments ) {
 				appendSegment(s);
 			}
 		}
@@ -1058,6 +1119,41 @@ bool Worker::syncSegments() {
 		return false;
 	}
 
+	if ( _segmentsInsert.empty() && _segmentsUpdate.empty() &&
+	     _segmentsRemove.empty() ) {
+		return true;
+	}
+
+	// Write all segment changes of the extent in one transaction. Committing
+	// each statement individually dominates the runtime of larger scans.
+	auto *db = _db->driver();
+	if ( db->beginTransaction() ) {
+		if ( writeSegments(true) && db->commit() ) {
+			return true;
+		}
+
+		db->rollback();
+
+		if ( _app->_exitRequested ) {
+			return false;
+		}
+
+		// Some backends abort the whole transaction on the first failing
+		// statement, retry without transaction to write as many segments
+		// as possible
+		SEISCOMP_WARNING("[%i] %s: Segment transaction failed, synchronizing "
+		                 "segments one by one", _id, _sid);
+	}
+
+	return writeSegments(false);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool Worker::writeSegments(bool abortOnError) {
 	// Order matters: remove before insert frees any (start_time, parent)
 	// uniqueness constraint that an inserted segment might collide with;
 	// update lives between because it neither frees nor allocates rows.
@@ -1076,6 +1172,9 @@ bool Worker::syncSegments() {
 		else {
 			SEISCOMP_ERROR("[%i] %s: Failed to remove segment [%s~%s]", _id, _sid,
 			               segment->start().iso(), segment->end().iso());
+			if ( abortOnError ) {
+				return false;
+			}
 		}
 	}
 
@@ -1093,6 +1192,9 @@ bool Worker::syncSegments() {
 		else {
 			SEISCOMP_ERROR("[%i] %s: Failed to update segment [%s~%s]", _id, _sid,
 			               segment->start().iso(), segment->end().iso());
+			if ( abortOnError ) {
+				return false;
+			}
 		}
 	}
 
@@ -1110,6 +1212,9 @@ bool Worker::syncSegments() {
 		else {
 			SEISCOMP_ERROR("[%i] %s: Failed to add segment [%s~%s]", _id, _sid,
 			               segment->start().iso(), segment->end().iso());
+			if ( abortOnError ) {
+				return false;
+			}
 		}
 	}
 
@@ -1353,6 +1458,10 @@ void SCARDAC::createCommandLineDescription() {
 	                        "Number of threads scanning the archive in "
 	                        "parallel.",
 	                        &_threads);
+	commandline().addOption("Collector", "chunk-threads",
+	                        "Number of threads reading the data chunks of a "
+	                        "single stream in parallel.",
+	                        &_chunkThreads);
 	commandline().addOption("Collector", "jitter",
 	                        "Acceptable derivation of end time and start time "
 	                        "of successive records in multiples of sample "
@@ -1389,6 +1498,10 @@ void SCARDAC::createCommandLineDescription() {
 	commandline().addOption("Collector", "deep-scan",
 	                        "Process all data chunks independent of their "
 	                        "modification time.");
+	commandline().addOption("Collector", "index",
+	                        "Write an index file next to each data chunk read "
+	                        "and read the index instead of the chunk as long "
+	                        "as the chunk is unmodified.");
 	commandline().addOption("Collector", "modified-since",
 	                        "Only read chunks modified after specific date "
 	                        "given as date string or as number of days before "
@@ -1400,6 +1513,10 @@ void SCARDAC::createCommandLineDescription() {
 	                        "given as date string or as number of days before "
 	                        "now. Unused in deep-scan mode.",
 	                        &_modifiedUntil);
+	commandline().addOption("Collector", "watch",
+	                        "Keep running after the initial scan and process "
+	                        "chunks as soon as they are modified. Requires an "
+	                        "SDS archive on a local file system.");
 	commandline().addOption("Collector", "generate-test-data",
 	                        "For each stream in inventory generate test data. "
 	                        "Format: days,gaps,gapseconds,overlaps,"
@@ -1429,6 +1546,12 @@ bool SCARDAC::initConfiguration() {
 	catch ( ... ) {
 	}
 
+	try {
+		_chunkThreads = SCCoreApp->configGetInt("chunkThreads");
+	}
+	catch ( ... ) {
+	}
+
 	try {
 		_jitter = SCCoreApp->configGetDouble("jitter");
 	}
@@ -1511,6 +1634,32 @@ bool SCARDAC::initConfiguration() {
 	catch ( ... ) {
 	}
 
+	try {
+		_index = SCCoreApp->commandline().hasOption("index")
+		      || SCCoreApp->configGetBool("index");
+	}
+	catch ( ... ) {
+	}
+
+	try {
+		_watch = SCCoreApp->commandline().hasOption("watch")
+		      || SCCoreApp->configGetBool("watch.enable");
+	}
+	catch ( ... ) {
+	}
+
+	try {
+		_watchDelay = SCCoreApp->configGetDouble("watch.delay");
+	}
+	catch ( ... ) {
+	}
+
+	try {
+		_watchReconcile = SCCoreApp->configGetDouble("watch.reconcile");
+	}
+	catch ( ... ) {
+	}
+
 	try {
 		_modifiedSince = SCCoreApp->configGetString("mtime.start");
 	}
@@ -1549,6 +1698,13 @@ bool SCARDAC::validateParameters() {
 		return false;
 	}
 
+	// chunk thread count
+	if ( _chunkThreads < 1 || _chunkThreads > MAX_THREADS ) {
+		SEISCOMP_ERROR("Invalid number of chunk threads, allowed range: [1,%i]",
+		               static_cast<int>(MAX_THREADS));
+		return false;
+	}
+
 	// jitter samples
 	if ( _jitter < 0 ) {
 		SEISCOMP_ERROR("Invalid jitter value, minimum value: 0");
@@ -1591,6 +1747,19 @@ bool SCARDAC::validateParameters() {
 		}
 	}
 
+	// watch mode relies on the last scan time of the extents
+	if ( _watch ) {
+		if ( _mtimeStart || _mtimeEnd ) {
+			SEISCOMP_ERROR("Modification window not supported in watch mode");
+			return false;
+		}
+
+		if ( _watchDelay < 0 ) {
+			SEISCOMP_ERROR("Invalid watch delay, minimum value: 0");
+			return false;
+		}
+	}
+
 	return true;
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -1651,8 +1820,11 @@ bool SCARDAC::run() {
   database      : %s
   archive       : %s
   threads       : %i
+  chunk threads : %i
   jitter        : %f
   max segments  : %zu
+  chunk index   : %s
+  watch mode    : %s
   nslc list     : %s
   data filter
     start time  : %s
@@ -1660,7 +1832,10 @@ bool SCARDAC::run() {
     nslc include: %s
     nslc exclude: %s
   mtime%s)",
-	    _settings.database.URI, _archive, _threads, _jitter, _maxSegments,
+	    _settings.database.URI, _archive, _threads, _chunkThreads, _jitter,
+	    _maxSegments,
+	    (_index ? "enabled" : "disabled"),
+	    (_watch ? "enabled" : "disabled"),
 	    (_wfidFile.empty() ? string("obtained by archive scan") : _wfidFile),
 	    (_startTime ? _startTime->iso() : string("-")),
 	    (_endTime ? _endTime->iso() : string("-")), cfgInclude, cfgExclude, cfgMtime);
@@ -1674,18 +1849,95 @@ bool SCARDAC::run() {
 		return false;
 	}
 
-	// update collector's time window
-	setTimeWindow(_collector.get());
+	// update collector's time window and index settings
+	configureCollector(_collector.get());
 
 	// disable public object cache
 	PublicObject::SetRegistrationEnabled(false);
 	Notifier::Disable();
 
+	// In watch mode the watcher is started before the initial scan so that
+	// no modification is missed
+	ArchiveWatcher watcher;
+	if ( _watch && !startWatcher(watcher) ) {
+		return false;
+	}
+
+	loadExtents();
+
+	WorkQueueItems items;
+	if ( !collectExtents(items) ) {
+		return false;
+	}
+
+	// modifications lost during the initial scan are covered by it
+	if ( _watch && watcher.lostEvents() ) {
+		SEISCOMP_DEBUG("Ignoring archive modifications lost during initial "
+		               "scan");
+	}
+
+	// stop here if there is nothing to process
+	if ( items.empty() && !_watch ) {
+		return true;
+	}
+
+	// Create N worker threads. If the collector is marked as not thread safe
+	// a new collector instance needs to be created starting with the 2nd
+	// worker instance.
+	SEISCOMP_INFO("Creating %i worker threads", _threads);
+	WorkerList workers;
+	for ( int i = 1; i <= _threads; ++i ) {
+		workers.push_back(new thread([this, i] { processExtents(i); }));
+	}
+
+	// add extents to work queue, push may block if queue size is exceeded
+	queueExtents(items);
+
+	bool res = true;
+	if ( _watch ) {
+		res = watchArchive(watcher);
+	}
+
+	// a nullptr object is used to signal end of queue
+	_workQueue.push(WorkQueueItem());
+	SEISCOMP_INFO("Last stream pushed, waiting for worker to terminate");
+
+	// wait for all workers to terminate
+	for ( auto &worker : workers ) {
+		worker->join();
+		delete worker;
+	}
+	workers.clear();
+
+	_workQueue.reset();
+
+	return res;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SCARDAC::loadExtents() {
 	_dataAvailability = new ::DataAvailability();
 	// query all extents stored in database so far and add them to extent map
 	int count = query()->loadDataExtents(_dataAvailability.get());
 	SEISCOMP_INFO("Loaded %i extents (streams) from database", count);
 
+	_extents.clear();
+	for ( size_t i = 0; i < _dataAvailability->dataExtentCount(); ++i ) {
+		auto *extent = _dataAvailability->dataExtent(i);
+		_extents[streamID(extent->waveformID())] = extent;
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SCARDAC::collectExtents(WorkQueueItems &items) {
 	Collector::WaveformIDs wids;
 	if ( _wfidFile.empty() ) {
 		SEISCOMP_INFO("Scanning archive for waveform stream IDs");
@@ -1713,9 +1965,9 @@ bool SCARDAC::run() {
 	// add existing extents to extent map
 	bool filterByTime = _startTime || _endTime;
 	ExtentMap extentMap;
-	for ( size_t i = 0; i < _dataAvailability->dataExtentCount(); ++i ) {
-		auto *extent = _dataAvailability->dataExtent(i);
-		auto sid = streamID(extent->waveformID());
+	for ( const auto &item : _extents ) {
+		const auto &sid = item.first;
+		auto *extent = item.second;
 
 		if ( filterByID && !_wfidFirewall.isAllowed(sid) ) {
 			SEISCOMP_DEBUG("Skipping existing extent %s: stream ID does not "
@@ -1748,18 +2000,8 @@ bool SCARDAC::run() {
 		return true;
 	}
 
-	// Create N worker threads. If the collector is marked as not thread safe
-	// a new collector instance needs to be created starting with the 2nd
-	// worker instance.
-	SEISCOMP_INFO("Creating %i worker threads", _threads);
-	WorkerList workers;
-	for ( int i = 1; i <= _threads; ++i ) {
-		workers.push_back(new thread([this, i] { processExtents(i); }));
-	}
-
-	// add extents to work queue, push may block if queue size is exceeded
 	for ( auto &it : extentMap ) {
-		_workQueue.push(WorkQueueItem(it.second, true));
+		items.emplace_back(it.second, true);
 	}
 
 	// search for new streams and create new extents
@@ -1773,23 +2015,193 @@ bool SCARDAC::run() {
 		auto *extent = DataExtent::Create();
 		extent->setWaveformID(wid.second);
 		_dataAvailability->add(extent);
+		_extents[wid.first] = extent;
 		extentMap[wid.first] = extent;
-		_workQueue.push(WorkQueueItem(extent, false));
+		items.emplace_back(extent, false);
 	}
 	SEISCOMP_INFO("Found %zu new streams in archive", extentMap.size() - oldSize);
 
-	// a nullptr object is used to signal end of queue
-	_workQueue.push(WorkQueueItem());
-	SEISCOMP_INFO("Last stream pushed, waiting for worker to terminate");
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-	// wait for all workers to terminate
-	for ( auto &worker : workers ) {
-		worker->join();
-		delete worker;
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SCARDAC::queueExtents(WorkQueueItems &items) {
+	for ( auto &item : items ) {
+		++_pendingExtents;
+		_workQueue.push(std::move(item));
 	}
-	workers.clear();
+	items.clear();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-	_workQueue.reset();
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void SCARDAC::queueChanges(ChangeMap &changes) {
+	WorkQueueItems items;
+	for ( auto &item : changes ) {
+		const auto &sid = item.first;
+		DataExtent *extent = nullptr;
+		bool foundInDB = false;
+
+		auto it = _extents.find(sid);
+		if ( it != _extents.end() ) {
+			// The extent may have been removed from the database by a worker
+			// because its last chunk was removed, start over in that case
+			if ( query()->getCachedId(it->second)
+			     != IO::DatabaseInterface::INVALID_OID ) {
+				extent = it->second;
+				foundInDB = true;
+			}
+			else {
+				_dataAvailability->remove(it->second);
+				_extents.erase(it);
+			}
+		}
+
+		if ( !extent ) {
+			extent = DataExtent::Create();
+			extent->setWaveformID(item.second.wid);
+			_dataAvailability->add(extent);
+			_extents[sid] = extent;
+		}
+
+		SEISCOMP_DEBUG("%s: Queuing %zu changed chunks", sid,
+		               item.second.chunks.size());
+		items.emplace_back(extent, foundInDB, std::move(item.second.chunks));
+	}
+
+	changes.clear();
+	queueExtents(items);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SCARDAC::startWatcher(ArchiveWatcher &watcher) {
+	// Only file based SDS archives can be watched
+	string service = "sds";
+	string source = _archive;
+	auto pos = _archive.find("://");
+	if ( pos != string::npos ) {
+		service = _archive.substr(0, pos);
+		source = _archive.substr(pos + 3);
+	}
+
+	if ( service != "sds" ) {
+		SEISCOMP_ERROR("Watch mode is not supported for archive type: %s",
+		               service);
+		return false;
+	}
+
+	// YEAR/NET/STA/CHA.D/NET.STA.LOC.CHA.D.YEAR.DAY
+	return watcher.open(Environment::Instance()->absolutePath(source), 4);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool SCARDAC::watchArchive(ArchiveWatcher &watcher) {
+	SEISCOMP_INFO("Watching archive for modifications");
+
+	ChangeMap changes;
+	ArchiveWatcher::Files files;
+	Core::Time nextReconcile;
+	if ( _watchReconcile > 0 ) {
+		nextReconcile = Core::Time::UTC() + Core::TimeSpan(_watchReconcile);
+	}
+
+	while ( !_exitRequested ) {
+		files.clear();
+		if ( !watcher.wait(files, 1.0) ) {
+			SEISCOMP_ERROR("Could not read archive modifications");
+			return false;
+		}
+
+		auto now = Core::Time::UTC();
+
+		// map modified files to streams, files not representing a chunk,
+		// e.g., chunk index files, are ignored
+		for ( const auto &file : files ) {
+			DataModel::WaveformStreamID wid;
+			if ( !_collector->chunkWaveformID(wid, file) ) {
+				continue;
+			}
+
+			auto sid = streamID(wid);
+			if ( !_wfidFirewall.isAllowed(sid) ) {
+				continue;
+			}
+
+			auto it = changes.find(sid);
+			if ( it == changes.end() ) {
+				it = changes.insert({sid, {wid, {}, now}}).first;
+			}
+			it->second.chunks.insert(file);
+		}
+
+		if ( watcher.lostEvents() ) {
+			SEISCOMP_WARNING("Archive modifications were lost, scheduling "
+			                 "full reconciliation");
+			nextReconcile = now;
+		}
+
+		// Process one round at a time so that an extent is never processed
+		// by two workers simultaneously
+		if ( _pendingExtents > 0 ) {
+			continue;
+		}
+
+		if ( nextReconcile && now >= nextReconcile ) {
+			SEISCOMP_INFO("Starting full reconciliation of archive");
+			changes.clear();
+			loadExtents();
+
+			WorkQueueItems items;
+			if ( !collectExtents(items) ) {
+				return false;
+			}
+
+			// The scan covers all modifications up to now, an overflow
+			// which occurred in the meantime does not need another one.
+			// Modifications read during the scan are still processed.
+			if ( watcher.lostEvents() ) {
+				SEISCOMP_DEBUG("Ignoring archive modifications lost during "
+				               "reconciliation");
+			}
+
+			queueExtents(items);
+			nextReconcile = _watchReconcile > 0
+			              ? now + Core::TimeSpan(_watchReconcile)
+			              : Core::Time();
+			continue;
+		}
+
+		// Wait for the delay after the first modification of any stream to
+		// collect subsequent modifications in one round
+		auto due = false;
+		for ( const auto &item : changes ) {
+			if ( (now - item.second.firstChange).length() >= _watchDelay ) {
+				due = true;
+				break;
+			}
+		}
+
+		if ( due ) {
+			SEISCOMP_INFO("Processing modifications of %zu streams",
+			              changes.size());
+			queueChanges(changes);
+		}
+	}
 
 	return true;
 }
@@ -1818,7 +2230,7 @@ void SCARDAC::done() {
 
 
 // >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
-void SCARDAC::setTimeWindow(Collector *collector) {
+void SCARDAC::configureCollector(Collector *collector) {
 	if ( _startTime ) {
 		collector->setStartTime(*_startTime);
 	}
@@ -1826,6 +2238,8 @@ void SCARDAC::setTimeWindow(Collector *collector) {
 	if ( _endTime ) {
 		collector->setEndTime(*_endTime);
 	}
+
+	collector->setIndexEnabled(_index);
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -1837,7 +2251,7 @@ void SCARDAC::processExtents(int threadID) {
 	auto *collector = _collector.get();
 	if ( threadID > 1 && !_collector->threadSafe() ) {
 		collector = Collector::Open(_archive.c_str());
-		setTimeWindow(collector);
+		configureCollector(collector);
 	}
 	Worker worker(this, threadID, collector);
 
@@ -1857,7 +2271,8 @@ void SCARDAC::processExtents(int threadID) {
 			return;
 		}
 
-		worker.processExtent(item.extent, item.foundInDB);
+		worker.processExtent(item.extent, item.foundInDB, item.changedChunks);
+		--_pendingExtents;
 	}
 }
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
@@ -33,6 +33,8 @@
 
 #include <seiscomp/utils/stringfirewall.h>
 
+#include <atomic>
+#include <set>
 #include <thread>
 #include <string>
 
@@ -40,12 +42,23 @@ namespace Seiscomp {
 namespace DataAvailability {
 
 class SCARDAC;
+class ArchiveWatcher;
 
 class Worker {
 	public:
+		using ChunkSet = std::set<std::string>;
+
 		Worker(const SCARDAC *app, int id, Collector *collector);
 
-		void processExtent(DataModel::DataExtent *extent, bool foundInDB);
+		/**
+		 * @brief Synchronize an extent with the archive.
+		 * @param extent The extent to process.
+		 * @param foundInDB Whether the extent exists in the database.
+		 * @param changedChunks Chunks known to be modified, they are read
+		 * independent of their mtime.
+		 */
+		void processExtent(DataModel::DataExtent *extent, bool foundInDB,
+		                   const ChunkSet &changedChunks = ChunkSet());
 
 	protected:
 		using Segments = std::vector<DataModel::DataSegmentPtr>;
@@ -59,6 +72,7 @@ class Worker {
 
 		bool writeExtent(const DataModel::Operation &op);
 		bool syncSegments();
+		bool writeSegments(bool abortOnError);
 		void syncExtent();
 		void readAttExtMillis(DataModel::DataAttributeExtent *attExt);
 
@@ -99,15 +113,26 @@ class SCARDAC : public Client::Application {
 	protected:
 		struct WorkQueueItem {
 			WorkQueueItem() = default;
-			WorkQueueItem(DataModel::DataExtent *extent, bool foundInDB)
-			 : extent(extent), foundInDB(foundInDB) {}
+			WorkQueueItem(DataModel::DataExtent *extent, bool foundInDB,
+			              Worker::ChunkSet changedChunks = Worker::ChunkSet())
+			 : extent(extent), foundInDB(foundInDB)
+			 , changedChunks(std::move(changedChunks)) {}
 
 			DataModel::DataExtent  *extent{nullptr};
 			bool                    foundInDB{false};
+			Worker::ChunkSet        changedChunks;
+		};
+
+		struct StreamChanges {
+			DataModel::WaveformStreamID wid;
+			Worker::ChunkSet            chunks;
+			Core::Time                  firstChange;
 		};
 
 		using ExtentMap = std::map<std::string, DataModel::DataExtent*>;
 		using WorkerList = std::vector<std::thread*>;
+		using WorkQueueItems = std::vector<WorkQueueItem>;
+		using ChangeMap = std::map<std::string, StreamChanges>;
 
 	// ----------------------------------------------------------------------
 	//  Protected functions
@@ -119,7 +144,13 @@ class SCARDAC : public Client::Application {
 		bool run() override;
 		void done() override;
 
-		void setTimeWindow(Collector *collector);
+		void configureCollector(Collector *collector);
+		void loadExtents();
+		bool collectExtents(WorkQueueItems &items);
+		void queueExtents(WorkQueueItems &items);
+		void queueChanges(ChangeMap &changes);
+		bool startWatcher(ArchiveWatcher &watcher);
+		bool watchArchive(ArchiveWatcher &watcher);
 		void processExtents(int threadID);
 		bool generateTestData();
 
@@ -132,6 +163,7 @@ class SCARDAC : public Client::Application {
 		// configuration parameters
 		std::string     _archive{"sds://@ROOTDIR@/var/lib/archive"};
 		int             _threads{1};
+		int             _chunkThreads{1};
 		float           _jitter{0.5};
 		size_t          _maxSegments{1000000};
 		size_t          _maxChunkOverlap{500};
@@ -143,10 +175,14 @@ class SCARDAC : public Client::Application {
 		WFIDList        _include;
 		WFIDList        _exclude;
 		bool            _deepScan{false};
+		bool            _index{false};
 		std::string     _modifiedSince;
 		std::string     _modifiedUntil;
 		OPT(Core::Time) _mtimeStart;
 		OPT(Core::Time) _mtimeEnd;
+		bool            _watch{false};
+		double          _watchDelay{10};
+		double          _watchReconcile{86400};
 
 		Util::WildcardStringFirewall         _wfidFirewall;
 
@@ -154,9 +190,12 @@ class SCARDAC : public Client::Application {
 		DataAvailability::CollectorPtr       _collector{nullptr};
 
 		DataModel::DataAvailabilityPtr       _dataAvailability{nullptr};
+		ExtentMap                            _extents;
 
 		// Thread safe queue of extends to process
 		Client::ThreadedQueue<WorkQueueItem> _workQueue;
+		// Number of queued extents not yet processed
+		std::atomic<size_t>                  _pendingExtents{0};
 
 	private:
 		friend class Worker;
@@ -27,6 +27,7 @@
 #include <seiscomp/datamodel/databasereader.h>
 #include <seiscomp/datamodel/dataextent.h>
 #include <seiscomp/io/database.h>
+#include <seiscomp/plugins/dataavailability/collector/sds.h>
 #include <seiscomp/system/environment.h>
 #include <seiscomp/system/pluginregistry.h>
 #include <seiscomp/unittest/unittests.h>
@@ -623,6 +624,74 @@ BOOST_AUTO_TEST_CASE(multiday) {
 
 
 
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+BOOST_AUTO_TEST_CASE(chunk_boundaries) {
+	// Four day chunks of 50 Hz data:
+	//   100 -> 101: records touching at the chunk edge, merged
+	//   101       : gap within the chunk
+	//   101 -> 102: segment ending exactly at the chunk edge
+	//   102 -> 103: last record of 102 overlaps the first record of 103
+	auto basePath = archiveDir + "/2023/AM/R0F05/SHZ.D/AM.R0F05.00.SHZ.D.2023.";
+	auto mseedFile1 = basePath + "101";
+
+	vector<Core::TimeWindow> expected = {
+		{ Core::Time(2023, 4, 10, 23, 58, 37, 360'000),
+		  Core::Time(2023, 4, 11, 0, 1, 26, 640'000) },
+		{ Core::Time(2023, 4, 11, 23, 58, 33, 0),
+		  Core::Time(2023, 4, 12, 0, 0, 0, 0) },
+		{ Core::Time(2023, 4, 12, 23, 58, 45, 380'000),
+		  Core::Time(2023, 4, 13, 0, 0, 4, 0) },
+		{ Core::Time(2023, 4, 13, 0, 0, 0, 0),
+		  Core::Time(2023, 4, 13, 0, 1, 20, 680'000) }
+	};
+
+	auto checkSegments = [&](DataModel::DatabaseReaderPtr &reader,
+	                         const string &ctx) {
+		DataModel::DataAvailabilityPtr da = reader->loadDataAvailability();
+		BOOST_REQUIRE_MESSAGE(da && da->dataExtentCount() == 1,
+		                      ctx << ": Expected one extent");
+		auto *ext = da->dataExtent(0);
+		reader->load(ext);
+		BOOST_REQUIRE_EQUAL(ext->dataSegmentCount(), expected.size());
+		for ( size_t i = 0; i < expected.size(); ++i ) {
+			auto *seg = ext->dataSegment(i);
+			CHECK_EQUAL_MSG(expected[i].startTime().iso(), seg->start().iso(),
+			                ctx << ": segment " << i);
+			CHECK_EQUAL_MSG(expected[i].endTime().iso(), seg->end().iso(),
+			                ctx << ": segment " << i);
+		}
+		return da;
+	};
+
+	string ctx("sequential read");
+	BOOST_TEST_MESSAGE(ctx);
+	DataModel::DatabaseReaderPtr reader;
+	reader = runApp(dbURI, { appName, "--chunk-threads", "1" });
+	auto da = checkSegments(reader, ctx);
+
+	// the chunks are read concurrently and merged in chunk order afterwards
+	ctx = "parallel read";
+	BOOST_TEST_MESSAGE(ctx);
+	reader = runApp(dbURI, { appName, "--chunk-threads", "4", "--deep-scan" });
+	checkSegments(reader, ctx);
+	auto daFound = checkEqual(reader, da.get(), ctx);
+
+	// only the modified chunk and the chunk linked to it by the first
+	// segment are read again, the others are copied from the database
+	ctx = "parallel read of modified chunk";
+	BOOST_TEST_MESSAGE(ctx);
+	auto lastScan = daFound->dataExtent(0)->lastScan();
+	lastScan.setUSecs(0);
+	auto future = lastScan + Core::TimeSpan(2, 0);
+	boost::filesystem::last_write_time(mseedFile1, future.epochSeconds());
+	reader = runApp(dbURI, { appName, "--chunk-threads", "4" });
+	checkSegments(reader, ctx);
+}
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+
+
+
+
 //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 BOOST_AUTO_TEST_CASE(timewindow) {
 	auto basePath = archiveDir + "/2023/AM/R0F05/SHZ.D/AM.R0F05.00.SHZ.D.2023.";
@@ -706,5 +775,161 @@ BOOST_AUTO_TEST_CASE(streamfilter) {
 
 
 
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+BOOST_AUTO_TEST_CASE(index_file) {
+	using DataAvailability::SDSCollector;
+
+	auto mseedFile = archiveDir + "/2019/AM/R0F05/SHZ.D/AM.R0F05.00.SHZ.D.2019.214";
+	auto indexFile = SDSCollector::IndexFile(mseedFile);
+	string sid("AM.R0F05.00.SHZ");
+
+	// write and read back an index
+	string ctx("write index");
+	BOOST_TEST_MESSAGE(ctx);
+	SDSCollector::Index written(2);
+	written[0].offset = 0;
+	written[0].startTime = Core::Time(2019, 8, 2, 17, 59, 58, 217999);
+	written[0].endTime = Core::Time(2019, 8, 2, 18, 0, 30);
+	written[0].sampleRate = 50.0;
+	written[0].quality = "D";
+	written[1].offset = 512;
+	written[1].startTime = written[0].endTime;
+	written[1].endTime = Core::Time(2019, 8, 2, 18, 1, 4, 837999);
+	written[1].sampleRate = 50.0;
+
+	auto size = fs::file_size(SC_FS_PATH(mseedFile));
+	Core::Time mtime(fs::last_write_time(SC_FS_PATH(mseedFile)), 0);
+	BOOST_REQUIRE(SDSCollector::WriteIndex(written, mseedFile, sid, size, mtime));
+	BOOST_CHECK(fs::exists(SC_FS_PATH(indexFile)));
+	BOOST_CHECK(!fs::exists(SC_FS_PATH(indexFile + ".tmp")));
+
+	SDSCollector::Index read;
+	BOOST_REQUIRE(SDSCollector::ReadIndex(read, mseedFile, sid));
+	BOOST_REQUIRE_EQUAL(read.size(), written.size());
+	for ( size_t i = 0; i < read.size(); ++i ) {
+		BOOST_CHECK_EQUAL(read[i].offset, written[i].offset);
+		BOOST_CHECK_EQUAL(read[i].startTime.iso(), written[i].startTime.iso());
+		BOOST_CHECK_EQUAL(read[i].endTime.iso(), written[i].endTime.iso());
+		BOOST_CHECK_EQUAL(read[i].sampleRate, written[i].sampleRate);
+		BOOST_CHECK_EQUAL(read[i].quality, written[i].quality);
+	}
+
+	BOOST_CHECK(!SDSCollector::ReadIndex(read, mseedFile, "AM.R0F05.00.SHN"));
+
+	size_t offset = 1;
+	BOOST_CHECK(SDSCollector::SeekOffset(offset, written, written[0].startTime));
+	BOOST_CHECK_EQUAL(offset, 0);
+	BOOST_CHECK(SDSCollector::SeekOffset(offset, written, written[1].startTime));
+	BOOST_CHECK_EQUAL(offset, 512);
+	BOOST_CHECK(!SDSCollector::SeekOffset(offset, written, written[1].endTime));
+
+	// an index written by scardac reproduces the result of the full scan
+	ctx = "index written by scan";
+	BOOST_TEST_MESSAGE(ctx);
+	fs::remove(SC_FS_PATH(indexFile));
+	DataModel::DatabaseReaderPtr reader = runApp(dbURI, { appName, "--index" });
+	DataModel::DataAvailabilityPtr da = reader->loadDataAvailability();
+	BOOST_REQUIRE(da && da->dataExtentCount() == 1);
+	reader->load(da->dataExtent(0));
+
+	BOOST_REQUIRE(SDSCollector::ReadIndex(read, mseedFile, sid));
+	BOOST_REQUIRE(!read.empty());
+	BOOST_CHECK_EQUAL(read.front().offset, 0);
+	BOOST_CHECK_EQUAL(read.front().startTime.iso(), da->dataExtent(0)->start().iso());
+	BOOST_CHECK_EQUAL(read.back().endTime.iso(), da->dataExtent(0)->end().iso());
+	BOOST_CHECK_EQUAL(read.back().sampleRate, 50.0);
+	BOOST_CHECK_EQUAL(read.back().quality, "D");
+
+	ctx = "rescan from index";
+	BOOST_TEST_MESSAGE(ctx);
+	reader = runApp(dbURI, { appName, "--index", "--deep-scan" });
+	checkEqual(reader, da.get(), ctx);
+}
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+
+
+
+
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+BOOST_AUTO_TEST_CASE(index_outdated) {
+	using DataAvailability::SDSCollector;
+
+	auto mseedFile = archiveDir + "/2019/AM/R0F05/SHZ.D/AM.R0F05.00.SHZ.D.2019.214";
+	string sid("AM.R0F05.00.SHZ");
+
+	// an index of an older state of the file pretending a different
+	// time span
+	SDSCollector::Index outdated(1);
+	outdated[0].startTime = Core::Time(2019, 8, 2, 12, 0, 0);
+	outdated[0].endTime = Core::Time(2019, 8, 2, 13, 0, 0);
+	outdated[0].sampleRate = 50.0;
+	outdated[0].quality = "D";
+
+	auto size = fs::file_size(SC_FS_PATH(mseedFile));
+	Core::Time mtime(fs::last_write_time(SC_FS_PATH(mseedFile)), 0);
+	BOOST_REQUIRE(SDSCollector::WriteIndex(outdated, mseedFile, sid, size,
+	                                       mtime - Core::TimeSpan(10, 0)));
+
+	SDSCollector::Index read;
+	BOOST_CHECK(!SDSCollector::ReadIndex(read, mseedFile, sid));
+	BOOST_CHECK(read.empty());
+
+	// the outdated index is ignored and replaced
+	DataModel::DatabaseReaderPtr reader = runApp(dbURI, { appName, "--index" });
+	DataModel::DataAvailabilityPtr da = reader->loadDataAvailability();
+	BOOST_REQUIRE(da && da->dataExtentCount() == 1);
+	auto *ext = da->dataExtent(0);
+	BOOST_CHECK_EQUAL(ext->start().iso(), "2019-08-02T17:59:58.217999Z");
+	BOOST_CHECK_EQUAL(ext->end().iso(), "2019-08-02T18:01:04.837999Z");
+
+	BOOST_REQUIRE(SDSCollector::ReadIndex(read, mseedFile, sid));
+	BOOST_REQUIRE(!read.empty());
+	BOOST_CHECK_EQUAL(read.front().startTime.iso(), ext->start().iso());
+	BOOST_CHECK_EQUAL(read.back().endTime.iso(), ext->end().iso());
+}
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+
+
+
+
+//<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+BOOST_AUTO_TEST_CASE(index_truncated) {
+	using DataAvailability::SDSCollector;
+
+	auto mseedFile = archiveDir + "/2019/AM/R0F05/SHZ.D/AM.R0F05.00.SHZ.D.2019.214";
+	auto indexFile = SDSCollector::IndexFile(mseedFile);
+	string sid("AM.R0F05.00.SHZ");
+
+	string ctx("initial scan");
+	BOOST_TEST_MESSAGE(ctx);
+	DataModel::DatabaseReaderPtr reader = runApp(dbURI, { appName, "--index" });
+	DataModel::DataAvailabilityPtr da = reader->loadDataAvailability();
+	BOOST_REQUIRE(da && da->dataExtentCount() == 1);
+	reader->load(da->dataExtent(0));
+
+	SDSCollector::Index read;
+	BOOST_REQUIRE(SDSCollector::ReadIndex(read, mseedFile, sid));
+	auto entries = read.size();
+
+	// cut the last entry in half
+	ctx = "truncated index";
+	BOOST_TEST_MESSAGE(ctx);
+	auto indexSize = fs::file_size(SC_FS_PATH(indexFile));
+	fs::resize_file(SC_FS_PATH(indexFile), indexSize - 10);
+	BOOST_CHECK(!SDSCollector::ReadIndex(read, mseedFile, sid));
+	BOOST_CHECK(read.empty());
+
+	// the chunk is scanned entirely and the index is written again
+	reader = runApp(dbURI, { appName, "--index", "--deep-scan" });
+	checkEqual(reader, da.get(), ctx);
+
+	BOOST_REQUIRE(SDSCollector::ReadIndex(read, mseedFile, sid));
+	BOOST_CHECK_EQUAL(read.size(), entries);
+}
+//>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+
+
+
+
 //<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,324 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+
+#define SEISCOMP_COMPONENT SCARDAC
+
+#include "watcher.h"
+
+#include <seiscomp/core/system.h>
+#include <seiscomp/logging/log.h>
+
+#include <boost/filesystem.hpp>
+
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+namespace fs = boost::filesystem;
+
+namespace Seiscomp {
+namespace DataAvailability {
+
+#ifdef __linux__
+namespace {
+
+// Directories above the file level only need to report new subdirectories
+const uint32_t DirectoryMask = IN_CREATE | IN_MOVED_TO | IN_ONLYDIR;
+// A file is reported once it was written and closed or moved into place.
+// IN_MODIFY is not used on purpose: a record based writer such as slarchive
+// triggers it for every record and floods the kernel queue.
+const uint32_t FileMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM |
+                          IN_DELETE | IN_ONLYDIR;
+
+// Interval in milliseconds the reader thread checks for termination
+const int ReadTimeout = 100;
+
+} // namespace
+#endif
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+ArchiveWatcher::~ArchiveWatcher() {
+	close();
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool ArchiveWatcher::open(const std::string &path, int depth) {
+	close();
+
+#ifdef __linux__
+	_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if ( _fd < 0 ) {
+		SEISCOMP_ERROR("Could not initialize inotify: %s", strerror(errno));
+		return false;
+	}
+
+	string root = path;
+	while ( root.size() > 1 && root.back() == '/' ) {
+		root.pop_back();
+	}
+
+	_depth = depth;
+
+	Files files;
+	addWatches(files, root, 0, false);
+
+	if ( _watches.empty() ) {
+		SEISCOMP_ERROR("Could not watch directory: %s", root);
+		close();
+		return false;
+	}
+
+	if ( _lostEvents ) {
+		SEISCOMP_ERROR("Could not watch all directories below %s, consider "
+		               "raising the fs.inotify.max_user_watches kernel "
+		               "parameter", root);
+		close();
+		return false;
+	}
+
+	SEISCOMP_INFO("Watching %zu directories below %s", _watches.size(), root);
+
+	_running = true;
+	_reader = thread(&ArchiveWatcher::run, this);
+	return true;
+#else
+	SEISCOMP_ERROR("Watching %s is not supported on this platform", path);
+	return false;
+#endif
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void ArchiveWatcher::close() {
+	_running = false;
+	if ( _reader.joinable() ) {
+		_reader.join();
+	}
+
+#ifdef __linux__
+	if ( _fd >= 0 ) {
+		::close(_fd);
+	}
+#endif
+	_fd = -1;
+	_watches.clear();
+	_watchCount = 0;
+	_lostEvents = false;
+	_pending.clear();
+	_error = false;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool ArchiveWatcher::wait(Files &files, double timeout) {
+	if ( _fd < 0 ) {
+		return false;
+	}
+
+	unique_lock<mutex> lock(_mutex);
+	_changed.wait_for(lock, chrono::duration<double>(timeout), [this] {
+		return _error || !_pending.empty();
+	});
+
+	if ( _error ) {
+		return false;
+	}
+
+	files.insert(files.end(), _pending.begin(), _pending.end());
+	_pending.clear();
+	return true;
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void ArchiveWatcher::run() {
+	Files files;
+	while ( _running ) {
+		files.clear();
+		bool ok = readEvents(files);
+		int err = errno;
+		if ( ok && files.empty() ) {
+			continue;
+		}
+
+		{
+			lock_guard<mutex> lock(_mutex);
+			_pending.insert(_pending.end(), files.begin(), files.end());
+			_error = !ok;
+		}
+		_changed.notify_all();
+
+		if ( !ok ) {
+			SEISCOMP_ERROR("Could not read inotify events: %s",
+			               strerror(err));
+			break;
+		}
+	}
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool ArchiveWatcher::readEvents(Files &files) {
+#ifdef __linux__
+	pollfd pfd{_fd, POLLIN, 0};
+	int res = poll(&pfd, 1, ReadTimeout);
+	if ( res <= 0 ) {
+		return res == 0 || errno == EINTR;
+	}
+
+	alignas(inotify_event) char buf[65536];
+	ssize_t len = read(_fd, buf, sizeof(buf));
+	if ( len < 0 ) {
+		return errno == EINTR || errno == EAGAIN;
+	}
+
+	for ( char *ptr = buf; ptr < buf + len; ) {
+		const auto *event = reinterpret_cast<const inotify_event*>(ptr);
+		ptr += sizeof(inotify_event) + event->len;
+
+		if ( event->mask & IN_Q_OVERFLOW ) {
+			_lostEvents = true;
+			continue;
+		}
+
+		auto it = _watches.find(event->wd);
+		if ( it == _watches.end() ) {
+			continue;
+		}
+
+		// watch removed, e.g., because the directory was deleted
+		if ( event->mask & IN_IGNORED ) {
+			_watches.erase(it);
+			_watchCount = _watches.size();
+			continue;
+		}
+
+		if ( !event->len ) {
+			continue;
+		}
+
+		string path = it->second.path + '/' + event->name;
+		int level = it->second.level;
+
+		if ( event->mask & IN_ISDIR ) {
+			// Files may have been written to the new directory before the
+			// watch was added, report them as well
+			if ( level < _depth && (event->mask & (IN_CREATE | IN_MOVED_TO)) ) {
+				addWatches(files, path, level + 1, true);
+			}
+			continue;
+		}
+
+		if ( level == _depth ) {
+			files.push_back(path);
+		}
+	}
+
+	return true;
+#else
+	return false;
+#endif
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+bool ArchiveWatcher::lostEvents() {
+	return _lostEvents.exchange(false);
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+void ArchiveWatcher::addWatches(Files &files, const std::string &path,
+                                int level, bool reportFiles) {
+#ifdef __linux__
+	int wd = inotify_add_watch(_fd, path.c_str(),
+	                           level < _depth ? DirectoryMask : FileMask);
+	if ( wd < 0 ) {
+		if ( errno == ENOSPC ) {
+			// watch limit reached, changes below path remain unnoticed
+			_lostEvents = true;
+		}
+		SEISCOMP_WARNING("Could not watch directory %s: %s", path,
+		                 strerror(errno));
+		return;
+	}
+
+	_watches[wd] = {path, level};
+	_watchCount = _watches.size();
+
+	// Only list the file level if the files need to be reported. This
+	// keeps the initial setup independent of the number of files.
+	if ( level == _depth && !reportFiles ) {
+		return;
+	}
+
+	const fs::directory_iterator end_itr;
+	try {
+		for ( fs::directory_iterator itr(path); itr != end_itr; ++itr ) {
+			fs::path entry = SC_FS_DE_PATH(itr);
+			string entryPath = path + '/' + SC_FS_FILE_NAME(entry);
+			if ( level < _depth ) {
+				if ( fs::is_directory(entry) ) {
+					addWatches(files, entryPath, level + 1, reportFiles);
+				}
+			}
+			else if ( SC_FS_IS_REGULAR_FILE(entry) ) {
+				files.push_back(entryPath);
+			}
+		}
+	}
+	catch ( ... ) {}
+#endif
+}
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+} // ns DataAvailability
+} // ns Seiscomp
@@ -0,0 +1,111 @@
+/***************************************************************************
+ * Copyright (C) GFZ Potsdam                                               *
+ * All rights reserved.                                                    *
+ *                                                                         *
+ * GNU Affero General Public License Usage                                 *
+ * This file may be used under the terms of the GNU Affero                 *
+ * Public License version 3.0 as published by the Free Software Foundation *
+ * and appearing in the file LICENSE included in the packaging of this     *
+ * file. Please review the following information to ensure the GNU Affero  *
+ * Public License version 3.0 requirements will be met:                    *
+ * https://www.gnu.org/licenses/agpl-3.0.html.                             *
+ ***************************************************************************/
+
+#ifndef SEISCOMP_DATAAVAILABILITY_WATCHER_H
+#define SEISCOMP_DATAAVAILABILITY_WATCHER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Seiscomp {
+namespace DataAvailability {
+
+/**
+ * @brief The ArchiveWatcher class reports files written, moved or removed
+ * within a directory tree of fixed depth, e.g., an SDS archive. The
+ * implementation uses inotify and is only available on Linux.
+ *
+ * Notifications are read by a background thread as soon as they arrive so
+ * that the kernel queue does not overflow while the caller is busy, e.g.,
+ * scanning the entire archive.
+ */
+class ArchiveWatcher {
+	public:
+		using Files = std::vector<std::string>;
+
+	public:
+		ArchiveWatcher() = default;
+		~ArchiveWatcher();
+
+		ArchiveWatcher(const ArchiveWatcher &) = delete;
+		ArchiveWatcher &operator=(const ArchiveWatcher &) = delete;
+
+	public:
+		/**
+		 * @brief Start watching a directory tree.
+		 * @param path The root directory.
+		 * @param depth The directory level of the files to report, e.g., 4
+		 * for YEAR/NET/STA/CHA.D/file. All directories up to this level are
+		 * watched, newly created directories are added automatically.
+		 * The reader thread is started on success.
+		 * @return Status flag.
+		 */
+		bool open(const std::string &path, int depth);
+
+		void close();
+
+		/**
+		 * @brief Wait for file changes. All changes collected by the reader
+		 * thread since the last call are returned at once.
+		 * @param files Receives the paths of changed files. A path may be
+		 * reported more than once.
+		 * @param timeout Maximum time to wait in seconds.
+		 * @return False if an error occurred.
+		 */
+		bool wait(Files &files, double timeout);
+
+		/**
+		 * @brief Return whether notifications were lost since the last call,
+		 * e.g., due to a kernel queue overflow. The caller should rescan the
+		 * entire tree in that case.
+		 */
+		bool lostEvents();
+
+		size_t watchCount() const { return _watchCount; }
+
+	private:
+		struct Directory {
+			std::string path;
+			int         level;
+		};
+
+		void run();
+		bool readEvents(Files &files);
+		void addWatches(Files &files, const std::string &path, int level,
+		                bool reportFiles);
+
+	private:
+		int                       _fd{-1};
+		int                       _depth{0};
+		// Only accessed by the reader thread once it is running
+		std::map<int, Directory>  _watches;
+		std::atomic<size_t>       _watchCount{0};
+		std::atomic<bool>         _lostEvents{false};
+
+		std::thread               _reader;
+		std::atomic<bool>         _running{false};
+		std::mutex                _mutex;
+		std::condition_variable   _changed;
+		Files                     _pending;
+		bool                      _error{false};
+};
+
+} // ns DataAvailability
+} // ns Seiscomp
+
+#endif // SEISCOMP_DATAAVAILABILITY_WATCHER_H
@@ -301,6 +301,8 @@ class DBTool : public Seiscomp::Client::Application {
 		void createCommandLineDescription() override {
 			commandline().addOption("Messaging", "mode,m", "Listen mode [none, notifier, all]", &_listenMode, "notifier");
 			commandline().addOption("Database", "output,o", "The database connection to write to.", &_databaseWriteConnection);
+			commandline().addOption("Database", "batch-size", "Number of received objects written in one transaction. 1 writes each message without explicit transaction.", &_batchSize, true);
+			commandline().addOption("Database", "batch-time", "Maximum time in seconds, at least 1, received messages are held back before they are written.", &_batchTime, true);
 
 			commandline().addGroup("Import");
 			commandline().addOption("Import", "input,i", "File to import. Provide multiple times to import multiple files.", &_importFiles);
@@ -319,6 +321,17 @@ class DBTool : public Seiscomp::Client::Application {
 
 			_remove = commandline().hasOption("remove");
 
+			if ( _batchSize < 1 ) {
+				cout << "Error: batch size must be at least 1" << endl;
+				return false;
+			}
+
+			// The batch time is checked by the timer every second
+			if ( _batchTime < 1 ) {
+				cout << "Error: batch time must be at least 1 s" << endl;
+				return false;
+			}
+
 			if ( _listenMode != "none" ) {
 				if ( _listenMode == "all" ) {
 					_dbAllObjects = true;
@@ -398,6 +411,10 @@ class DBTool : public Seiscomp::Client::Application {
 		bool run() override {
 			if ( _clearObjects.empty() && !commandline().hasOption("input") ) {
 				// Online mode
+				if ( _batchSize > 1 ) {
+					enableTimer(1);
+				}
+
 				return Application::run();
 			}
 
@@ -463,6 +480,23 @@ class DBTool : public Seiscomp::Client::Application {
 		}
 
 
+		void done() override {
+			// Write pending messages before the connection is closed
+			flushBatch();
+			Application::done();
+		}
+
+
+		void handleTimeout() override {
+			// Write the batch if it would exceed the batch time before the
+			// next timeout
+			if ( !_pending.empty()
+			  && static_cast<double>(_batchTimer.elapsed()) + 1.0 >= _batchTime ) {
+				flushBatch();
+			}
+		}
+
+
 		ServiceProvideMessage *createServiceResponse(ServiceRequestMessage* msg) {
 			DatabaseRequestMessage *dbRequest = DatabaseRequestMessage::Cast(msg);
 			if ( !dbRequest ) {
@@ -491,6 +525,41 @@ class DBTool : public Seiscomp::Client::Application {
 				return;
 			}
 
+			if ( _batchSize > 1 ) {
+				size_t objects = 0;
+				for ( MessageIterator it = msg->iter(); *it; ++it ) {
+					++objects;
+				}
+
+				if ( _pending.empty() ) {
+					_batchTimer.restart();
+				}
+
+				_pending.push_back(msg);
+				_pendingObjects += objects;
+
+				if ( _pendingObjects >= static_cast<size_t>(_batchSize) ) {
+					flushBatch();
+				}
+
+				return;
+			}
+
+			writeMessage(msg);
+		}
+
+		/**
+		 * @brief Writes the content of a message to the database.
+		 * @param transaction Whether the message is written within a
+		 * transaction. Updates and removals of objects which are not
+		 * stored are then skipped instead of reported as failure.
+		 * @param errors If set, the number of objects which could not be
+		 * written is added.
+		 * @return False if at least one object could not be written.
+		 */
+		bool writeMessage(Message *msg, bool transaction = false,
+		                  size_t *errors = nullptr) {
+			size_t failed = 0;
 			DataModel::DatabaseObjectWriter writer(*query());
 			for ( MessageIterator it = msg->iter(); *it; ++it ) {
 				if ( _dbAllObjects ) {
@@ -513,18 +582,114 @@ class DBTool : public Seiscomp::Client::Application {
 							//dbArchive->write(notifier->object(), notifier->parentID());
 							break;
 						case DataModel::OP_REMOVE:
-							query()->remove(notifier->object(), notifier->parentID());
+							if ( transaction && !isStored(notifier) ) {
+								break;
+							}
+							if ( !query()->remove(notifier->object(), notifier->parentID()) ) {
+								++failed;
+							}
 							break;
 						case DataModel::OP_UPDATE:
-							query()->update(notifier->object(), notifier->parentID());
+							if ( transaction && !isStored(notifier) ) {
+								break;
+							}
+							if ( !query()->update(notifier->object(), notifier->parentID()) ) {
+								++failed;
+							}
 							break;
 						default:
 							break;
 					}
 				}
 			}
+
+			failed += static_cast<size_t>(writer.errors());
+			if ( errors ) {
+				*errors += failed;
+			}
+
+			return failed == 0;
 		}
 
+		/**
+		 * @brief Checks whether the object of a notifier is stored. An
+		 * update or removal of an object which is not stored fails as
+		 * before batching. It is ignored and must not cause the rollback
+		 * of the batch.
+		 */
+		bool isStored(DataModel::Notifier *notifier) {
+			if ( query()->objectId(notifier->object(), notifier->parentID())
+			     != DatabaseInterface::INVALID_OID ) {
+				return true;
+			}
+
+			SEISCOMP_DEBUG("Object to %s is not stored, ignoring",
+			               notifier->operation().toString());
+			return false;
+		}
+
+		/**
+		 * @brief Writes all pending messages in one transaction.
+		 *
+		 * If a statement or the commit fails the transaction is rolled back
+		 * and the messages are written again one by one in their original
+		 * order without transaction. A single failing object, e.g. a
+		 * duplicate, then only affects itself as without batching. The
+		 * number of objects which could not be written is logged.
+		 */
+		void flushBatch() {
+			if ( _pending.empty() ) {
+				return;
+			}
+
+			Util::StopWatch timer;
+			IO::DatabaseInterface *db = query()->driver();
+			bool transaction = db && db->beginTransaction();
+			bool success = true;
+			size_t failed = 0;
+
+			for ( auto &msg : _pending ) {
+				if ( !writeMessage(msg.get(), transaction, &failed) ) {
+					success = false;
+					// Without transaction the remaining messages are
+					// written as usual
+					if ( transaction ) {
+						break;
+					}
+				}
+			}
+
+			if ( transaction ) {
+				if ( success ) {
+					success = db->commit();
+				}
+
+				if ( !success ) {
+					db->rollback();
+
+					SEISCOMP_WARNING("Failed to write batch of %zu messages, "
+					                 "writing them one by one", _pending.size());
+					failed = 0;
+					for ( auto &msg : _pending ) {
+						writeMessage(msg.get(), false, &failed);
+					}
+				}
+			}
+
+			if ( failed ) {
+				SEISCOMP_ERROR("Could not write %zu of %zu objects of the batch",
+				               failed, _pendingObjects);
+			}
+
+			SEISCOMP_DEBUG("Wrote %zu messages with %zu objects in %fs",
+			               _pending.size(), _pendingObjects,
+			               static_cast<double>(timer.elapsed()));
+
+			_pending.clear();
+			_pendingObjects = 0;
+		}
+
+
 		bool importDatabase(std::string filename) {
 			XMLArchive ar;
 			if ( filename == "-" ) {
@@ -550,6 +715,7 @@ class DBTool : public Seiscomp::Client::Application {
 			auto msg = Core::Message::Cast(obj);
 			if ( msg ) {
 				handleMessage(msg);
+				flushBatch();
 				return true;
 			}
 
@@ -594,6 +760,12 @@ class DBTool : public Seiscomp::Client::Application {
 		std::string _databaseWriteConnection;
 		std::string _serviceRequestGroup;
 		std::string _serviceProvideGroup;
+
+		int _batchSize{1};
+		double _batchTime{1.0};
+		std::vector<MessagePtr> _pending;
+		size_t _pendingObjects{0};
+		Util::StopWatch _batchTimer;
 };
 
 
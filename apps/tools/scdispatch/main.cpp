@@ -15,6 +15,7 @@
 
 #include <seiscomp/logging/log.h>
 #include <seiscomp/client/application.h>
+#include <seiscomp/io/archive/binarch.h>
 #include <seiscomp/io/archive/xmlarchive.h>
 #include <seiscomp/messaging/connection.h>
 #include <seiscomp/utils/timer.h>
@@ -23,6 +24,8 @@
 #include <seiscomp/datamodel/diff.h>
 #include <seiscomp/datamodel/eventparameters_package.h>
 
+#include <algorithm>
+
 
 using namespace std;
 using namespace Seiscomp;
@@ -32,6 +35,38 @@ using namespace Seiscomp::DataModel;
 typedef map<string, string> RoutingTable;
 
 
+// Maximum number of publicIDs per IN clause
+const size_t MAX_IDS_PER_QUERY = 200;
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+//! Stream buffer which only counts the bytes written
+class ByteCounter : public std::streambuf {
+	public:
+		size_t count() const { return _count; }
+
+	protected:
+		int_type overflow(int_type c) override {
+			if ( !traits_type::eq_int_type(c, traits_type::eof()) ) {
+				++_count;
+			}
+			return traits_type::not_eof(c);
+		}
+
+		std::streamsize xsputn(const char_type *, std::streamsize n) override {
+			_count += n;
+			return n;
+		}
+
+	private:
+		size_t _count{0};
+};
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
+
+
+
+
+
 class BaseObjectDispatcher : protected Visitor {
 	// ----------------------------------------------------------------------
 	//  X'struction
@@ -65,9 +100,26 @@ class BaseObjectDispatcher : protected Visitor {
 
 			object->accept(this);
 
+			flush();
+
 			return _errors == 0;
 		}
 
+		/**
+		 * @brief Sets the limits of a single notifier message. Notifiers
+		 * sent to the same group are collected until one of the limits
+		 * is reached.
+		 * @param maxObjects Maximum number of notifiers per message, 1
+		 * sends each notifier in its own message.
+		 * @param maxBytes Maximum size of the binary encoded notifiers per
+		 * message, 0 disables the limit. A single notifier exceeding the
+		 * limit is sent alone.
+		 */
+		void setBatchLimits(size_t maxObjects, size_t maxBytes) {
+			_batchMaxObjects = maxObjects > 0 ? maxObjects : 1;
+			_batchMaxBytes = maxBytes;
+		}
+
 		void setCreateNotifierMsg(bool createNotifier) {
 			_createNotifier = createNotifier;
 		}
@@ -107,6 +159,89 @@ class BaseObjectDispatcher : protected Visitor {
 			return tmp;
 		}
 
+		/**
+		 * @brief Appends a notifier to the current message. The message is
+		 * sent before if the target group changes or if the notifier would
+		 * exceed the batch limits. Because messages are sent in the order
+		 * the notifiers were appended, parents are still sent before their
+		 * children. Notifiers of messages which could not be sent are
+		 * counted as errors, the appended notifier is always accepted.
+		 */
+		void append(const std::string &group, Notifier *notifier) {
+			if ( _createNotifier ) {
+				_outputNotifier->attach(notifier);
+				return;
+			}
+
+			size_t bytes = 0;
+			if ( _batchMaxBytes > 0 ) {
+				ByteCounter counter;
+				IO::BinaryArchive ar;
+				ar.create(&counter, false);
+				NotifierPtr tmp(notifier);
+				ar << tmp;
+				ar.close();
+				bytes = counter.count();
+			}
+
+			if ( _batch ) {
+				if ( (group != _batchGroup)
+				  || (_batch->size() >= static_cast<int>(_batchMaxObjects))
+				  || (_batchMaxBytes > 0 && _batchBytes + bytes > _batchMaxBytes) ) {
+					flush();
+				}
+			}
+
+			if ( !_batch ) {
+				_batch = new NotifierMessage;
+				_batchGroup = group;
+				_batchBytes = 0;
+			}
+
+			_batch->attach(notifier);
+			_batchBytes += bytes;
+		}
+
+		//! Sends the current message
+		bool flush() {
+			if ( !_batch ) {
+				return true;
+			}
+
+			NotifierMessagePtr msg = _batch;
+			_batch = nullptr;
+
+			if ( _test ) {
+				SEISCOMP_DEBUG("Would send %d notifiers to %s group",
+				               msg->size(), _batchGroup.c_str());
+				return true;
+			}
+
+			SEISCOMP_DEBUG("Send %d notifiers (%zu bytes) to %s group",
+			               msg->size(), _batchBytes, _batchGroup.c_str());
+
+			size_t counter = 0;
+			while ( counter <= 4 ) {
+				if ( _connection->send(_batchGroup, msg.get()) ) {
+					++_msgCount;
+					return true;
+				}
+
+				SEISCOMP_ERROR("Could not send %d notifiers to %s@%s",
+				               msg->size(), _batchGroup.c_str(),
+				               _connection->source().c_str());
+				if ( _connection->isConnected() || SCCoreApp->isExitRequested() ) {
+					break;
+				}
+
+				++counter;
+				sleep(1);
+			}
+
+			_errors += msg->size();
+			return false;
+		}
+
 		void logObject(Object *object, Operation op, const std::string &group,
 		               const std::string &additionalIndent = "") {
 			PublicObject *po = PublicObject::Cast(object);
@@ -168,6 +303,11 @@ class BaseObjectDispatcher : protected Visitor {
 		bool                       _createNotifier{false};
 		int                        _ignoreTypes{};
 		NotifierMessagePtr         _outputNotifier;
+		size_t                     _batchMaxObjects{1};
+		size_t                     _batchMaxBytes{0};
+		NotifierMessagePtr         _batch;
+		std::string                _batchGroup;
+		size_t                     _batchBytes{0};
 };
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -258,35 +398,8 @@ class ObjectDispatcherV1 : public BaseObjectDispatcher {
 			}
 
 			NotifierPtr notif = new Notifier(_parentID, _operation, object);
-
-			if ( _createNotifier ) {
-				_outputNotifier->attach(notif.get());
-				return true;
-			}
-
-			NotifierMessage notifierMessage;
-			notifierMessage.attach(notif.get());
-
-			size_t counter = 0;
-			while ( counter <= 4 ) {
-				if ( _connection->send(targetIt->second, &notifierMessage) ) {
-					++_msgCount;
-					return true;
-				}
-
-				SEISCOMP_ERROR("Could not send object %s to %s@%s",
-				               object->className(), targetIt->second.c_str(),
-				               _connection->source().c_str());
-				if ( _connection->isConnected() ) {
-					break;
-				}
-
-				++counter;
-				sleep(1);
-			}
-
-			++_errors;
-			return false;
+			append(targetIt->second, notif.get());
+			return true;
 		}
 
 
@@ -386,44 +499,58 @@ class ObjectDispatcherV2 : public BaseObjectDispatcher {
 			}
 
 			NotifierPtr notif = new Notifier(_parentID, _operation, object);
+			// With DeleteTree support removing the parent removes all
+			// children, do not descend
+			append(targetIt->second, notif.get());
+			return _operation != OP_REMOVE;
+		}
 
-			if ( _createNotifier ) {
-				_outputNotifier->attach(notif.get());
-				return _operation != OP_REMOVE;
-			}
 
-			NotifierMessage notifierMessage;
-			notifierMessage.attach(notif.get());
+	// ----------------------------------------------------------------------
+	// Private data members
+	// ----------------------------------------------------------------------
+	private:
+		string    _parentID;
+		Operation _operation;
+};
+// <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
-			size_t counter = 0;
-			while ( counter <= 4 ) {
-				if ( _connection->send(targetIt->second, &notifierMessage) ) {
-					++_msgCount;
-					return _operation != OP_REMOVE;
-				}
 
-				SEISCOMP_ERROR("Could not send object %s to %s@%s",
-				               object->className(), targetIt->second.c_str(),
-				               _connection->source().c_str());
-				if ( _connection->isConnected() ) {
-					break;
-				}
 
-				++counter;
-				sleep(1);
+
+
+// >>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>>
+//! Collects the publicIDs of all public objects of a tree per class
+class PublicIDCollector : protected Visitor {
+	public:
+		typedef map<string, vector<string>> IDs;
+
+		PublicIDCollector(Object *object, int ignoreTypes)
+		: Visitor(), _ignoreTypes(ignoreTypes) {
+			object->accept(this);
+		}
+
+	public:
+		const IDs &ids() const { return _ids; }
+
+	protected:
+		bool visit(PublicObject *po) {
+			if ( (_ignoreTypes & BaseObjectDispatcher::Event) && Event::Cast(po) ) {
+				return false;
 			}
 
-			++_errors;
-			return false;
+			// The document root is never stored
+			if ( po->parent() ) {
+				_ids[po->className()].push_back(po->publicID());
+			}
+			return true;
 		}
 
+		virtual void visit(Object*) {}
 
-	// ----------------------------------------------------------------------
-	// Private data members
-	// ----------------------------------------------------------------------
 	private:
-		string    _parentID;
-		Operation _operation;
+		int _ignoreTypes;
+		IDs _ids;
 };
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -451,10 +578,9 @@ class ObjectMerger : public BaseObjectDispatcher {
 	public:
 		bool operator()(Object *object) {
 			_msgCount = 0;
-
+			prefetch(object);
 			bool ret = BaseObjectDispatcher::operator()(object);
-
-			flush();
+			_storedObjects.clear();
 			return ret;
 		}
 
@@ -464,9 +590,6 @@ class ObjectMerger : public BaseObjectDispatcher {
 	// ----------------------------------------------------------------------
 	protected:
 		bool visit(PublicObject *po) {
-			// Each PublicObject in a single message
-			flush();
-
 			PublicObject *parent = po->parent();
 
 			if ( !parent ) {
@@ -505,14 +628,26 @@ class ObjectMerger : public BaseObjectDispatcher {
 
 			_targetGroup = targetIt->second;
 
-			PublicObjectPtr stored = _db->loadObject(po->typeInfo(), po->publicID());
+			PublicObjectPtr stored;
+			string storedParent;
+
+			auto storedIt = _storedObjects.find(po->publicID());
+			if ( storedIt != _storedObjects.end() ) {
+				stored = storedIt->second;
+				storedParent = _storedParents[po->publicID()];
+			}
+			else if ( _prefetchedClasses.find(po->className()) == _prefetchedClasses.end() ) {
+				stored = _db->loadObject(po->typeInfo(), po->publicID());
+				if ( stored ) {
+					storedParent = _db->parentPublicID(stored.get());
+				}
+			}
 
 			if ( !stored ) {
 				write(parent, po, OP_ADD);
 				return true;
 			}
 
-			string storedParent = _db->parentPublicID(stored.get());
 			if ( storedParent != parent->publicID() ) {
 				// Instead of losing information due to a re-parent
 				// we just create a new publicID and so a copy of the underlying
@@ -545,7 +680,6 @@ class ObjectMerger : public BaseObjectDispatcher {
 
 				po = PublicObject::Cast(n->object());
 				if ( po != nullptr ) {
-					flush();
 					targetIt = _routingTable.find(po->className());
 					if ( targetIt != _routingTable.end() && targetIt->second != _targetGroup )
 						_targetGroup = targetIt->second;
@@ -580,54 +714,238 @@ class ObjectMerger : public BaseObjectDispatcher {
 	//  Implementation
 	// ----------------------------------------------------------------------
 	private:
-		bool write(PublicObject *parent, Object *object, Operation op) {
-			++_count;
+		typedef vector<pair<DatabaseInterface::OID, Object*>> Parents;
+
+		/**
+		 * @brief Loads the public objects of the document which are already
+		 * stored along with their children and the publicIDs of their
+		 * stored parents. One query resolves up to MAX_IDS_PER_QUERY
+		 * objects of the same class or children of the same type. Objects
+		 * of classes which could not be queried are loaded individually
+		 * while visiting them.
+		 */
+		void prefetch(Object *object) {
+			_storedParents.clear();
+			_storedObjects.clear();
+			_prefetchedClasses.clear();
+
+			DatabaseInterface *db = _db->driver();
+			if ( !db ) {
+				return;
+			}
 
-			logObject(object, op, _targetGroup);
+			Util::StopWatch timer;
+			PublicIDCollector collector(object, _ignoreTypes);
+			size_t queries = 0;
+			size_t total = 0;
+
+			for ( const auto &item : collector.ids() ) {
+				const string &table = item.first;
+				const vector<string> &ids = item.second;
+				bool success = true;
+				vector<string> storedIDs;
+
+				for ( size_t first = 0; first < ids.size(); first += MAX_IDS_PER_QUERY ) {
+					size_t last = std::min(first + MAX_IDS_PER_QUERY, ids.size());
+
+					string q = "select PObject." + db->convertColumnName("publicID") +
+					           ",PParent." + db->convertColumnName("publicID") + " "
+					           "from " + table + ",PublicObject as PObject,"
+					           "PublicObject as PParent "
+					           "where " + table + "._oid=PObject._oid and " +
+					           table + "._parent_oid=PParent._oid and "
+					           "PObject." + db->convertColumnName("publicID") +
+					           " in (" + idList(ids, first, last) + ")";
+
+					++queries;
+
+					if ( !db->beginQuery(q.c_str()) ) {
+						SEISCOMP_WARNING("Could not prefetch %s objects, looking "
+						                 "them up individually", table.c_str());
+						success = false;
+						break;
+					}
 
-			NotifierPtr notif = new Notifier(parent->publicID(), op, object);
+					while ( db->fetchRow() ) {
+						const char *publicID = static_cast<const char*>(db->getRowField(0));
+						const char *parentID = static_cast<const char*>(db->getRowField(1));
+						if ( publicID && parentID ) {
+							_storedParents[publicID] = parentID;
+							storedIDs.push_back(publicID);
+						}
+					}
 
-			if ( _createNotifier ) {
-				_outputNotifier->attach(notif.get());
-				return true;
+					db->endQuery();
+				}
+
+				if ( success ) {
+					success = loadObjects(table, storedIDs, queries);
+				}
+
+				if ( success ) {
+					_prefetchedClasses.insert(table);
+				}
+
+				total += ids.size();
 			}
 
-			if ( !_msg ) _msg = new NotifierMessage;
+			SEISCOMP_INFO("Prefetched %zu of %zu objects from database with %zu "
+			              "queries in %s", _storedObjects.size(), total, queries,
+			              (Core::Time() + timer.elapsed()).toString("%T.%f"));
+		}
 
-			_msg->attach(notif.get());
+		//! Loads the stored objects of a class with their children
+		bool loadObjects(const string &table, const vector<string> &ids,
+		                 size_t &queries) {
+			auto factory = ClassFactory::FindByClassName(table.c_str());
+			if ( !factory || !factory->typeInfo() ) {
+				return false;
+			}
 
-			return false;
+			DatabaseInterface *db = _db->driver();
+			const RTTI *type = factory->typeInfo();
+			Parents parents;
+
+			for ( size_t first = 0; first < ids.size(); first += MAX_IDS_PER_QUERY ) {
+				size_t last = std::min(first + MAX_IDS_PER_QUERY, ids.size());
+
+				string q = "select P" + table + "." + db->convertColumnName("publicID") +
+				           "," + table + ".* from " + table + ",PublicObject as P" + table +
+				           " where " + table + "._oid=P" + table + "._oid and P" + table +
+				           "." + db->convertColumnName("publicID") +
+				           " in (" + idList(ids, first, last) + ")";
+
+				++queries;
+				auto it = _db->getObjectIterator(q, *type);
+				for ( ; *it; ++it ) {
+					auto po = PublicObject::Cast(*it);
+					if ( !po ) {
+						continue;
+					}
+
+					_storedObjects[po->publicID()] = po;
+					// Objects taken from the object pool have been loaded
+					// as children of another object before
+					if ( !it.cached() ) {
+						parents.emplace_back(it.oid(), po);
+					}
+				}
+				it.close();
+			}
+
+			loadChildren(parents, queries);
+			return true;
 		}
 
-		void flush() {
-			if ( !_msg || _createNotifier ) { // redundant check but better safe...
+		// Same as DatabaseReader::load but for all parents of the same
+		// type at once
+		void loadChildren(const Parents &parents, size_t &queries) {
+			if ( parents.empty() ) {
 				return;
 			}
-			if ( _test ) {
-				SEISCOMP_DEBUG("Would send %d notifiers to %s group",
-				               _msg->size(), _targetGroup.c_str());
-				_msg = nullptr;
+
+			auto meta = parents.front().second->meta();
+			if ( !meta ) {
 				return;
 			}
 
-			SEISCOMP_DEBUG("Send %d notifiers to %s group",
-			               _msg->size(), _targetGroup.c_str());
+			DatabaseInterface *db = _db->driver();
 
-			while ( !SCCoreApp->isExitRequested() ) {
-				if ( _connection->send(_targetGroup.c_str(), _msg.get()) ) {
-					_msg = nullptr;
-					++_msgCount;
-					return;
+			map<DatabaseInterface::OID, Object*> parentMap;
+			for ( const auto &[oid, obj] : parents ) {
+				parentMap[oid] = obj;
+			}
+
+			for ( size_t i = 0; i < meta->propertyCount(); ++i ) {
+				auto prop = meta->property(i);
+				if ( !prop->isArray() || !prop->isClass() ) {
+					continue;
 				}
 
-				SEISCOMP_ERROR("Could not send message to %s@%s",
-				               _targetGroup.c_str(), _connection->source().c_str());
+				auto factory = ClassFactory::FindByClassName(prop->type().c_str());
+				if ( !factory ) {
+					continue;
+				}
 
-				sleep(1);
+				const RTTI *type = factory->typeInfo();
+				string table = type->className();
+				Parents children;
+
+				for ( size_t first = 0; first < parents.size(); first += MAX_IDS_PER_QUERY ) {
+					size_t last = std::min(first + MAX_IDS_PER_QUERY, parents.size());
+
+					string oidList;
+					for ( size_t p = first; p < last; ++p ) {
+						if ( p > first ) {
+							oidList += ",";
+						}
+						oidList += Core::toString(parents[p].first);
+					}
+
+					string q;
+					if ( type->isTypeOf(PublicObject::TypeInfo()) ) {
+						q = "select P" + table + "." + db->convertColumnName("publicID") +
+						    "," + table + ".* from " + table + ",PublicObject as P" + table +
+						    " where " + table + "._oid=P" + table + "._oid and ";
+					}
+					else {
+						q = "select " + table + ".* from " + table + " where ";
+					}
+
+					q += table + "._parent_oid in (" + oidList + ") "
+					     "order by " + table + "._oid";
+
+					++queries;
+					auto it = _db->getObjectIterator(q, *type);
+					for ( ; *it; ++it ) {
+						auto pit = parentMap.find(it.parentOid());
+						if ( pit == parentMap.end() ) {
+							continue;
+						}
+
+						Object *obj = *it;
+						if ( it.cached() ) {
+							// A document object loaded before by its
+							// publicID along with its children. It is
+							// attached if it has no parent yet, the same
+							// rule as in scxmldump which additionally loads
+							// the children of objects requested without.
+							if ( !obj->parent() ) {
+								prop->arrayAddObject(pit->second, obj);
+							}
+							continue;
+						}
+
+						if ( prop->arrayAddObject(pit->second, obj) ) {
+							children.emplace_back(it.oid(), obj);
+						}
+					}
+					it.close();
+				}
+
+				loadChildren(children, queries);
 			}
+		}
+
+		string idList(const vector<string> &ids, size_t first, size_t last) const {
+			string list;
+			for ( size_t i = first; i < last; ++i ) {
+				if ( i > first ) {
+					list += ",";
+				}
+				list += "'" + _db->toString(ids[i]) + "'";
+			}
+			return list;
+		}
+
+		bool write(PublicObject *parent, Object *object, Operation op) {
+			++_count;
+
+			logObject(object, op, _targetGroup);
 
-			_msg = nullptr;
-			++_errors;
+			NotifierPtr notif = new Notifier(parent->publicID(), op, object);
+			append(_targetGroup, notif.get());
+			return true;
 		}
 
 		void logObject(Object *object, Operation op, const std::string &group) {
@@ -642,11 +960,13 @@ class ObjectMerger : public BaseObjectDispatcher {
 	// Private data members
 	// ----------------------------------------------------------------------
 	private:
-		DatabaseReader     *_db;
-		NotifierMessagePtr  _msg;
-		string              _targetGroup;
-		string              _inputIndent;
-		bool                _allowRemove;
+		DatabaseReader                 *_db;
+		map<string, string>             _storedParents;
+		map<string, PublicObjectPtr>    _storedObjects;
+		set<string>                     _prefetchedClasses;
+		string                          _targetGroup;
+		string                          _inputIndent;
+		bool                            _allowRemove;
 };
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
 
@@ -731,6 +1051,16 @@ class DispatchTool : public Seiscomp::Client::Application {
 			                        "object:group pairs.",
 			                        &_routingTableStr, false);
 			commandline().addOption("Dispatch", "test", "Do not send any object.");
+			commandline().addOption("Dispatch", "batch-size",
+			                        "Maximum number of objects sent to the same "
+			                        "group in one message. 1 sends each object "
+			                        "in its own message.",
+			                        &_batchSize, true);
+			commandline().addOption("Dispatch", "batch-bytes",
+			                        "Maximum size in bytes of the binary encoded "
+			                        "objects in one message. 0 disables the "
+			                        "limit.",
+			                        &_batchBytes, true);
 		}
 
 
@@ -784,6 +1114,18 @@ class DispatchTool : public Seiscomp::Client::Application {
 				return false;
 			}
 
+			if ( _batchSize < 1 ) {
+				SEISCOMP_ERROR("Invalid batch size: %d, must be at least 1",
+				               _batchSize);
+				return false;
+			}
+
+			if ( _batchBytes < 0 ) {
+				SEISCOMP_ERROR("Invalid batch bytes: %d, must not be negative",
+				               _batchBytes);
+				return false;
+			}
+
 			if ( commandline().hasOption("test") ||
 			     commandline().hasOption("create-notifier") ) {
 				setMessagingEnabled(false);
@@ -864,6 +1206,8 @@ class DispatchTool : public Seiscomp::Client::Application {
 			}
 
 			dispatcher->setRoutingTable(_routingTable);
+			dispatcher->setBatchLimits(static_cast<size_t>(_batchSize),
+			                           static_cast<size_t>(_batchBytes));
 
 			if ( commandline().hasOption("no-events") ) {
 				dispatcher->setSetIgnoreObject(BaseObjectDispatcher::Event);
@@ -887,6 +1231,7 @@ class DispatchTool : public Seiscomp::Client::Application {
 			timer.restart();
 
 			(*dispatcher)(doc.get());
+			Core::TimeSpan elapsed = timer.elapsed();
 
 			if ( commandline().hasOption("create-notifier") ) {
 				NotifierMessagePtr msg = dispatcher->getNotifierMsg();
@@ -901,7 +1246,11 @@ class DispatchTool : public Seiscomp::Client::Application {
 			              dispatcher->count(), totalCount, dispatcher->errors());
 			SEISCOMP_INFO("Time needed to dispatch %d objects: %s",
 			              dispatcher->count(),
-			              (Core::Time() + timer.elapsed()).toString("%T.%f"));
+			              (Core::Time() + elapsed).toString("%T.%f"));
+			if ( static_cast<double>(elapsed) > 0 ) {
+				SEISCOMP_INFO("Dispatch throughput: %.1f objects/s",
+				              dispatcher->count() / static_cast<double>(elapsed));
+			}
 			if ( !testMode ) {
 				SEISCOMP_NOTICE("Sent %d messages", dispatcher->messages());
 			}
@@ -920,6 +1269,8 @@ class DispatchTool : public Seiscomp::Client::Application {
 		string               _routingTableStr;
 		RoutingTable         _routingTable;
 		Operation            _operation;
+		int                  _batchSize{1000};
+		int                  _batchBytes{524288};
 
 };
 // <<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<<
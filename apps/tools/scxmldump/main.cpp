@@ -17,6 +17,7 @@
 #include <seiscomp/logging/log.h>
 #include <seiscomp/client/application.h>
 #include <seiscomp/io/archive/xmlarchive.h>
+#include <seiscomp/datamodel/databasequery.h>
 #include <seiscomp/datamodel/inventory.h>
 #include <seiscomp/datamodel/config.h>
 #include <seiscomp/datamodel/journaling.h>
@@ -32,8 +33,16 @@
 #include <seiscomp/datamodel/amplitude.h>
 #include <seiscomp/datamodel/focalmechanism.h>
 #include <seiscomp/datamodel/momenttensor.h>
-
+#include <seiscomp/datamodel/comment.h>
+#include <seiscomp/datamodel/eventdescription.h>
+
+#include <algorithm>
+#include <condition_variable>
+#include <fstream>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <thread>
 
 
 using namespace std;
@@ -157,6 +166,303 @@ void readTree(DatabaseArchive *ar, PublicObject *obj) {
 }
 
 
+// Maximum number of IDs per IN clause
+const size_t MAX_IDS_PER_QUERY = 200;
+// Number of events or origins whose objects are loaded together
+const size_t EVENT_BATCH_SIZE = 100;
+
+
+/**
+ * Loads public objects and their child trees with one query per class and
+ * up to MAX_IDS_PER_QUERY publicIDs or parent objects instead of one query
+ * per object. All loaded objects are cached by publicID until clear() is
+ * called.
+ */
+class BatchLoader {
+	public:
+		void setArchive(DatabaseArchive *ar) {
+			_ar = ar;
+		}
+
+		/**
+		 * Loads all objects of the given type which have not yet been
+		 * requested. Objects not found are remembered as well.
+		 * @param childTypes If set, restricts the direct children to load
+		 *                   to the given class names.
+		 */
+		void load(const RTTI &type, const vector<string> &publicIDs,
+		          bool withChildren, const set<string> *childTypes = nullptr) {
+			vector<string> ids;
+			for ( const auto &publicID : publicIDs ) {
+				if ( !publicID.empty() && _objects.find(publicID) == _objects.end() ) {
+					_objects[publicID] = Entry();
+					ids.push_back(publicID);
+				}
+			}
+
+			if ( ids.empty() || !_ar ) {
+				return;
+			}
+
+			auto db = _ar->driver();
+			string table = type.className();
+			Parents parents;
+
+			for ( size_t first = 0; first < ids.size(); first += MAX_IDS_PER_QUERY ) {
+				size_t last = min(first + MAX_IDS_PER_QUERY, ids.size());
+
+				string q = "select P" + table + "." + db->convertColumnName("publicID") +
+				           "," + table + ".* from " + table + ",PublicObject as P" + table +
+				           " where " + table + "._oid=P" + table + "._oid and P" + table +
+				           "." + db->convertColumnName("publicID") +
+				           " in (" + idList(ids, first, last) + ")";
+
+				++_queries;
+				auto it = _ar->getObjectIterator(q, type);
+				for ( ; *it; ++it ) {
+					auto po = PublicObject::Cast(*it);
+					if ( !po ) {
+						continue;
+					}
+
+					auto &entry = _objects[po->publicID()];
+					entry.object = po;
+					// Objects taken from the object pool have been loaded
+					// completely before
+					entry.withChildren = withChildren || it.cached();
+					if ( withChildren && !it.cached() ) {
+						parents.emplace_back(it.oid(), po);
+					}
+				}
+				it.close();
+			}
+
+			loadChildren(parents, childTypes);
+		}
+
+		//! Loads the amplitudes referencing the given picks
+		void loadAmplitudesForPicks(const vector<string> &pickIDs) {
+			vector<string> ids;
+			for ( const auto &pickID : pickIDs ) {
+				if ( _pickAmplitudes.find(pickID) == _pickAmplitudes.end() ) {
+					_pickAmplitudes[pickID];
+					ids.push_back(pickID);
+				}
+			}
+
+			if ( ids.empty() || !_ar ) {
+				return;
+			}
+
+			auto db = _ar->driver();
+
+			for ( size_t first = 0; first < ids.size(); first += MAX_IDS_PER_QUERY ) {
+				size_t last = min(first + MAX_IDS_PER_QUERY, ids.size());
+
+				string q = "select PAmplitude." + db->convertColumnName("publicID") +
+				           ",Amplitude.* from Amplitude,PublicObject as PAmplitude "
+				           "where Amplitude._oid=PAmplitude._oid and Amplitude." +
+				           db->convertColumnName("pickID") +
+				           " in (" + idList(ids, first, last) + ")";
+
+				++_queries;
+				auto it = _ar->getObjectIterator(q, Amplitude::TypeInfo());
+				for ( ; *it; ++it ) {
+					auto amp = Amplitude::Cast(*it);
+					if ( amp ) {
+						_pickAmplitudes[amp->pickID()].push_back(amp);
+					}
+				}
+				it.close();
+			}
+		}
+
+		/**
+		 * Looks up a requested object.
+		 * @return False if the object has not been requested, true
+		 *         otherwise. The object is nullptr if it does not exist.
+		 */
+		bool find(PublicObjectPtr &object, const string &publicID,
+		          bool withChildren) const {
+			auto it = _objects.find(publicID);
+			if ( it == _objects.end() ) {
+				return false;
+			}
+
+			if ( withChildren && it->second.object && !it->second.withChildren ) {
+				return false;
+			}
+
+			object = it->second.object;
+			return true;
+		}
+
+		bool hasChildren(const string &publicID) const {
+			auto it = _objects.find(publicID);
+			return it != _objects.end() && it->second.withChildren;
+		}
+
+		//! Returns the amplitudes of a pick or nullptr if they have not
+		//! been requested
+		const vector<AmplitudePtr> *amplitudesForPick(const string &pickID) const {
+			auto it = _pickAmplitudes.find(pickID);
+			return it != _pickAmplitudes.end() ? &it->second : nullptr;
+		}
+
+		void clear() {
+			_objects.clear();
+			_pickAmplitudes.clear();
+		}
+
+		size_t queries() const {
+			return _queries;
+		}
+
+	private:
+		typedef vector<pair<DatabaseInterface::OID, Object*>> Parents;
+
+		struct Entry {
+			PublicObjectPtr object;
+			bool            withChildren{false};
+		};
+
+		string idList(const vector<string> &ids, size_t first, size_t last) const {
+			string list;
+			for ( size_t i = first; i < last; ++i ) {
+				if ( i > first ) {
+					list += ",";
+				}
+				list += "'" + _ar->toString(ids[i]) + "'";
+			}
+			return list;
+		}
+
+		// Same as readTree but for all parents of the same type at once
+		void loadChildren(const Parents &parents, const set<string> *childTypes) {
+			if ( parents.empty() ) {
+				return;
+			}
+
+			auto meta = parents.front().second->meta();
+			if ( !meta ) {
+				return;
+			}
+
+			auto db = _ar->driver();
+
+			map<DatabaseInterface::OID, Object*> parentMap;
+			for ( const auto &[oid, obj] : parents ) {
+				parentMap[oid] = obj;
+			}
+
+			auto properyCount = meta->propertyCount();
+			for ( size_t i = 0; i < properyCount; ++i ) {
+				auto prop = meta->property(i);
+				if ( !prop->isArray() || !prop->isClass() ) {
+					continue;
+				}
+
+				if ( childTypes && childTypes->find(prop->type()) == childTypes->end() ) {
+					continue;
+				}
+
+				auto factory = ClassFactory::FindByClassName(prop->type());
+				if ( !factory ) {
+					continue;
+				}
+
+				const RTTI *type = factory->typeInfo();
+				string table = type->className();
+				Parents children;
+
+				for ( size_t first = 0; first < parents.size(); first += MAX_IDS_PER_QUERY ) {
+					size_t last = min(first + MAX_IDS_PER_QUERY, parents.size());
+
+					string oidList;
+					for ( size_t p = first; p < last; ++p ) {
+						if ( p > first ) {
+							oidList += ",";
+						}
+						oidList += Core::toString(parents[p].first);
+					}
+
+					string q;
+					if ( type->isTypeOf(PublicObject::TypeInfo()) ) {
+						q = "select P" + table + "." + db->convertColumnName("publicID") +
+						    "," + table + ".* from " + table + ",PublicObject as P" + table +
+						    " where " + table + "._oid=P" + table + "._oid and ";
+					}
+					else {
+						q = "select " + table + ".* from " + table + " where ";
+					}
+
+					q += table + "._parent_oid in (" + oidList + ") "
+					     "order by " + table + "._oid";
+
+					++_queries;
+					auto it = _ar->getObjectIterator(q, *type);
+					for ( ; *it; ++it ) {
+						auto pit = parentMap.find(it.parentOid());
+						if ( pit == parentMap.end() ) {
+							continue;
+						}
+
+						Object *obj = *it;
+						if ( it.cached() ) {
+							// An object requested before by its publicID,
+							// e.g., a preferred magnitude. As in scdispatch
+							// it is attached if it has no parent yet. Its
+							// children are loaded unless this happened
+							// before.
+							if ( obj->parent() || !prop->arrayAddObject(pit->second, obj) ) {
+								continue;
+							}
+
+							auto po = PublicObject::Cast(obj);
+							auto entry = po ? _objects.find(po->publicID()) : _objects.end();
+							if ( entry != _objects.end() ) {
+								if ( entry->second.withChildren ) {
+									continue;
+								}
+								entry->second.withChildren = true;
+							}
+
+							children.emplace_back(it.oid(), obj);
+							continue;
+						}
+
+						if ( prop->arrayAddObject(pit->second, obj) ) {
+							children.emplace_back(it.oid(), obj);
+						}
+					}
+					it.close();
+				}
+
+				loadChildren(children, nullptr);
+			}
+		}
+
+	private:
+		DatabaseArchive                  *_ar{nullptr};
+		map<string, Entry>                _objects;
+		map<string, vector<AmplitudePtr>> _pickAmplitudes;
+		size_t                            _queries{0};
+};
+
+
+//! A batch of IDs loaded and written at once
+struct Batch {
+	enum Type {
+		Events,
+		Origins,
+		Picks
+	};
+
+	Type           type;
+	vector<string> ids;
+};
+
+
 struct Node {
 	const RTTI  *typeInfo;
 	list<Node*>  parents;
@@ -374,6 +680,16 @@ class XMLDump : public Seiscomp::Client::Application {
 				setLoggingToStdErr(true);
 			}
 
+			if ( _settings.jobs < 1 ) {
+				cerr << "Invalid number of jobs: " << _settings.jobs << endl;
+				return false;
+			}
+
+			if ( _settings.jobs > 1 && databaseURI().empty() ) {
+				cerr << "Parallel jobs require a database URI (-d)" << endl;
+				return false;
+			}
+
 			string previousStdinParam;
 			if ( !readIDParam(_publicIDs, previousStdinParam, _settings.publicIDParam, "public-id")
 			  || !readIDParam(_stationIDs, previousStdinParam, _settings.stationIDParam, "stations")
@@ -386,47 +702,214 @@ class XMLDump : public Seiscomp::Client::Application {
 			return true;
 		}
 
+		/**
+		 * Serializes a single object into an SCML document and splits the
+		 * document into the header up to and including the opening
+		 * seiscomp tag, the object element and the footer.
+		 */
+		bool serialize(PublicObject *po, string &header, string &body,
+		               string &footer) {
+			stringbuf buf;
+			XMLArchive ar;
+			ar.setFormattedOutput(_settings.formatted);
+			if ( !ar.create(&buf) ) {
+				return false;
+			}
+
+			ar << po;
+			ar.close();
+
+			string doc = buf.str();
+			size_t root = doc.find("<seiscomp");
+			size_t bodyStart = root != string::npos ? doc.find('>', root) : string::npos;
+			size_t bodyEnd = doc.rfind("</seiscomp>");
+			if ( bodyStart == string::npos || bodyEnd == string::npos
+			  || bodyEnd <= bodyStart ) {
+				return false;
+			}
+
+			++bodyStart;
+			header = doc.substr(0, bodyStart);
+			body = doc.substr(bodyStart, bodyEnd - bodyStart);
+			footer = doc.substr(bodyEnd);
+			return true;
+		}
+
+		//! Opens the output and writes the document header if required
+		bool beginDocument(const string &header, const string &footer) {
+			if ( _out ) {
+				return true;
+			}
+
+			if ( _settings.prependDatasize ) {
+				_out = &_bufferOut;
+			}
+			else if ( _settings.outputFile == "-" ) {
+				_out = &cout;
+			}
+			else {
+				_file.open(_settings.outputFile.c_str(), ios::out | ios::trunc);
+				if ( !_file.is_open() ) {
+					SEISCOMP_ERROR("Could not create output file '%s'",
+					               _settings.outputFile);
+					return false;
+				}
+				_out = &_file;
+			}
+
+			*_out << header;
+			_footer = footer;
+			return true;
+		}
+
 		bool write(PublicObject *po) {
-			if ( !_archive ) {
-				_archive = new XMLArchive();
-				_archive->setFormattedOutput(_settings.formatted);
-
-				if ( _settings.prependDatasize ) {
-					if ( !_archive->create(&_archiveBuf) ) {
-						SEISCOMP_ERROR("Could not create output file '%s'",
-						               _settings.outputFile);
-						delete _archive;
-						_archive = nullptr;
-						return false;
-					}
+			if ( !po ) {
+				return true;
+			}
+
+			string header, body, footer;
+			if ( !serialize(po, header, body, footer) ) {
+				SEISCOMP_ERROR("Could not serialize %s", po->className());
+				return false;
+			}
+
+			if ( !beginDocument(header, footer) ) {
+				return false;
+			}
+
+			*_out << body;
+			return _out->good();
+		}
+
+		//! A serialized partial EventParameters object
+		struct Fragment {
+			string header;
+			string footer;
+			// The opening tag, the child elements and the closing tag
+			string open;
+			string inner;
+			string close;
+		};
+
+		/**
+		 * Removes all top-level objects already contained in ids from ep
+		 * and adds the IDs of the remaining ones.
+		 * @return False if no object remains
+		 */
+		static bool claimObjects(EventParameters *ep, set<string> &ids) {
+			auto meta = ep->meta();
+			bool empty = true;
+
+			for ( size_t i = 0; meta && i < meta->propertyCount(); ++i ) {
+				auto prop = meta->property(i);
+				if ( !prop->isArray() || !prop->isClass() ) {
+					continue;
 				}
-				else {
-					if ( !_archive->create(_settings.outputFile.c_str()) ) {
-						SEISCOMP_ERROR("Could not create output file '%s'",
-						               _settings.outputFile);
-						delete _archive;
-						_archive = nullptr;
-						return false;
+
+				for ( size_t c = 0; c < prop->arrayElementCount(ep); ) {
+					auto po = PublicObject::Cast(prop->arrayObject(ep, static_cast<int>(c)));
+					if ( po && ids.find(po->publicID()) != ids.end() ) {
+						prop->arrayRemoveObject(ep, static_cast<int>(c));
+						continue;
+					}
+
+					if ( po ) {
+						ids.insert(po->publicID());
 					}
+
+					empty = false;
+					++c;
 				}
 			}
 
+			return !empty;
+		}
+
+		bool serializeEventParameters(EventParameters *ep, Fragment &fragment) {
+			string body;
+			if ( !serialize(ep, fragment.header, body, fragment.footer) ) {
+				SEISCOMP_ERROR("Could not serialize %s", ep->className());
+				return false;
+			}
 
-			if ( po ) {
-				*_archive << po;
+			size_t open = body.find('>');
+			size_t close = body.rfind("</EventParameters>");
+			if ( open == string::npos || close == string::npos || close <= open ) {
+				SEISCOMP_ERROR("Unexpected %s serialization", ep->className());
+				return false;
 			}
 
+			// Keep the indentation of the closing tag with the footer
+			size_t innerEnd = body.find_last_not_of(" \t\r\n", close - 1);
+			innerEnd = innerEnd == string::npos || innerEnd < open ? open + 1 : innerEnd + 1;
+
+			fragment.open = body.substr(0, open + 1);
+			fragment.inner = body.substr(open + 1, innerEnd - open - 1);
+			fragment.close = body.substr(innerEnd);
 			return true;
 		}
 
+		/**
+		 * Writes a partial EventParameters object to the output. All
+		 * fragments written until endEventParameters() is called end up in
+		 * one EventParameters element.
+		 */
+		bool writeEventParameters(const Fragment &fragment) {
+			if ( !beginDocument(fragment.header, fragment.footer) ) {
+				return false;
+			}
+
+			if ( !_epOpen ) {
+				*_out << fragment.open;
+				_epFooter = fragment.close;
+				_epOpen = true;
+			}
+
+			*_out << fragment.inner << flush;
+			return _out->good();
+		}
+
+		/**
+		 * Writes a batch of event parameters. Top-level objects already
+		 * written by a previous batch are skipped. This way only one batch
+		 * needs to be kept in memory.
+		 */
+		bool streamEventParameters(EventParameters *ep) {
+			if ( !claimObjects(ep, _streamedIDs) ) {
+				return true;
+			}
+
+			Fragment fragment;
+			return serializeEventParameters(ep, fragment)
+			    && writeEventParameters(fragment);
+		}
+
+		bool endEventParameters() {
+			if ( !_epOpen ) {
+				return true;
+			}
+
+			*_out << _epFooter;
+			_epOpen = false;
+			_epFooter.clear();
+			return _out->good();
+		}
+
 		bool flushArchive() {
-			if ( !_archive ) {
+			if ( !_out ) {
 				return false;
 			}
 
-			_archive->close();
-			delete _archive;
-			_archive = nullptr;
+			endEventParameters();
+			*_out << _footer << flush;
+			_footer.clear();
+			_streamedIDs.clear();
+
+			if ( _out == &_file ) {
+				_file.close();
+			}
+
+			_out = nullptr;
 
 			if ( !_settings.prependDatasize ) {
 				return true;
@@ -804,71 +1287,183 @@ class XMLDump : public Seiscomp::Client::Application {
 			return true;
 		}
 
-		bool dumpEPAndJournal() {
-			// collection of publicIDs for which we might want the
-			// journal to be dumped (if journal output is requested).
-			EventParametersPtr ep;
-			if ( !_eventIDs.empty() ) {
-				if ( !ep ) {
-					SEISCOMP_INFO("Dumping EventParameters");
-					ep = new EventParameters;
+		static void addBatches(vector<Batch> &batches, Batch::Type type,
+		                       const vector<string> &ids) {
+			for ( size_t first = 0; first < ids.size(); first += EVENT_BATCH_SIZE ) {
+				size_t last = min(first + EVENT_BATCH_SIZE, ids.size());
+				batches.push_back({type, vector<string>(ids.begin() + first,
+				                                        ids.begin() + last)});
+			}
+		}
+
+		/**
+		 * Loads the batches with multiple worker threads, each with its
+		 * own database connection. The batches are written by the calling
+		 * thread in their order, so the output is the same as with one
+		 * job. Workers do not run ahead of the writer by more than two
+		 * batches each to bound the memory.
+		 */
+		bool dumpEventParameters(const vector<Batch> &batches) {
+			struct Result {
+				bool               done{false};
+				EventParametersPtr ep;
+			};
+
+			vector<Result> results(batches.size());
+			size_t jobs = min(static_cast<size_t>(_settings.jobs), batches.size());
+			size_t maxPending = 2 * jobs;
+			size_t next = 0;
+			size_t written = 0;
+			bool abort = false;
+			mutex resultMutex;
+			condition_variable resultCondition;
+
+			SEISCOMP_INFO("Dumping %zu batches with %zu jobs", batches.size(), jobs);
+
+			// The object pool is not shared between threads. Objects are
+			// looked up through their parents instead.
+			PublicObject::SetRegistrationEnabled(false);
+
+			auto work = [&](size_t id) {
+				PublicObject::SetRegistrationEnabled(false);
+
+				DatabaseInterfacePtr db = DatabaseInterface::Open(databaseURI().c_str());
+				if ( !db ) {
+					SEISCOMP_ERROR("[%zu] Could not open database connection", id);
+					lock_guard<mutex> l(resultMutex);
+					abort = true;
+					resultCondition.notify_all();
+					return;
 				}
 
-				for ( const auto &publicID : _eventIDs ) {
-					EventPtr event = Event::Cast(PublicObjectPtr(
-						query()->getObject(Event::TypeInfo(), publicID)));
-					if ( event ) {
-						addEvent(ep.get(), event.get());
-					}
-					else {
-						SEISCOMP_ERROR("Event with ID '%s' has not been found", publicID.c_str());
+				DatabaseQueryPtr dbQuery = new DatabaseQuery(db.get());
+				Builder builder(_settings, dbQuery.get());
+
+				while ( true ) {
+					size_t idx;
+					{
+						unique_lock<mutex> l(resultMutex);
+						resultCondition.wait(l, [&]() {
+							return abort || next >= batches.size()
+							    || next < written + maxPending;
+						});
+
+						if ( abort || next >= batches.size() ) {
+							break;
+						}
+
+						if ( isExitRequested() ) {
+							abort = true;
+							resultCondition.notify_all();
+							break;
+						}
+
+						idx = next++;
 					}
+
+					Result result;
+					result.ep = builder.load(batches[idx]);
+					result.done = true;
+
+					lock_guard<mutex> l(resultMutex);
+					results[idx] = std::move(result);
+					resultCondition.notify_all();
 				}
+
+				SEISCOMP_DEBUG("[%zu] Loaded event parameters with %zu batch "
+				               "queries", id, builder.queries());
+			};
+
+			vector<thread> workers;
+			for ( size_t i = 0; i < jobs; ++i ) {
+				workers.emplace_back(work, i);
 			}
 
-			if ( ! _originIDs.empty() ) {
-				if ( ! ep ) {
-					SEISCOMP_INFO("Dumping EventParameters");
-					ep = new EventParameters;
+			bool success = true;
+			for ( size_t i = 0; i < batches.size(); ++i ) {
+				Result result;
+				{
+					unique_lock<mutex> l(resultMutex);
+					resultCondition.wait(l, [&]() {
+						return results[i].done || abort;
+					});
+
+					if ( !results[i].done ) {
+						success = false;
+						break;
+					}
+
+					result = std::move(results[i]);
+					results[i] = Result();
+					written = i + 1;
+					resultCondition.notify_all();
 				}
 
-				for ( const auto &publicID : _originIDs ) {
-					OriginPtr origin = Origin::Cast(PublicObjectPtr(
-						query()->getObject(Origin::TypeInfo(), publicID)));
-					if ( origin ) {
-						addOrigin(ep.get(), origin.get());
-					}
-					else {
-						SEISCOMP_ERROR("Origin with ID '%s' has not been found", publicID.c_str());
-					}
+				// Objects shared by batches are claimed by the first batch
+				// written as in the serial dump
+				if ( !result.ep || !streamEventParameters(result.ep.get()) ) {
+					success = false;
+					break;
 				}
 			}
 
-			if ( !_pickIDs.empty() ) {
-				if ( !ep ) {
-					SEISCOMP_INFO("Dumping EventParameters");
-					ep = new EventParameters;
-				}
+			{
+				lock_guard<mutex> l(resultMutex);
+				abort = true;
+				resultCondition.notify_all();
+			}
 
-				for ( const auto &publicID : _pickIDs ) {
-					if ( _pickIDSet.find(publicID) != _pickIDSet.end() ) {
-						SEISCOMP_INFO("Pick '%s' already exported", publicID.c_str());
-					}
+			for ( auto &worker : workers ) {
+				worker.join();
+			}
 
-					PickPtr pick = Pick::Cast(PublicObjectPtr(
-					    query()->getObject(Pick::TypeInfo(), publicID)));
-					if ( pick ) {
-						SEISCOMP_INFO("Dumping Pick '%s'", pick->publicID().c_str());
-						ep->add(pick.get());
-					}
-					else {
-						SEISCOMP_ERROR("Pick with ID '%s' has not been found", publicID.c_str());
+			PublicObject::SetRegistrationEnabled(true);
+
+			return success;
+		}
+
+		bool dumpEPAndJournal() {
+			bool dumpEP = !_eventIDs.empty() || !_originIDs.empty() || !_pickIDs.empty();
+			if ( dumpEP ) {
+				SEISCOMP_INFO("Dumping EventParameters");
+			}
+
+			vector<Batch> batches;
+			addBatches(batches, Batch::Events, _eventIDs);
+			addBatches(batches, Batch::Origins, _originIDs);
+			addBatches(batches, Batch::Picks, _pickIDs);
+
+			if ( _settings.jobs > 1 && batches.size() > 1 ) {
+				if ( !dumpEventParameters(batches) ) {
+					return false;
+				}
+			}
+			else {
+				// Each batch is written and released before the next one
+				// is loaded
+				for ( const auto &batch : batches ) {
+					EventParametersPtr ep = _builder->load(batch);
+					if ( !streamEventParameters(ep.get()) ) {
+						return false;
 					}
 				}
 			}
 
-			if ( ep && !write(ep.get()) ) {
-				return false;
+			if ( dumpEP ) {
+				SEISCOMP_DEBUG("Loaded event parameters with %zu batch queries",
+				               _builder->queries());
+
+				// Nothing found, write an empty container
+				if ( !_epOpen ) {
+					EventParametersPtr ep = new EventParameters;
+					if ( !write(ep.get()) ) {
+						return false;
+					}
+				}
+
+				if ( !endEventParameters() ) {
+					return false;
+				}
 			}
 
 			JournalingPtr jnl;
@@ -916,6 +1511,8 @@ class XMLDump : public Seiscomp::Client::Application {
 				return false;
 			}
 
+			_builder.reset(new Builder(_settings, query()));
+
 			if ( (_settings.dumpInventory && !dumpInventory())
 			  || (_settings.dumpConfig && !dumpConfig())
 			  || (_settings.dumpRouting && !dumpRouting())
@@ -945,432 +1542,11 @@ class XMLDump : public Seiscomp::Client::Application {
 			}
 
 			EventParametersPtr ep = new EventParameters;
-			addEvent(ep.get(), e);
+			_builder->addEvent(ep.get(), e);
 			write(ep.get()) && flushArchive();
 		}
 
 
-		void addOrigin(EventParameters *ep, Origin *origin) {
-			SEISCOMP_INFO("Dumping Origin '%s'", origin->publicID().c_str());
-			ep->add(origin);
-
-			query()->load(origin);
-
-			if ( _settings.withoutMagnitudes ) {
-				removeAllNetworkMagnitudes(origin);
-			}
-
-			if ( !_settings.withStationMagnitudes ) {
-				removeAllStationMagnitudes(origin);
-			}
-
-			if ( _settings.withoutArrivals ) {
-				removeAllArrivals(origin);
-			}
-
-			if ( _settings.withPicks ) {
-				for ( size_t a = 0; a < origin->arrivalCount(); ++a ) {
-					const string &pickID = origin->arrival(a)->pickID();
-					if ( _pickIDSet.find(pickID) != _pickIDSet.end() ) {
-						continue;
-					}
-
-					PickPtr pick = Pick::Cast(PublicObjectPtr(
-						query()->getObject(Pick::TypeInfo(), pickID)));
-					if ( !pick ) {
-						SEISCOMP_WARNING("Pick with id '%s' not found", pickID.c_str());
-						continue;
-					}
-
-					query()->load(pick.get());
-
-					if ( !pick->eventParameters() ) {
-						ep->add(pick.get());
-					}
-					_pickIDSet.insert(pickID);
-				}
-			}
-
-			if ( _settings.withAmplitudes && _settings.withStationMagnitudes ) {
-				// Extract amplitudes corresponding to station magnitudes
-				for ( size_t m = 0; m < origin->magnitudeCount(); ++m ) {
-					Magnitude* netMag = origin->magnitude(m);
-					for ( size_t s = 0; s < netMag->stationMagnitudeContributionCount(); ++s ) {
-						const string &stationMagnitudeID =
-							netMag->stationMagnitudeContribution(s)->stationMagnitudeID();
-						StationMagnitude* staMag = StationMagnitude::Find(stationMagnitudeID);
-						if ( !staMag ) {
-							SEISCOMP_WARNING("StationMagnitude with id '%s' not found",
-									 stationMagnitudeID.c_str());
-							continue;
-						}
-
-						const string &amplitudeID = staMag->amplitudeID();
-						if ( amplitudeID.empty() ) {
-							SEISCOMP_DEBUG("StationMagnitude with id '%s' has no amplitude ID",
-							               staMag->publicID().c_str());
-							continue;
-						}
-
-						if (_amplitudeIDSet.find(amplitudeID) != _amplitudeIDSet.end()) {
-							continue;
-						}
-
-						AmplitudePtr amplitude = Amplitude::Cast(PublicObjectPtr(
-							query()->getObject(Amplitude::TypeInfo(), amplitudeID)));
-						if ( !amplitude ) {
-							SEISCOMP_WARNING("Amplitude with id '%s' not found",
-									 amplitudeID.c_str());
-							continue;
-						}
-
-						if ( !amplitude->eventParameters() ) {
-							ep->add(amplitude.get());
-						}
-
-						_amplitudeIDSet.insert(amplitudeID);
-					}
-				}
-			}
-
-			if ( _settings.withAmplitudes && !_settings.withStationMagnitudes ) {
-				// Extract all amplitudes for all picks
-				for ( size_t p = 0; p < ep->pickCount(); ++p ) {
-					Pick *pick = ep->pick(p);
-					DatabaseIterator it = query()->getAmplitudesForPick(pick->publicID());
-					for ( ; *it; ++it ) {
-						auto *amplitude = Amplitude::Cast(*it);
-						if (_amplitudeIDSet.find(amplitude->publicID()) != _amplitudeIDSet.end()) {
-							continue;
-						}
-
-						if ( amplitude ) {
-							ep->add(amplitude);
-						}
-
-						_amplitudeIDSet.insert(amplitude->publicID());
-					}
-				}
-			}
-		}
-
-
-		void addEvent(EventParameters *ep, Event *event) {
-			SEISCOMP_INFO("Dumping Event '%s'", event->publicID().c_str());
-			ep->add(event);
-
-			if ( !_settings.preferredOnly ) {
-				query()->load(event);
-			}
-			else {
-				query()->loadComments(event);
-				query()->loadEventDescriptions(event);
-				event->add(
-					OriginReferencePtr(
-						new OriginReference(event->preferredOriginID())
-					).get()
-				);
-
-				if ( _settings.withFocalMechanisms
-				  && !event->preferredFocalMechanismID().empty() ) {
-					event->add(
-						FocalMechanismReferencePtr(
-							new FocalMechanismReference(
-								event->preferredFocalMechanismID()
-							)
-						).get()
-					);
-				}
-			}
-
-			bool foundPreferredMag = false;
-
-			// No need to search for it
-			if ( event->preferredMagnitudeID().empty() ) {
-				foundPreferredMag = true;
-			}
-
-
-			// loop over origins referenced by event
-			for ( size_t i = 0; i < event->originReferenceCount(); ++i ) {
-				const string originID = event->originReference(i)->originID();
-				OriginPtr origin = Origin::Cast(PublicObjectPtr(
-					query()->getObject(Origin::TypeInfo(), originID)));
-				if ( !origin ) {
-					SEISCOMP_WARNING("Origin with id '%s' not found", originID.c_str());
-					continue;
-				}
-
-				query()->load(origin.get());
-
-				if ( _settings.preferredOnly && !_settings.allMagnitudes ) {
-					MagnitudePtr netMag;
-					while ( origin->magnitudeCount() > 0 ) {
-						if ( origin->magnitude(0)->publicID() == event->preferredMagnitudeID() ) {
-							netMag = origin->magnitude(0);
-						}
-						origin->removeMagnitude(0);
-					}
-
-					if ( netMag ) {
-						foundPreferredMag = true;
-						origin->add(netMag.get());
-
-						// remove station magnitudes of types which are not preferred
-						for ( size_t i = 0; i < origin->stationMagnitudeCount(); ) {
-							auto *staMag = origin->stationMagnitude(i);
-							if ( staMag->type() != netMag->type() ) {
-								origin->removeStationMagnitude(i);
-							}
-							else {
-								++i;
-							}
-						}
-					}
-				}
-				else if ( !foundPreferredMag ) {
-					for ( size_t m = 0; m < origin->magnitudeCount(); ++m ) {
-						if ( origin->magnitude(m)->publicID() == event->preferredMagnitudeID() ) {
-							foundPreferredMag = true;
-							break;
-						}
-					}
-				}
-
-				if ( !_settings.withStationMagnitudes ) {
-					removeAllStationMagnitudes(origin.get());
-				}
-
-				if ( _settings.withoutArrivals ) {
-					removeAllArrivals(origin.get());
-				}
-
-				ep->add(origin.get());
-
-				if ( _settings.withPicks ) {
-					for ( size_t a = 0; a < origin->arrivalCount(); ++a ) {
-						const string &pickID = origin->arrival(a)->pickID();
-						if ( _pickIDSet.find(pickID) != _pickIDSet.end() ) {
-							continue;
-						}
-
-						PickPtr pick = Pick::Cast(PublicObjectPtr(
-							query()->getObject(Pick::TypeInfo(), pickID)));
-						if ( !pick ) {
-							SEISCOMP_WARNING("Pick with id '%s' not found",
-									 pickID.c_str());
-							continue;
-						}
-
-						query()->load(pick.get());
-
-						if ( !pick->eventParameters() ) {
-							ep->add(pick.get());
-						}
-						_pickIDSet.insert(pickID);
-					}
-				}
-
-				if ( _settings.withAmplitudes && _settings.withStationMagnitudes ) {
-					for ( size_t m = 0; m < origin->magnitudeCount(); ++m ) {
-						Magnitude* netMag = origin->magnitude(m);
-						for ( size_t s = 0; s < netMag->stationMagnitudeContributionCount(); ++s ) {
-							const string &staMagID
-								= netMag->stationMagnitudeContribution(s)->stationMagnitudeID();
-							StationMagnitude* staMag = StationMagnitude::Find(staMagID);
-							if ( !staMag ) {
-								SEISCOMP_WARNING("StationMagnitude with id '%s' not found",
-								                 staMagID.c_str());
-								continue;
-							}
-
-							const string &amplitudeID = staMag->amplitudeID();
-							if ( amplitudeID.empty() ) {
-								SEISCOMP_DEBUG("StationMagnitude with id '%s' has no amplitude ID",
-								               staMag->publicID().c_str());
-								continue;
-							}
-							if ( _amplitudeIDSet.find(amplitudeID) != _amplitudeIDSet.end() ) {
-								continue;
-							}
-
-							AmplitudePtr amplitude = Amplitude::Cast(PublicObjectPtr(
-								query()->getObject(Amplitude::TypeInfo(), amplitudeID)));
-
-							if ( !amplitude ) {
-								SEISCOMP_WARNING("Amplitude with id '%s' not found",
-										 amplitudeID.c_str());
-								continue;
-							}
-
-							if ( !amplitude->eventParameters() ) {
-								ep->add(amplitude.get());
-							}
-
-							_amplitudeIDSet.insert(amplitudeID);
-						}
-					}
-				}
-			}
-			// end of loop over origins referenced by event
-
-
-			if ( _settings.withAmplitudes && !_settings.withStationMagnitudes ) {
-				// Extract all amplitudes for all picks
-				for ( size_t p = 0; p < ep->pickCount(); ++p ) {
-					Pick *pick = ep->pick(p);
-					DatabaseIterator it = query()->getAmplitudesForPick(pick->publicID());
-					for ( ; *it; ++it ) {
-						auto *amplitude = Amplitude::Cast(*it);
-						if (_amplitudeIDSet.find(amplitude->publicID()) != _amplitudeIDSet.end()) {
-							continue;
-						}
-
-						if ( amplitude ) {
-							ep->add(amplitude);
-						}
-
-						_amplitudeIDSet.insert(amplitude->publicID());
-					}
-				}
-			}
-
-			if ( !_settings.withFocalMechanisms ) {
-				while ( event->focalMechanismReferenceCount() > 0 ) {
-					event->removeFocalMechanismReference(0);
-				}
-			}
-
-			for ( size_t i = 0; i < event->focalMechanismReferenceCount(); ++i ) {
-				const string &fmID =
-					event->focalMechanismReference(i)->focalMechanismID();
-				FocalMechanismPtr fm = FocalMechanism::Cast(PublicObjectPtr(
-					query()->getObject(FocalMechanism::TypeInfo(), fmID)));
-				if ( !fm ) {
-					SEISCOMP_WARNING("FocalMechanism with id '%s' not found", fmID.c_str());
-					continue;
-				}
-
-				query()->load(fm.get());
-				for ( size_t m = 0; m < fm->momentTensorCount(); ++m ) {
-					auto *mt = fm->momentTensor(m);
-					if ( _settings.withoutArrivals ) {// TODO: review!
-						removeAllStationContributions(mt);
-					}
-				}
-
-				if ( !fm->triggeringOriginID().empty()
-				  && fm->triggeringOriginID() != event->preferredOriginID() ) {
-
-					OriginPtr triggeringOrigin = ep->findOrigin(fm->triggeringOriginID());
-					if ( !triggeringOrigin ) {
-						triggeringOrigin = Origin::Cast(PublicObjectPtr(
-							query()->getObject(Origin::TypeInfo(), fm->triggeringOriginID())));
-						if ( !triggeringOrigin ) {
-							SEISCOMP_WARNING("Triggering origin with id '%s' not found",
-									 fm->triggeringOriginID().c_str());
-						}
-						else {
-							query()->load(triggeringOrigin.get());
-
-							if ( !_settings.withStationMagnitudes ) {
-								removeAllStationMagnitudes(triggeringOrigin.get());
-							}
-
-							if ( _settings.withoutArrivals ) {
-								removeAllArrivals(triggeringOrigin.get());
-							}
-
-							if ( _settings.preferredOnly && !_settings.allMagnitudes ) {
-								MagnitudePtr netMag;
-								while ( triggeringOrigin->magnitudeCount() > 0 ) {
-									if ( triggeringOrigin->magnitude(0)->publicID() == event->preferredMagnitudeID() ) {
-										netMag = triggeringOrigin->magnitude(0);
-									}
-
-									triggeringOrigin->removeMagnitude(0);
-								}
-
-								if ( netMag ) {
-									triggeringOrigin->add(netMag.get());
-								}
-							}
-
-							ep->add(triggeringOrigin.get());
-						}
-					}
-				}
-
-				ep->add(fm.get());
-
-				for ( size_t m = 0; m < fm->momentTensorCount(); ++m ) {
-					MomentTensor *mt = fm->momentTensor(m);
-					if ( mt->derivedOriginID().empty() ) {
-						continue;
-					}
-
-					OriginPtr derivedOrigin = ep->findOrigin(mt->derivedOriginID());
-					if ( derivedOrigin ) {
-						continue;
-					}
-
-					derivedOrigin = Origin::Cast(PublicObjectPtr(
-						query()->getObject(Origin::TypeInfo(), mt->derivedOriginID())));
-					if ( !derivedOrigin ) {
-						SEISCOMP_WARNING("Derived MT origin with id '%s' not found",
-								 mt->derivedOriginID().c_str());
-						continue;
-					}
-
-					query()->load(derivedOrigin.get());
-					ep->add(derivedOrigin.get());
-
-					if ( !foundPreferredMag ) {
-						for ( size_t m = 0; m < derivedOrigin->magnitudeCount(); ++m ) {
-							if ( derivedOrigin->magnitude(m)->publicID() == event->preferredMagnitudeID() ) {
-								foundPreferredMag = true;
-								break;
-							}
-						}
-					}
-				}
-			}
-
-			// Find the preferred magnitude
-			if ( !foundPreferredMag ) {
-				OriginPtr origin = query()->getOriginByMagnitude(event->preferredMagnitudeID());
-				if ( origin ) {
-					query()->load(origin.get());
-
-					if ( !_settings.withStationMagnitudes ) {
-						removeAllStationMagnitudes(origin.get());
-					}
-
-					if ( _settings.withoutArrivals ) {
-						removeAllArrivals(origin.get());
-					}
-
-					if ( _settings.preferredOnly && !_settings.allMagnitudes ) {
-						MagnitudePtr netMag;
-						while ( origin->magnitudeCount() > 0 ) {
-							if ( origin->magnitude(0)->publicID() == event->preferredMagnitudeID() ) {
-								netMag = origin->magnitude(0);
-							}
-
-							origin->removeMagnitude(0);
-						}
-
-						if ( netMag ) {
-							origin->add(netMag.get());
-						}
-					}
-
-					ep->add(origin.get());
-				}
-			}
-		}
-
-
 	private:
 		struct Settings : AbstractSettings {
 			void accept(SettingsLinker &linker) override {
@@ -1506,6 +1682,14 @@ class XMLDump : public Seiscomp::Client::Application {
 					"Valid in combination with --public-id."
 				)
 
+				& cli(
+					jobs,
+					"Dump", "jobs",
+					"Number of threads loading event parameters in parallel, "
+					"each with its own database connection. Requires a "
+					"database URI."
+				)
+
 				& cliSwitch(
 					formatted,
 					"Output", "formatted,f",
@@ -1546,6 +1730,7 @@ class XMLDump : public Seiscomp::Client::Application {
 			bool   withRoot{false};
 
 			bool   formatted{false};
+			int    jobs{1};
 
 			string outputFile;
 			string publicIDParam;
@@ -1555,17 +1740,660 @@ class XMLDump : public Seiscomp::Client::Application {
 			string pickIDParam;
 		}              _settings;
 
+		/**
+		 * Builds EventParameters from the database. Each builder uses its
+		 * own query object and caches, one per worker thread.
+		 */
+		class Builder {
+			public:
+				Builder(const Settings &settings, DatabaseQuery *query)
+				: _settings(settings), _query(query) {
+					_loader.setArchive(query);
+				}
+
+			public:
+				//! Loads a batch of events, origins or picks along with the
+				//! requested associated objects
+				EventParametersPtr load(const Batch &batch) {
+					EventParametersPtr ep = new EventParameters;
+
+					switch ( batch.type ) {
+						case Batch::Events:
+							prefetchEvents(batch.ids);
+							for ( const auto &publicID : batch.ids ) {
+								EventPtr event = Event::Cast(fetch(Event::TypeInfo(), publicID, false));
+								if ( event ) {
+									addEvent(ep.get(), event.get());
+								}
+								else {
+									SEISCOMP_ERROR("Event with ID '%s' has not been found", publicID.c_str());
+								}
+							}
+							break;
+
+						case Batch::Origins:
+							prefetchOrigins(batch.ids);
+							for ( const auto &publicID : batch.ids ) {
+								OriginPtr origin = Origin::Cast(fetch(Origin::TypeInfo(), publicID, true));
+								if ( origin ) {
+									addOrigin(ep.get(), origin.get());
+								}
+								else {
+									SEISCOMP_ERROR("Origin with ID '%s' has not been found", publicID.c_str());
+								}
+							}
+							break;
+
+						case Batch::Picks:
+							_loader.load(Pick::TypeInfo(), batch.ids, false);
+							for ( const auto &publicID : batch.ids ) {
+								if ( _pickIDSet.find(publicID) != _pickIDSet.end() ) {
+									SEISCOMP_INFO("Pick '%s' already exported", publicID.c_str());
+								}
+
+								PickPtr pick = Pick::Cast(fetch(Pick::TypeInfo(), publicID, false));
+								if ( pick ) {
+									SEISCOMP_INFO("Dumping Pick '%s'", pick->publicID().c_str());
+									ep->add(pick.get());
+								}
+								else {
+									SEISCOMP_ERROR("Pick with ID '%s' has not been found", publicID.c_str());
+								}
+							}
+							break;
+					}
+
+					_loader.clear();
+
+					return ep;
+				}
+
+				size_t queries() const {
+					return _loader.queries();
+				}
+
+				/**
+				 * Returns an object from the batch loader or loads it from the
+				 * database if it has not been prefetched.
+				 */
+				PublicObjectPtr fetch(const RTTI &type, const string &publicID,
+				                      bool withChildren) {
+					PublicObjectPtr po;
+					if ( _loader.find(po, publicID, withChildren) ) {
+						return po;
+					}
+
+					po = _query->getObject(type, publicID);
+					if ( po && withChildren ) {
+						readTree(_query, po.get());
+					}
+
+					return po;
+				}
+
+
+				void addAmplitudes(EventParameters *ep, const vector<Pick*> &picks) {
+					for ( auto pick : picks ) {
+						auto amplitudes = _loader.amplitudesForPick(pick->publicID());
+						if ( amplitudes ) {
+							for ( const auto &amplitude : *amplitudes ) {
+								if ( _amplitudeIDSet.find(amplitude->publicID()) != _amplitudeIDSet.end() ) {
+									continue;
+								}
+
+								ep->add(amplitude.get());
+								_amplitudeIDSet.insert(amplitude->publicID());
+							}
+							continue;
+						}
+
+						DatabaseIterator it = _query->getAmplitudesForPick(pick->publicID());
+						for ( ; *it; ++it ) {
+							auto *amplitude = Amplitude::Cast(*it);
+							if ( !amplitude
+							  || _amplitudeIDSet.find(amplitude->publicID()) != _amplitudeIDSet.end() ) {
+								continue;
+							}
+
+							ep->add(amplitude);
+							_amplitudeIDSet.insert(amplitude->publicID());
+						}
+					}
+				}
+
+
+				/**
+				 * Loads the objects referenced by a batch of origins: picks and
+				 * amplitudes.
+				 */
+				void prefetchOriginReferences(const vector<string> &originIDs) {
+					vector<string> pickIDs;
+					vector<string> amplitudeIDs;
+
+					for ( const auto &originID : originIDs ) {
+						PublicObjectPtr po;
+						if ( !_loader.find(po, originID, true) ) {
+							continue;
+						}
+
+						auto origin = Origin::Cast(po);
+						if ( !origin ) {
+							continue;
+						}
+
+						if ( _settings.withPicks && !_settings.withoutArrivals ) {
+							for ( size_t a = 0; a < origin->arrivalCount(); ++a ) {
+								const string &pickID = origin->arrival(a)->pickID();
+								if ( _pickIDSet.find(pickID) == _pickIDSet.end() ) {
+									pickIDs.push_back(pickID);
+								}
+							}
+						}
+
+						if ( _settings.withAmplitudes && _settings.withStationMagnitudes ) {
+							for ( size_t i = 0; i < origin->stationMagnitudeCount(); ++i ) {
+								const string &amplitudeID = origin->stationMagnitude(i)->amplitudeID();
+								if ( _amplitudeIDSet.find(amplitudeID) == _amplitudeIDSet.end() ) {
+									amplitudeIDs.push_back(amplitudeID);
+								}
+							}
+						}
+					}
+
+					_loader.load(Pick::TypeInfo(), pickIDs, true);
+					_loader.load(Amplitude::TypeInfo(), amplitudeIDs, false);
+
+					if ( _settings.withAmplitudes && !_settings.withStationMagnitudes ) {
+						_loader.loadAmplitudesForPicks(pickIDs);
+					}
+				}
+
+
+				void prefetchOrigins(const vector<string> &originIDs) {
+					_loader.load(Origin::TypeInfo(), originIDs, true);
+					prefetchOriginReferences(originIDs);
+				}
+
+
+				/**
+				 * Loads a batch of events along with all objects addEvent will
+				 * request with a few queries per object class.
+				 */
+				void prefetchEvents(const vector<string> &eventIDs) {
+					static const set<string> preferredOnlyChildren = {
+						Comment::ClassName(), EventDescription::ClassName()
+					};
+
+					_loader.load(Event::TypeInfo(), eventIDs, true,
+					             _settings.preferredOnly ? &preferredOnlyChildren : nullptr);
+
+					vector<string> originIDs;
+					vector<string> fmIDs;
+
+					for ( const auto &eventID : eventIDs ) {
+						PublicObjectPtr po;
+						_loader.find(po, eventID, false);
+						auto event = Event::Cast(po);
+						if ( !event ) {
+							continue;
+						}
+
+						if ( _settings.preferredOnly ) {
+							originIDs.push_back(event->preferredOriginID());
+							if ( _settings.withFocalMechanisms ) {
+								fmIDs.push_back(event->preferredFocalMechanismID());
+							}
+							continue;
+						}
+
+						for ( size_t i = 0; i < event->originReferenceCount(); ++i ) {
+							originIDs.push_back(event->originReference(i)->originID());
+						}
+
+						if ( _settings.withFocalMechanisms ) {
+							for ( size_t i = 0; i < event->focalMechanismReferenceCount(); ++i ) {
+								fmIDs.push_back(event->focalMechanismReference(i)->focalMechanismID());
+							}
+						}
+					}
+
+					_loader.load(Origin::TypeInfo(), originIDs, true);
+					_loader.load(FocalMechanism::TypeInfo(), fmIDs, true);
+
+					// Triggering and derived origins of focal mechanisms
+					vector<string> fmOriginIDs;
+					for ( const auto &fmID : fmIDs ) {
+						PublicObjectPtr po;
+						_loader.find(po, fmID, true);
+						auto fm = FocalMechanism::Cast(po);
+						if ( !fm ) {
+							continue;
+						}
+
+						fmOriginIDs.push_back(fm->triggeringOriginID());
+						for ( size_t m = 0; m < fm->momentTensorCount(); ++m ) {
+							fmOriginIDs.push_back(fm->momentTensor(m)->derivedOriginID());
+						}
+					}
+
+					_loader.load(Origin::TypeInfo(), fmOriginIDs, true);
+
+					prefetchOriginReferences(originIDs);
+				}
+
+
+				void addOrigin(EventParameters *ep, Origin *origin) {
+					SEISCOMP_INFO("Dumping Origin '%s'", origin->publicID().c_str());
+					ep->add(origin);
+
+					vector<Pick*> picks;
+
+					if ( _settings.withoutMagnitudes ) {
+						removeAllNetworkMagnitudes(origin);
+					}
+
+					if ( !_settings.withStationMagnitudes ) {
+						removeAllStationMagnitudes(origin);
+					}
+
+					if ( _settings.withoutArrivals ) {
+						removeAllArrivals(origin);
+					}
+
+					if ( _settings.withPicks ) {
+						for ( size_t a = 0; a < origin->arrivalCount(); ++a ) {
+							const string &pickID = origin->arrival(a)->pickID();
+							if ( _pickIDSet.find(pickID) != _pickIDSet.end() ) {
+								continue;
+							}
+
+							PickPtr pick = Pick::Cast(fetch(Pick::TypeInfo(), pickID, true));
+							if ( !pick ) {
+								SEISCOMP_WARNING("Pick with id '%s' not found", pickID.c_str());
+								continue;
+							}
+
+							if ( !pick->eventParameters() ) {
+								ep->add(pick.get());
+								picks.push_back(pick.get());
+							}
+							_pickIDSet.insert(pickID);
+						}
+					}
+
+					if ( _settings.withAmplitudes && _settings.withStationMagnitudes ) {
+						// Extract amplitudes corresponding to station magnitudes
+						for ( size_t m = 0; m < origin->magnitudeCount(); ++m ) {
+							Magnitude* netMag = origin->magnitude(m);
+							for ( size_t s = 0; s < netMag->stationMagnitudeContributionCount(); ++s ) {
+								const string &stationMagnitudeID =
+									netMag->stationMagnitudeContribution(s)->stationMagnitudeID();
+								StationMagnitude* staMag = origin->findStationMagnitude(stationMagnitudeID);
+								if ( !staMag ) {
+									SEISCOMP_WARNING("StationMagnitude with id '%s' not found",
+											 stationMagnitudeID.c_str());
+									continue;
+								}
+
+								const string &amplitudeID = staMag->amplitudeID();
+								if ( amplitudeID.empty() ) {
+									SEISCOMP_DEBUG("StationMagnitude with id '%s' has no amplitude ID",
+									               staMag->publicID().c_str());
+									continue;
+								}
+
+								if (_amplitudeIDSet.find(amplitudeID) != _amplitudeIDSet.end()) {
+									continue;
+								}
+
+								AmplitudePtr amplitude = Amplitude::Cast(
+									fetch(Amplitude::TypeInfo(), amplitudeID, false));
+								if ( !amplitude ) {
+									SEISCOMP_WARNING("Amplitude with id '%s' not found",
+											 amplitudeID.c_str());
+									continue;
+								}
+
+								if ( !amplitude->eventParameters() ) {
+									ep->add(amplitude.get());
+								}
+
+								_amplitudeIDSet.insert(amplitudeID);
+							}
+						}
+					}
+
+					if ( _settings.withAmplitudes && !_settings.withStationMagnitudes ) {
+						// Extract all amplitudes for all picks, the amplitudes of
+						// previously added picks have been extracted already
+						addAmplitudes(ep, picks);
+					}
+				}
+
+
+				void addEvent(EventParameters *ep, Event *event) {
+					SEISCOMP_INFO("Dumping Event '%s'", event->publicID().c_str());
+					ep->add(event);
+
+					bool childrenLoaded = _loader.hasChildren(event->publicID());
+
+					if ( !_settings.preferredOnly ) {
+						if ( !childrenLoaded ) {
+							_query->load(event);
+						}
+					}
+					else {
+						if ( !childrenLoaded ) {
+							_query->loadComments(event);
+							_query->loadEventDescriptions(event);
+						}
+						event->add(
+							OriginReferencePtr(
+								new OriginReference(event->preferredOriginID())
+							).get()
+						);
+
+						if ( _settings.withFocalMechanisms
+						  && !event->preferredFocalMechanismID().empty() ) {
+							event->add(
+								FocalMechanismReferencePtr(
+									new FocalMechanismReference(
+										event->preferredFocalMechanismID()
+									)
+								).get()
+							);
+						}
+					}
+
+					bool foundPreferredMag = false;
+					vector<Pick*> picks;
+
+					// No need to search for it
+					if ( event->preferredMagnitudeID().empty() ) {
+						foundPreferredMag = true;
+					}
+
+
+					// loop over origins referenced by event
+					for ( size_t i = 0; i < event->originReferenceCount(); ++i ) {
+						const string originID = event->originReference(i)->originID();
+						OriginPtr origin = Origin::Cast(fetch(Origin::TypeInfo(), originID, true));
+						if ( !origin ) {
+							SEISCOMP_WARNING("Origin with id '%s' not found", originID.c_str());
+							continue;
+						}
+
+						if ( _settings.preferredOnly && !_settings.allMagnitudes ) {
+							MagnitudePtr netMag;
+							while ( origin->magnitudeCount() > 0 ) {
+								if ( origin->magnitude(0)->publicID() == event->preferredMagnitudeID() ) {
+									netMag = origin->magnitude(0);
+								}
+								origin->removeMagnitude(0);
+							}
+
+							if ( netMag ) {
+								foundPreferredMag = true;
+								origin->add(netMag.get());
+
+								// remove station magnitudes of types which are not preferred
+								for ( size_t i = 0; i < origin->stationMagnitudeCount(); ) {
+									auto *staMag = origin->stationMagnitude(i);
+									if ( staMag->type() != netMag->type() ) {
+										origin->removeStationMagnitude(i);
+									}
+									else {
+										++i;
+									}
+								}
+							}
+						}
+						else if ( !foundPreferredMag ) {
+							for ( size_t m = 0; m < origin->magnitudeCount(); ++m ) {
+								if ( origin->magnitude(m)->publicID() == event->preferredMagnitudeID() ) {
+									foundPreferredMag = true;
+									break;
+								}
+							}
+						}
+
+						if ( !_settings.withStationMagnitudes ) {
+							removeAllStationMagnitudes(origin.get());
+						}
+
+						if ( _settings.withoutArrivals ) {
+							removeAllArrivals(origin.get());
+						}
+
+						ep->add(origin.get());
+
+						if ( _settings.withPicks ) {
+							for ( size_t a = 0; a < origin->arrivalCount(); ++a ) {
+								const string &pickID = origin->arrival(a)->pickID();
+								if ( _pickIDSet.find(pickID) != _pickIDSet.end() ) {
+									continue;
+								}
+
+								PickPtr pick = Pick::Cast(fetch(Pick::TypeInfo(), pickID, true));
+								if ( !pick ) {
+									SEISCOMP_WARNING("Pick with id '%s' not found",
+											 pickID.c_str());
+									continue;
+								}
+
+								if ( !pick->eventParameters() ) {
+									ep->add(pick.get());
+									picks.push_back(pick.get());
+								}
+								_pickIDSet.insert(pickID);
+							}
+						}
+
+						if ( _settings.withAmplitudes && _settings.withStationMagnitudes ) {
+							for ( size_t m = 0; m < origin->magnitudeCount(); ++m ) {
+								Magnitude* netMag = origin->magnitude(m);
+								for ( size_t s = 0; s < netMag->stationMagnitudeContributionCount(); ++s ) {
+									const string &staMagID
+										= netMag->stationMagnitudeContribution(s)->stationMagnitudeID();
+									StationMagnitude* staMag = origin->findStationMagnitude(staMagID);
+									if ( !staMag ) {
+										SEISCOMP_WARNING("StationMagnitude with id '%s' not found",
+										                 staMagID.c_str());
+										continue;
+									}
+
+									const string &amplitudeID = staMag->amplitudeID();
+									if ( amplitudeID.empty() ) {
+										SEISCOMP_DEBUG("StationMagnitude with id '%s' has no amplitude ID",
+										               staMag->publicID().c_str());
+										continue;
+									}
+									if ( _amplitudeIDSet.find(amplitudeID) != _amplitudeIDSet.end() ) {
+										continue;
+									}
+
+									AmplitudePtr amplitude = Amplitude::Cast(
+										fetch(Amplitude::TypeInfo(), amplitudeID, false));
+
+									if ( !amplitude ) {
+										SEISCOMP_WARNING("Amplitude with id '%s' not found",
+												 amplitudeID.c_str());
+										continue;
+									}
+
+									if ( !amplitude->eventParameters() ) {
+										ep->add(amplitude.get());
+									}
+
+									_amplitudeIDSet.insert(amplitudeID);
+								}
+							}
+						}
+					}
+					// end of loop over origins referenced by event
+
+
+					if ( _settings.withAmplitudes && !_settings.withStationMagnitudes ) {
+						// Extract all amplitudes for all picks, the amplitudes of
+						// previously added picks have been extracted already
+						addAmplitudes(ep, picks);
+					}
+
+					if ( !_settings.withFocalMechanisms ) {
+						while ( event->focalMechanismReferenceCount() > 0 ) {
+							event->removeFocalMechanismReference(0);
+						}
+					}
+
+					for ( size_t i = 0; i < event->focalMechanismReferenceCount(); ++i ) {
+						const string &fmID =
+							event->focalMechanismReference(i)->focalMechanismID();
+						FocalMechanismPtr fm = FocalMechanism::Cast(
+							fetch(FocalMechanism::TypeInfo(), fmID, true));
+						if ( !fm ) {
+							SEISCOMP_WARNING("FocalMechanism with id '%s' not found", fmID.c_str());
+							continue;
+						}
+						for ( size_t m = 0; m < fm->momentTensorCount(); ++m ) {
+							auto *mt = fm->momentTensor(m);
+							if ( _settings.withoutArrivals ) {// TODO: review!
+								removeAllStationContributions(mt);
+							}
+						}
+
+						if ( !fm->triggeringOriginID().empty()
+						  && fm->triggeringOriginID() != event->preferredOriginID() ) {
+
+							OriginPtr triggeringOrigin = ep->findOrigin(fm->triggeringOriginID());
+							if ( !triggeringOrigin ) {
+								triggeringOrigin = Origin::Cast(
+									fetch(Origin::TypeInfo(), fm->triggeringOriginID(), true));
+								if ( !triggeringOrigin ) {
+									SEISCOMP_WARNING("Triggering origin with id '%s' not found",
+											 fm->triggeringOriginID().c_str());
+								}
+								else {
+									if ( !_settings.withStationMagnitudes ) {
+										removeAllStationMagnitudes(triggeringOrigin.get());
+									}
+
+									if ( _settings.withoutArrivals ) {
+										removeAllArrivals(triggeringOrigin.get());
+									}
+
+									if ( _settings.preferredOnly && !_settings.allMagnitudes ) {
+										MagnitudePtr netMag;
+										while ( triggeringOrigin->magnitudeCount() > 0 ) {
+											if ( triggeringOrigin->magnitude(0)->publicID() == event->preferredMagnitudeID() ) {
+												netMag = triggeringOrigin->magnitude(0);
+											}
+
+											triggeringOrigin->removeMagnitude(0);
+										}
+
+										if ( netMag ) {
+											triggeringOrigin->add(netMag.get());
+										}
+									}
+
+									ep->add(triggeringOrigin.get());
+								}
+							}
+						}
+
+						ep->add(fm.get());
+
+						for ( size_t m = 0; m < fm->momentTensorCount(); ++m ) {
+							MomentTensor *mt = fm->momentTensor(m);
+							if ( mt->derivedOriginID().empty() ) {
+								continue;
+							}
+
+							OriginPtr derivedOrigin = ep->findOrigin(mt->derivedOriginID());
+							if ( derivedOrigin ) {
+								continue;
+							}
+
+							derivedOrigin = Origin::Cast(
+								fetch(Origin::TypeInfo(), mt->derivedOriginID(), true));
+							if ( !derivedOrigin ) {
+								SEISCOMP_WARNING("Derived MT origin with id '%s' not found",
+										 mt->derivedOriginID().c_str());
+								continue;
+							}
+							ep->add(derivedOrigin.get());
+
+							if ( !foundPreferredMag ) {
+								for ( size_t m = 0; m < derivedOrigin->magnitudeCount(); ++m ) {
+									if ( derivedOrigin->magnitude(m)->publicID() == event->preferredMagnitudeID() ) {
+										foundPreferredMag = true;
+										break;
+									}
+								}
+							}
+						}
+					}
+
+					// Find the preferred magnitude
+					if ( !foundPreferredMag ) {
+						OriginPtr origin = _query->getOriginByMagnitude(event->preferredMagnitudeID());
+						if ( origin ) {
+							_query->load(origin.get());
+
+							if ( !_settings.withStationMagnitudes ) {
+								removeAllStationMagnitudes(origin.get());
+							}
+
+							if ( _settings.withoutArrivals ) {
+								removeAllArrivals(origin.get());
+							}
+
+							if ( _settings.preferredOnly && !_settings.allMagnitudes ) {
+								MagnitudePtr netMag;
+								while ( origin->magnitudeCount() > 0 ) {
+									if ( origin->magnitude(0)->publicID() == event->preferredMagnitudeID() ) {
+										netMag = origin->magnitude(0);
+									}
+
+									origin->removeMagnitude(0);
+								}
+
+								if ( netMag ) {
+									origin->add(netMag.get());
+								}
+							}
+
+							ep->add(origin.get());
+						}
+					}
+				}
+
+
+			private:
+				const Settings &_settings;
+				DatabaseQuery  *_query;
+				BatchLoader     _loader;
+				set<string>     _pickIDSet;
+				set<string>     _amplitudeIDSet;
+		};
+
+
 		vector<string> _publicIDs;
 		vector<string> _stationIDs;
 		vector<string> _eventIDs;
 		vector<string> _originIDs;
 		vector<string> _pickIDs;
 
-		set<string> _pickIDSet;
-		set<string> _amplitudeIDSet;
+		unique_ptr<Builder> _builder;
 
-		XMLArchive *_archive{nullptr};
-		stringbuf _archiveBuf;
+		stringbuf    _archiveBuf;
+		ostream      _bufferOut{&_archiveBuf};
+		ofstream     _file;
+		ostream     *_out{nullptr};
+		string       _footer;
+		bool         _epOpen{false};
+		string       _epFooter;
+		set<string>  _streamedIDs;
 };
 
 
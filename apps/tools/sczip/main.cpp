@@ -20,8 +20,15 @@
 #include <boost/iostreams/filtering_stream.hpp>
 #include <boost/iostreams/filter/zlib.hpp>
 
+#include <zlib.h>
+
+#include <climits>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <thread>
 
 
 using namespace std;
@@ -29,6 +36,66 @@ using namespace Seiscomp;
 using namespace Seiscomp::Core;
 
 
+namespace {
+
+
+struct Block {
+	string data;
+	string compressed;
+	uLong  adler{1};
+	bool   last{false};
+	bool   ok{false};
+};
+
+
+// Compresses a block as raw deflate data without zlib header and trailer.
+// All blocks but the last are terminated with a sync flush which ends them
+// on a byte boundary without setting the final flag. The concatenation of
+// all blocks is thus a single valid deflate stream.
+bool deflateBlock(Block &block) {
+	z_stream strm{};
+	if ( deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS,
+	                  8, Z_DEFAULT_STRATEGY) != Z_OK ) {
+		return false;
+	}
+
+	strm.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block.data.data()));
+	strm.avail_in = static_cast<uInt>(block.data.size());
+
+	block.compressed.resize(deflateBound(&strm, block.data.size()) + 16);
+	size_t have = 0;
+	int flush = block.last ? Z_FINISH : Z_SYNC_FLUSH;
+
+	while ( true ) {
+		strm.next_out = reinterpret_cast<Bytef*>(&block.compressed[have]);
+		strm.avail_out = static_cast<uInt>(block.compressed.size() - have);
+
+		if ( deflate(&strm, flush) == Z_STREAM_ERROR ) {
+			deflateEnd(&strm);
+			return false;
+		}
+
+		have = block.compressed.size() - strm.avail_out;
+		if ( strm.avail_out > 0 ) {
+			break;
+		}
+
+		block.compressed.resize(block.compressed.size() * 2);
+	}
+
+	deflateEnd(&strm);
+
+	block.compressed.resize(have);
+	block.adler = adler32(adler32(0L, Z_NULL, 0),
+	                      reinterpret_cast<const Bytef*>(block.data.data()),
+	                      static_cast<uInt>(block.data.size()));
+	return true;
+}
+
+
+}
+
+
 class Zipper : public Client::Application {
 	public:
 		Zipper(int argc, char** argv) : Client::Application(argc, argv) {
@@ -42,6 +109,33 @@ class Zipper : public Client::Application {
 			commandline().addGroup("Mode");
 			commandline().addOption("Mode", "decompress,d", "decompress data");
 			commandline().addOption("Mode", "output,o", "output file (default is stdout)", &_outputFile, false);
+			commandline().addOption("Mode", "threads", "number of threads compressing blocks in parallel", &_threads, true);
+			commandline().addOption("Mode", "block-size", "size of the blocks compressed in parallel in KiB", &_blockSize, true);
+		}
+
+		bool validateParameters() {
+			if ( !Client::Application::validateParameters() ) {
+				return false;
+			}
+
+			if ( _threads < 1 ) {
+				cerr << "Number of threads must be at least 1" << endl;
+				return false;
+			}
+
+			if ( _blockSize < 32 ) {
+				cerr << "Block size must be at least 32 KiB" << endl;
+				return false;
+			}
+
+			// zlib counts the input and output of a single call in uInt
+			if ( static_cast<size_t>(_blockSize) * 1024 > UINT_MAX / 2 ) {
+				cerr << "Block size must not exceed " << UINT_MAX / 2 / 1024
+				     << " KiB" << endl;
+				return false;
+			}
+
+			return true;
 		}
 
 		bool run() {
@@ -92,6 +186,13 @@ class Zipper : public Client::Application {
 				filtered_buf.push(*output->rdbuf());
 				*input >> &filtered_buf;
 			}
+			else if ( _threads > 1 ) {
+				if ( !compressBlocks(*input, *output) ) {
+					if ( deleteInputOnExit ) delete input;
+					if ( deleteOutputOnExit ) delete output;
+					return false;
+				}
+			}
 			else {
 				boost::iostreams::filtering_ostreambuf filtered_buf;
 				filtered_buf.push(boost::iostreams::zlib_compressor());
@@ -105,8 +206,170 @@ class Zipper : public Client::Application {
 			return true;
 		}
 
+	private:
+		// Compresses the input in independent blocks with multiple threads,
+		// similar to pigz. The output is a single standard zlib stream which
+		// is decompressed like the output of the single threaded mode.
+		//
+		// The calling thread reads the input into a ring of blocks, a pool
+		// of workers compresses them and a writer thread outputs them in
+		// order. Reading, compressing and writing thus overlap and a free
+		// block is refilled as soon as it has been written.
+		bool compressBlocks(istream &input, ostream &output) {
+			enum State { Free, Filled, Compressed };
+
+			size_t blockSize = static_cast<size_t>(_blockSize) * 1024;
+			vector<Block> blocks(static_cast<size_t>(_threads) * 2);
+			vector<State> states(blocks.size(), Free);
+			deque<size_t> pending;
+			size_t blockCount = 0;
+			bool inputDone = false;
+			bool error = false;
+
+			mutex mtx;
+			condition_variable cond;
+
+			auto worker = [&]() {
+				unique_lock<mutex> lock(mtx);
+				while ( true ) {
+					cond.wait(lock, [&] {
+						return error || !pending.empty() || inputDone;
+					});
+
+					if ( error || pending.empty() ) {
+						return;
+					}
+
+					size_t seq = pending.front();
+					pending.pop_front();
+					Block &block = blocks[seq % blocks.size()];
+
+					lock.unlock();
+					block.ok = deflateBlock(block);
+					lock.lock();
+
+					states[seq % blocks.size()] = Compressed;
+					cond.notify_all();
+				}
+			};
+
+			auto writer = [&]() {
+				uLong adler = adler32(0L, Z_NULL, 0);
+
+				// zlib header: deflate with 32k window, default level
+				const char header[2] = { 0x78, static_cast<char>(0x9c) };
+				output.write(header, 2);
+
+				for ( size_t seq = 0; ; ++seq ) {
+					size_t slot = seq % blocks.size();
+					{
+						unique_lock<mutex> lock(mtx);
+						cond.wait(lock, [&] {
+							return error || states[slot] == Compressed
+							    || (inputDone && seq == blockCount);
+						});
+
+						if ( error || seq == blockCount ) {
+							break;
+						}
+					}
+
+					Block &block = blocks[slot];
+					if ( !block.ok ) {
+						cerr << "Failed to compress block" << endl;
+					}
+					else {
+						output.write(block.compressed.data(), block.compressed.size());
+						adler = adler32_combine(adler, block.adler,
+						                        static_cast<z_off_t>(block.data.size()));
+					}
+
+					bool last = block.last;
+					lock_guard<mutex> lock(mtx);
+					if ( !block.ok || !output.good() ) {
+						error = true;
+					}
+					states[slot] = Free;
+					cond.notify_all();
+
+					if ( error || last ) {
+						break;
+					}
+				}
+
+				if ( error ) {
+					return;
+				}
+
+				// zlib trailer: Adler-32 checksum of the uncompressed data in
+				// network byte order
+				const char trailer[4] = {
+					static_cast<char>((adler >> 24) & 0xff),
+					static_cast<char>((adler >> 16) & 0xff),
+					static_cast<char>((adler >> 8) & 0xff),
+					static_cast<char>(adler & 0xff)
+				};
+				output.write(trailer, 4);
+				output.flush();
+			};
+
+			vector<thread> workers;
+			for ( int i = 0; i < _threads; ++i ) {
+				workers.emplace_back(worker);
+			}
+			thread writerThread(writer);
+
+			bool eof = false;
+			for ( size_t seq = 0; !eof; ++seq ) {
+				size_t slot = seq % blocks.size();
+				{
+					unique_lock<mutex> lock(mtx);
+					cond.wait(lock, [&] { return error || states[slot] == Free; });
+					if ( error ) {
+						break;
+					}
+				}
+
+				Block &block = blocks[slot];
+				block.data.resize(blockSize);
+				input.read(&block.data[0], blockSize);
+				block.data.resize(static_cast<size_t>(input.gcount()));
+
+				lock_guard<mutex> lock(mtx);
+				if ( input.bad() ) {
+					cerr << "Failed to read input" << endl;
+					error = true;
+					cond.notify_all();
+					break;
+				}
+
+				eof = input.peek() == char_traits<char>::eof();
+				block.last = eof;
+				block.ok = false;
+				states[slot] = Filled;
+				pending.push_back(seq);
+				blockCount = seq + 1;
+				cond.notify_all();
+			}
+
+			{
+				lock_guard<mutex> lock(mtx);
+				inputDone = true;
+				cond.notify_all();
+			}
+
+			for ( auto &t : workers ) {
+				t.join();
+			}
+			writerThread.join();
+
+			return !error && output.good();
+		}
+
 	private:
 		string _outputFile;
+		int    _threads{1};
+		int    _blockSize{1024};
 };
 
 
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+
+###########################################################################
+# Copyright (C) GFZ Potsdam                                               #
+# All rights reserved.                                                    #
+#                                                                         #
+# GNU Affero General Public License Usage                                 #
+# This file may be used under the terms of the GNU Affero                 #
+# Public License version 3.0 as published by the Free Software Foundation #
+# and appearing in the file LICENSE included in the packaging of this     #
+# file. Please review the following information to ensure the GNU Affero  #
+# Public License version 3.0 requirements will be met:                    #
+# https://www.gnu.org/licenses/agpl-3.0.html.                             #
+###########################################################################
+
+import random
+import subprocess
+import sys
+import zlib
+
+TIMEOUT = 60.0
+BLOCK_SIZE = 32 * 1024
+
+
+class TestRoundTrip:
+    """
+    Compresses data with one and with several threads and decompresses the
+    result again with sczip -d. Both modes must reproduce the input. The
+    block size is kept small so that the input spans more blocks than the
+    compressing threads hold at once.
+    """
+
+    @staticmethod
+    def sczip(options, data):
+        cmd = ["sczip"] + options
+        print(f"running sczip command: {' '.join(cmd)} ({len(data)} bytes)")
+        try:
+            return subprocess.run(
+                cmd,
+                input=data,
+                stdout=subprocess.PIPE,
+                timeout=TIMEOUT,
+                check=True,
+            ).stdout
+        except Exception as e:
+            raise ValueError(f"invalid sczip run: {' '.join(cmd)}") from e
+
+    @staticmethod
+    def data(size):
+        # Text like SCML compresses well, random bytes do not. Mix both so
+        # that compressed blocks differ in size.
+        rnd = random.Random(size)
+        chunks = []
+        total = 0
+        while total < size:
+            if rnd.random() < 0.8:
+                chunk = (
+                    f'<pick publicID="Pick/{rnd.randint(0, 1 << 30)}">'
+                    f"<time><value>2019-08-02T18:00:{rnd.randint(0, 59):02d}Z"
+                    "</value></time></pick>\n"
+                ).encode()
+            else:
+                chunk = rnd.randbytes(rnd.randint(1, 4096))
+            chunks.append(chunk)
+            total += len(chunk)
+        return b"".join(chunks)[:size]
+
+    def check(self, size):
+        data = self.data(size)
+
+        single = self.sczip([], data)
+        threaded = self.sczip(
+            ["--threads", "4", "--block-size", str(BLOCK_SIZE // 1024)], data
+        )
+
+        if zlib.decompress(threaded) != data:
+            raise ValueError(f"{size} bytes: threaded output is not a valid zlib stream")
+
+        if self.sczip(["-d"], single) != data:
+            raise ValueError(f"{size} bytes: single threaded round trip failed")
+
+        if self.sczip(["-d"], threaded) != data:
+            raise ValueError(f"{size} bytes: threaded round trip failed")
+
+    def __call__(self):
+        print("Testing sczip round trips with multiple threads")
+
+        # empty input, partial, exact and many blocks
+        for size in (0, 1, BLOCK_SIZE, BLOCK_SIZE + 1, 8 * BLOCK_SIZE,
+                     100 * BLOCK_SIZE + 17):
+            self.check(size)
+
+        # block sizes zlib cannot process at once are rejected
+        result = subprocess.run(
+            ["sczip", "--threads", "2", "--block-size", str(1 << 22)],
+            input=b"",
+            stdout=subprocess.DEVNULL,
+            timeout=TIMEOUT,
+            check=False,
+        )
+        if result.returncode == 0:
+            raise ValueError("block size exceeding UINT_MAX accepted")
+
+        return 0
+
+
+# ------------------------------------------------------------------------------
+if __name__ == "__main__":
+    app = TestRoundTrip()
+    sys.exit(app())